@@ -0,0 +1,64 @@
+// Oscillator cost of every interpolation mode on every ISA this CPU runs, in nanoseconds per
+// output sample, so the quality tiers can be chosen against a voice budget.
+//
+//   wave_bench [seconds per case]
+
+#include "config.h"
+#include "dsp.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Render blocks until budget seconds have passed; returns ns per sample.
+static double run(DspOscFunc osc, const float *table, double inc, float *out, double budget) {
+    double phase = 0.0;
+    long samples = 0;
+    double start = now_seconds(), elapsed;
+    do {
+        for (int b = 0; b < 64; b++)
+            osc(table, TABLE_SIZE, &phase, inc, 0.25f, out, BLOCK_SIZE);
+        samples += 64 * BLOCK_SIZE;
+        elapsed = now_seconds() - start;
+    } while (elapsed < budget);
+    return elapsed * 1e9 / samples;
+}
+
+int main(int argc, char **argv) {
+    double budget = argc > 1 ? atof(argv[1]) : 0.2;
+    float *table = malloc(TABLE_SIZE * sizeof(float));
+    float *out = calloc(BLOCK_SIZE, sizeof(float));
+    if (!table || !out)
+        return 1;
+    for (int i = 0; i < TABLE_SIZE; i++)
+        table[i] = (float)sin(2.0 * M_PI * i / TABLE_SIZE);
+    Dsp_sinc_table(); // build it outside the timing
+    // A low note, A440 and a note near the top of the keyboard, in TABLE_SIZE units.
+    const double freqs[] = {55.0, 440.0, 3520.0};
+    printf("%-8s %-8s", "isa", "interp");
+    for (int f = 0; f < 3; f++)
+        printf(" %8.0fHz", freqs[f]);
+    printf("   ns/sample\n");
+    for (int isa = 0; isa < DSP_ISA_COUNT; isa++) {
+        const DspKernels *k = Dsp_get_isa(isa);
+        if (!k)
+            continue;
+        for (int mode = 0; mode < DSP_INTERP_COUNT; mode++) {
+            printf("%-8s %-8s", k->name, Dsp_interp_name(mode));
+            for (int f = 0; f < 3; f++) {
+                double inc = freqs[f] * TABLE_SIZE / SAMPLE_RATE;
+                printf(" %10.2f", run(Dsp_osc(k, mode), table, inc, out, budget));
+            }
+            printf("\n");
+        }
+    }
+    free(out);
+    free(table);
+    return 0;
+}
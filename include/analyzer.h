@@ -0,0 +1,76 @@
+#pragma once
+#include "config.h"
+#include "containers.h"
+#include "fft.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+// 2048 points at SAMPLE_RATE resolve 23 Hz; with a 512-sample hop a 60 Hz UI gets one or two
+// transforms per frame, well under a millisecond even on a Raspberry Pi.
+#define ANALYZER_FFT_SIZE 2048
+#define ANALYZER_HOP (ANALYZER_FFT_SIZE / 4)
+#define ANALYZER_BANDS 128 // log-spaced from ANALYZER_MIN_HZ to ANALYZER_MAX_HZ
+#define ANALYZER_MIN_HZ 20.0f
+#define ANALYZER_MAX_HZ 20000.0f
+#define ANALYZER_FLOOR_DB -96.0f
+#define ANALYZER_HOLD_SECONDS 1.0f // peaks hold this long, then fall
+#define ANALYZER_FALL_DB 24.0f     // per second
+#define ANALYZER_TAP_BLOCKS 32     // blocks the tap buffers, power of two
+
+typedef struct {
+    int n;
+    float samples[BLOCK_SIZE];
+} AnalyzerBlock;
+
+DECLARE_SPSC_RING(AnalyzerBlock, AnalyzerBlock, ANALYZER_TAP_BLOCKS)
+
+// Spectrum of the master output for the UI. The audio thread copies blocks into a lock-free
+// tap; a worker thread windows overlapping frames, transforms them and reduces the bins to
+// log-spaced bands in dB (0 dB is a full-scale sine), each with a peak hold. The UI picks up
+// the latest result under a mutex the audio thread never touches.
+typedef struct {
+    SpscRing_AnalyzerBlock tap;
+    atomic_int enabled;
+    atomic_ulong dropped; // blocks refused because the tap was full
+
+    // Worker-owned.
+    Fft *fft;
+    FftComplex *spectrum;
+    float *window;
+    float *history; // the last ANALYZER_FFT_SIZE samples, circular
+    size_t history_pos;
+    long pending; // samples since the last transform, negative until history first fills
+    int band_first[ANALYZER_BANDS], band_last[ANALYZER_BANDS]; // bins, inclusive
+    float band_center[ANALYZER_BANDS]; // fractional bin, for bands narrower than a bin
+    float bands[ANALYZER_BANDS], peaks[ANALYZER_BANDS];
+    float hold[ANALYZER_BANDS]; // seconds of hold left per peak
+    pthread_t thread;
+    atomic_int stopping;
+
+    // Latest result, guarded by mutex.
+    pthread_mutex_t mutex;
+    float published_bands[ANALYZER_BANDS], published_peaks[ANALYZER_BANDS];
+    unsigned long produced; // spectra so far
+    unsigned long consumed; // spectra the UI has seen
+    _Atomic(float) last_analysis_ms; // one transform and band reduction
+} Analyzer;
+
+Analyzer *Analyzer_create(void);
+// Stops the worker if it is running.
+void Analyzer_destroy(Analyzer *an);
+
+// UI thread. Start drops anything left in the tap, clears the display and runs the worker;
+// returns -1 if the thread cannot be created. While stopped the tap ignores writes.
+int Analyzer_start(Analyzer *an);
+void Analyzer_stop(Analyzer *an);
+int Analyzer_running(Analyzer *an);
+
+// Copy the latest bands and peaks (ANALYZER_BANDS each, dB). Returns how many spectra were
+// produced since the previous call.
+int Analyzer_read(Analyzer *an, float *bands, float *peaks);
+float Analyzer_last_analysis_ms(Analyzer *an);
+// Centre frequency of a band, in Hz.
+float Analyzer_band_hz(int band);
+
+// Audio thread: wait-free, a no-op while stopped.
+void Analyzer_write(Analyzer *an, const float *samples, int n);
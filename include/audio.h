@@ -0,0 +1,85 @@
+#pragma once
+#include "latency.h"
+#include <stdatomic.h>
+
+// Renders n (<= BLOCK_SIZE) frames of stereo output. Called on the backend's audio thread.
+typedef void (*AudioRenderFn)(void *userdata, float *left, float *right, int n);
+
+typedef enum {
+    AUDIO_BACKEND_SOUNDIO, // the default device through libsoundio
+    AUDIO_BACKEND_JACK,    // a JACK client; only when built with WAVE_HAVE_JACK
+    AUDIO_BACKEND_NULL,    // no device: a timer drives the callback and the output is discarded
+    AUDIO_BACKEND_COUNT,
+} AudioBackendType;
+
+typedef struct {
+    AudioBackendType type;
+    int soundio_backend; // enum SoundIoBackend to connect to; 0 (SoundIoBackendNone) = default
+    double period;       // fixed buffer in seconds, or 0 to let the latency manager choose
+    int realtime;        // null clock: run its thread SCHED_FIFO when the system allows it
+} AudioConfig;
+
+typedef struct AudioOutput AudioOutput;
+
+// One audio backend, chosen at open. connect finds the device and narrows [min, max], the
+// latencies in seconds it can run at; start streams at one of them and stop undoes start, so
+// the latency can be changed by stopping and starting again. poll may be NULL.
+typedef struct {
+    const char *name;
+    int (*connect)(AudioOutput *audio, const AudioConfig *config, double *min, double *max);
+    int (*start)(AudioOutput *audio, double seconds);
+    void (*stop)(AudioOutput *audio);
+    void (*disconnect)(AudioOutput *audio);
+    void (*poll)(AudioOutput *audio);
+    double (*latency)(const AudioOutput *audio); // what the backend actually granted
+} AudioBackend;
+
+// Output stream at SAMPLE_RATE with its software latency tuned by a LatencyManager. Backends
+// call render a block at a time from their own audio thread and report the time it took, so
+// every backend drives the engine the way a device would.
+struct AudioOutput {
+    const AudioBackend *backend;
+    void *impl; // the backend's own state
+    AudioRenderFn render;
+    void *userdata;
+    LatencyManager latency;
+    atomic_ulong callbacks;
+    atomic_ulong xruns;
+    _Atomic(float) max_late_ms; // null clock: worst wake-up after the scheduled time
+};
+
+const AudioBackend *Audio_soundio_backend(void);
+// NULL when built without JACK.
+const AudioBackend *Audio_jack_backend(void);
+const AudioBackend *Audio_null_backend(void);
+// NULL if type is not built in.
+const AudioBackend *Audio_backend(AudioBackendType type);
+// Backend type by name ("soundio", "jack", "null"), or -1.
+int Audio_backend_parse(const char *name);
+
+// Connect and start streaming at the smallest latency. Returns 0, or -1 or a backend error
+// code; errors are printed.
+int AudioOutput_open(AudioOutput *audio, const AudioConfig *config, AudioRenderFn render,
+                     void *userdata);
+void AudioOutput_close(AudioOutput *audio);
+
+// AudioOutput_set_latency could not restart the stream at any latency.
+#define AUDIO_STOPPED (-2)
+
+// Reopen the stream with a new software latency (seconds). Must not be called while holding a
+// lock the render callback takes, since the old stream's thread is joined. If the backend
+// refuses the new latency the stream is restarted at the old one and the backend's error is
+// returned; AUDIO_STOPPED means that failed too and there is no output.
+int AudioOutput_set_latency(AudioOutput *audio, double seconds);
+// Feed the latency manager and reopen the stream if it asks for a different buffer. Returns 1
+// when the latency changed, 0 when it did not (a refused latency is rolled back and not tried
+// again) and -1 when the stream is stopped.
+int AudioOutput_tune(AudioOutput *audio, int voices);
+// Latency the backend actually granted, in seconds.
+double AudioOutput_latency(const AudioOutput *audio);
+
+// For backends, on the audio thread: bracket each device callback of frames frames so the
+// latency manager sees how close rendering comes to the deadline, and report missed ones.
+double AudioOutput_begin_callback(AudioOutput *audio);
+void AudioOutput_end_callback(AudioOutput *audio, double start, int frames);
+void AudioOutput_report_xrun(AudioOutput *audio);
@@ -0,0 +1,58 @@
+#pragma once
+#include "containers.h"
+#include "mixer.h"
+#include "state.h"
+#include <stdatomic.h>
+
+#define COMMAND_BATCH_MAX 64 // commands per batch; one batch per incoming packet
+#define COMMAND_QUEUE_SIZE 32 // batches in flight, power of two
+
+typedef enum {
+    COMMAND_NOTE_ON,  // target = voice, args[0] = frequency in Hz
+    COMMAND_NOTE_OFF, // target = voice
+    COMMAND_LEVEL,    // target = wavetable slot, args[0] = level
+    COMMAND_CUTOFF,   // args[0] = lowpass cutoff in Hz
+    COMMAND_Q,        // args[0] = lowpass Q
+    COMMAND_CURSOR,   // target = coordinates given, args = mixer cursor position
+    COMMAND_INTERP,   // target = DspInterp for the live settings
+    COMMAND_DELAY,    // target = values given, args = send, seconds, feedback
+    COMMAND_REVERB,   // target = values given, args = send, decay seconds, damping
+} CommandType;
+
+typedef struct {
+    CommandType type;
+    int target;
+    float args[MIXER_MAX_DIMS];
+} Command;
+
+typedef struct {
+    double received; // CLOCK_MONOTONIC seconds when the packet arrived
+    int count;
+    Command commands[COMMAND_BATCH_MAX];
+} CommandBatch;
+
+DECLARE_SPSC_RING(CommandBatch, CommandBatch, COMMAND_QUEUE_SIZE)
+
+// Engine commands from a control thread to the audio thread, which applies them at the top
+// of a block. Single producer, single consumer; a whole batch is published with one store, so
+// a burst of automation costs the audio thread one queue check per block.
+typedef struct {
+    SpscRing_CommandBatch batches;
+    atomic_ulong applied; // commands applied
+    atomic_ulong dropped; // batches refused because the queue was full
+    _Atomic(float) last_latency_ms; // receive-to-apply time of the latest batch
+    _Atomic(float) max_latency_ms;
+} CommandQueue;
+
+void CommandQueue_init(CommandQueue *queue);
+
+// Producer: the batch to fill next, or NULL if the queue is full (the batch is dropped and
+// counted). Push publishes it.
+CommandBatch *CommandQueue_begin(CommandQueue *queue);
+void CommandQueue_push(CommandQueue *queue);
+
+// Audio thread, with the State locked: apply every queued batch. Wait-free.
+void CommandQueue_apply(CommandQueue *queue, State *state);
+
+// Start max_latency_ms over.
+void CommandQueue_reset_latency(CommandQueue *queue);
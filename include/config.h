@@ -1,6 +1,11 @@
 #pragma once
 #define TABLE_SIZE 1024
 #define SAMPLE_RATE 48000
+#define BLOCK_SIZE 256 // frames rendered per engine call
+// Filter state below this (about -100 dB) counts as silence; the engine stops rendering.
+#define SILENCE_THRESHOLD 1e-5f
+// A hot-reloaded wavetable fades in over this many frames (about 85 ms).
+#define RELOAD_FADE_FRAMES 4096
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -0,0 +1,191 @@
+#pragma once
+#include <assert.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Typed containers for the audio thread, in the spirit of DECLARE_VEC_TYPE but without its
+// costs: elements are reached through pointers, not copied per access, and nothing allocates
+// after construction. Bounds are checked with assert, so only in debug builds; operations
+// that can fail at run time (a full container) return -1 instead.
+
+/*
+ * DECLARE_FIXED_VEC(Type, Name, Capacity)
+ *
+ * FixedVec_Name: up to Capacity elements stored inline. No allocation at all; a zeroed
+ * struct is an empty vector.
+ */
+#define DECLARE_FIXED_VEC(Type, Name, Capacity)                                                    \
+    typedef struct {                                                                               \
+        size_t size;                                                                               \
+        Type data[Capacity];                                                                       \
+    } FixedVec_##Name;                                                                             \
+                                                                                                   \
+    static inline void FixedVec_##Name##_clear(FixedVec_##Name *v) {                               \
+        v->size = 0;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static inline size_t FixedVec_##Name##_capacity(void) {                                        \
+        return (Capacity);                                                                         \
+    }                                                                                              \
+                                                                                                   \
+    static inline Type *FixedVec_##Name##_at(FixedVec_##Name *v, size_t index) {                   \
+        assert(index < v->size);                                                                   \
+        return &v->data[index];                                                                    \
+    }                                                                                              \
+                                                                                                   \
+    /* Returns -1 and leaves v unchanged when it is full. */                                       \
+    static inline int FixedVec_##Name##_push(FixedVec_##Name *v, Type item) {                      \
+        if (v->size == (Capacity))                                                                 \
+            return -1;                                                                             \
+        v->data[v->size++] = item;                                                                 \
+        return 0;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    /* Room for one more element to be filled in place, or NULL when full. */                      \
+    static inline Type *FixedVec_##Name##_emplace(FixedVec_##Name *v) {                            \
+        return v->size == (Capacity) ? NULL : &v->data[v->size++];                                 \
+    }                                                                                              \
+                                                                                                   \
+    static inline Type FixedVec_##Name##_pop(FixedVec_##Name *v) {                                 \
+        assert(v->size > 0);                                                                       \
+        return v->data[--v->size];                                                                 \
+    }                                                                                              \
+                                                                                                   \
+    /* Order is not kept: the last element moves into the gap. */                                  \
+    static inline void FixedVec_##Name##_swap_remove(FixedVec_##Name *v, size_t index) {           \
+        assert(index < v->size);                                                                   \
+        v->data[index] = v->data[--v->size];                                                       \
+    }
+
+/*
+ * DECLARE_SMALL_VEC(Type, Name, Inline)
+ *
+ * SmallVec_Name: capacity fixed at init. Up to Inline elements live in the struct; larger
+ * capacities take one heap block at init, so the vector can be sized from configuration and
+ * still never allocate while it is used. The struct holds no pointer into itself and can be
+ * copied or moved while it is in inline mode.
+ */
+#define DECLARE_SMALL_VEC(Type, Name, Inline)                                                      \
+    typedef struct {                                                                               \
+        size_t size;                                                                               \
+        size_t capacity;                                                                           \
+        Type *heap; /* NULL while the inline buffer is enough */                                   \
+        Type local[Inline];                                                                        \
+    } SmallVec_##Name;                                                                             \
+                                                                                                   \
+    static inline void SmallVec_##Name##_init(SmallVec_##Name *v, size_t capacity) {               \
+        v->size = 0;                                                                               \
+        v->capacity = capacity > (Inline) ? capacity : (Inline);                                   \
+        v->heap = NULL;                                                                            \
+        if (capacity > (Inline)) {                                                                 \
+            v->heap = malloc(capacity * sizeof(Type));                                             \
+            assert(v->heap);                                                                       \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline void SmallVec_##Name##_destroy(SmallVec_##Name *v) {                             \
+        free(v->heap);                                                                             \
+        v->heap = NULL;                                                                            \
+        v->size = v->capacity = 0;                                                                 \
+    }                                                                                              \
+                                                                                                   \
+    static inline Type *SmallVec_##Name##_data(SmallVec_##Name *v) {                               \
+        return v->heap ? v->heap : v->local;                                                       \
+    }                                                                                              \
+                                                                                                   \
+    static inline Type *SmallVec_##Name##_at(SmallVec_##Name *v, size_t index) {                   \
+        assert(index < v->size);                                                                   \
+        return &SmallVec_##Name##_data(v)[index];                                                  \
+    }                                                                                              \
+                                                                                                   \
+    static inline int SmallVec_##Name##_push(SmallVec_##Name *v, Type item) {                      \
+        if (v->size == v->capacity)                                                                \
+            return -1;                                                                             \
+        SmallVec_##Name##_data(v)[v->size++] = item;                                               \
+        return 0;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    static inline Type SmallVec_##Name##_pop(SmallVec_##Name *v) {                                 \
+        assert(v->size > 0);                                                                       \
+        return SmallVec_##Name##_data(v)[--v->size];                                               \
+    }                                                                                              \
+                                                                                                   \
+    static inline void SmallVec_##Name##_clear(SmallVec_##Name *v) {                               \
+        v->size = 0;                                                                               \
+    }
+
+/*
+ * DECLARE_SPSC_RING(Type, Name, Capacity)
+ *
+ * SpscRing_Name: lock-free single-producer, single-consumer queue of Capacity (a power of
+ * two) elements stored inline. Slots are filled and read in place: the producer takes
+ * write_slot, fills it and commits; the consumer takes read_slot, uses it and releases. Both
+ * sides are wait-free. Initialise with SpscRing_Name_init or by zeroing the struct.
+ */
+#define DECLARE_SPSC_RING(Type, Name, Capacity)                                                    \
+    _Static_assert((Capacity) > 0 && ((Capacity) & ((Capacity)-1)) == 0,                           \
+                   "SpscRing capacity must be a power of two");                                    \
+    typedef struct {                                                                               \
+        Type data[Capacity];                                                                       \
+        atomic_size_t write_pos; /* advanced by the producer only */                               \
+        atomic_size_t read_pos;  /* advanced by the consumer only */                               \
+    } SpscRing_##Name;                                                                             \
+                                                                                                   \
+    static inline void SpscRing_##Name##_init(SpscRing_##Name *r) {                                \
+        atomic_init(&r->write_pos, 0);                                                             \
+        atomic_init(&r->read_pos, 0);                                                              \
+    }                                                                                              \
+                                                                                                   \
+    /* Producer: the next free slot, or NULL when the ring is full. */                             \
+    static inline Type *SpscRing_##Name##_write_slot(SpscRing_##Name *r) {                         \
+        size_t w = atomic_load_explicit(&r->write_pos, memory_order_relaxed);                      \
+        size_t rd = atomic_load_explicit(&r->read_pos, memory_order_acquire);                      \
+        if (w - rd >= (Capacity))                                                                  \
+            return NULL;                                                                           \
+        return &r->data[w & ((Capacity)-1)];                                                       \
+    }                                                                                              \
+                                                                                                   \
+    /* Producer: publish the slot write_slot returned. */                                          \
+    static inline void SpscRing_##Name##_commit(SpscRing_##Name *r) {                              \
+        size_t w = atomic_load_explicit(&r->write_pos, memory_order_relaxed);                      \
+        atomic_store_explicit(&r->write_pos, w + 1, memory_order_release);                         \
+    }                                                                                              \
+                                                                                                   \
+    static inline int SpscRing_##Name##_push(SpscRing_##Name *r, const Type *item) {               \
+        Type *slot = SpscRing_##Name##_write_slot(r);                                              \
+        if (!slot)                                                                                 \
+            return -1;                                                                             \
+        memcpy(slot, item, sizeof(Type));                                                          \
+        SpscRing_##Name##_commit(r);                                                               \
+        return 0;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    /* Consumer: the oldest committed slot, or NULL when the ring is empty. */                     \
+    static inline Type *SpscRing_##Name##_read_slot(SpscRing_##Name *r) {                          \
+        size_t rd = atomic_load_explicit(&r->read_pos, memory_order_relaxed);                      \
+        size_t w = atomic_load_explicit(&r->write_pos, memory_order_acquire);                      \
+        return rd == w ? NULL : &r->data[rd & ((Capacity)-1)];                                     \
+    }                                                                                              \
+                                                                                                   \
+    /* Consumer: hand the slot read_slot returned back to the producer. */                         \
+    static inline void SpscRing_##Name##_release(SpscRing_##Name *r) {                             \
+        size_t rd = atomic_load_explicit(&r->read_pos, memory_order_relaxed);                      \
+        atomic_store_explicit(&r->read_pos, rd + 1, memory_order_release);                         \
+    }                                                                                              \
+                                                                                                   \
+    static inline int SpscRing_##Name##_pop(SpscRing_##Name *r, Type *out) {                       \
+        Type *slot = SpscRing_##Name##_read_slot(r);                                               \
+        if (!slot)                                                                                 \
+            return -1;                                                                             \
+        memcpy(out, slot, sizeof(Type));                                                           \
+        SpscRing_##Name##_release(r);                                                              \
+        return 0;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    /* Either side; exact only on the consumer, a lower bound on the producer. */                  \
+    static inline size_t SpscRing_##Name##_size(SpscRing_##Name *r) {                              \
+        return atomic_load_explicit(&r->write_pos, memory_order_acquire) -                         \
+               atomic_load_explicit(&r->read_pos, memory_order_acquire);                           \
+    }
@@ -0,0 +1,38 @@
+#pragma once
+#include "command.h"
+#include <pthread.h>
+#include <stddef.h>
+
+#define CONTROL_DEFAULT_PORT 9000
+
+// Open Sound Control over UDP on 127.0.0.1, for driving the engine from another process.
+// Every packet (a message or a bundle of them) becomes one CommandBatch. Bundle time tags are
+// not scheduled: everything applies at the next block.
+//
+//   /wave/note_on  i voice f hz     /wave/level  i slot f level    /wave/cutoff f hz
+//   /wave/note_off i voice          /wave/cursor f x [f y ...]     /wave/q      f q
+//   /wave/delay    f send [f seconds f feedback]
+//   /wave/reverb   f send [f decay_seconds f damping]
+//   /wave/interp   i mode (0 linear, 1 hermite, 2 sinc)
+//   /wave/latency                   replies /wave/latency f last_ms f max_ms i applied i dropped
+//
+// /wave/cursor needs the geometric mixer: M in the window, or --mixer when headless.
+typedef struct {
+    CommandQueue *queue;
+    int fd;
+    int wake[2]; // self-pipe that stops the thread
+    pthread_t thread;
+    int running;
+    atomic_ulong packets;
+    atomic_ulong malformed; // packets or messages that could not be decoded
+} ControlServer;
+
+// Bind 127.0.0.1:port (0 picks a free port) and start the receive thread. NULL on failure.
+ControlServer *ControlServer_start(CommandQueue *queue, int port);
+void ControlServer_stop(ControlServer *server);
+// The bound port.
+int ControlServer_port(const ControlServer *server);
+
+// Decode one OSC packet into batch, appending commands. Returns the number of commands added,
+// or -1 if the packet is malformed. Queries are not commands; *query is set if one was found.
+int Control_decode(const unsigned char *packet, size_t size, CommandBatch *batch, int *query);
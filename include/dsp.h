@@ -0,0 +1,103 @@
+#pragma once
+#include "filter.h"
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    DSP_ISA_SCALAR,
+    DSP_ISA_SSE2,
+    DSP_ISA_AVX2,
+    DSP_ISA_AVX512,
+    DSP_ISA_NEON,
+    DSP_ISA_COUNT
+} DspIsa;
+
+// Oscillator interpolation quality, cheapest first.
+typedef enum {
+    DSP_INTERP_LINEAR,
+    DSP_INTERP_HERMITE, // 4-point, 3rd-order (Catmull-Rom)
+    DSP_INTERP_SINC,    // polyphase windowed sinc, DSP_SINC_TAPS taps
+    DSP_INTERP_COUNT
+} DspInterp;
+
+// The sinc interpolator reads taps at offsets -3..4 around the integer position. Its
+// coefficients are tabulated for DSP_SINC_PHASES fractional positions plus a closing row and
+// linearly interpolated between rows.
+#define DSP_SINC_TAPS 8
+#define DSP_SINC_PHASES 256
+
+// out[i] += gain * interp(table, phase); advances and wraps *phase by phase_inc per sample.
+typedef void (*DspOscFunc)(const float *table, size_t length, double *phase, double phase_inc,
+                           float gain, float *out, int n);
+
+// One implementation of every block kernel the engine uses on the audio thread.
+typedef struct {
+    DspIsa isa;
+    const char *name;
+    // out[i] += gain * lerp(table, phase); advances and wraps *phase by phase_inc per sample.
+    void (*osc_interp)(const float *table, size_t length, double *phase, double phase_inc,
+                       float gain, float *out, int n);
+    // Same contract with the other interpolation modes; tables need at least 4 samples.
+    DspOscFunc osc_hermite;
+    DspOscFunc osc_sinc;
+    // Run n samples through filter in place; equivalent to n calls to Biquad_process.
+    void (*biquad_block)(BiquadFilter *filter, float *buf, int n);
+    // Unnormalised 8-point Hadamard transform of each of n frames of 8 floats, in place
+    // (applying it twice scales by 8). Mixes the lines of a feedback delay network.
+    void (*hadamard8)(float *frames, int n);
+    // dst[i] += gain * src[i]
+    void (*mix_add)(float *dst, const float *src, float gain, int n);
+    // Clamp to [-1, 1] and scale to signed 16-bit.
+    void (*convert_s16)(const float *src, int16_t *dst, int n);
+    // Clamp to [-1, 1], multiply by scale and round; 24-bit samples use the low bits of an
+    // int32. scale must keep 1.0 * scale representable (see DSP_S32_SCALE).
+    void (*convert_s32)(const float *src, int32_t *dst, float scale, int n);
+    // Widen to double.
+    void (*convert_f64)(const float *src, double *dst, int n);
+} DspKernels;
+
+// Full-scale multipliers for convert_s32. 2^31 - 1 is not a float; this is the largest one
+// below it.
+#define DSP_S24_SCALE 8388607.0f
+#define DSP_S32_SCALE 2147483520.0f
+
+// Detect the CPU once and select the best kernels. The WAVE_DSP environment variable
+// (scalar, sse2, avx2, avx512, neon) forces a path for benchmarking.
+void Dsp_init(void);
+// Switch the active kernels; returns -1 (and keeps the current ones) if isa is unavailable.
+// Not for use while the audio thread is running.
+int Dsp_select(DspIsa isa);
+// Active kernels; calls Dsp_init on first use.
+const DspKernels *Dsp_get(void);
+// Kernels for a given ISA, or NULL if not built for this target or unsupported by this CPU.
+const DspKernels *Dsp_get_isa(DspIsa isa);
+DspIsa Dsp_detect(void);
+const char *Dsp_isa_name(DspIsa isa);
+// Oscillator kernel of kernels for interp.
+DspOscFunc Dsp_osc(const DspKernels *kernels, DspInterp interp);
+const char *Dsp_interp_name(DspInterp interp);
+// One sample at pos; the per-sample reference for every mode.
+float Dsp_interp_sample(const float *table, size_t length, double pos, DspInterp interp);
+// (DSP_SINC_PHASES + 1) * DSP_SINC_TAPS coefficients, row by row; built on first use.
+const float *Dsp_sinc_table(void);
+// Blend the two sinc rows around frac into coeffs (DSP_SINC_TAPS floats).
+void Dsp_sinc_coefficients(double frac, float *coeffs);
+
+// Flush denormals to zero (FTZ/DAZ on x86, FZ on ARM) for the calling thread, so decaying
+// filter tails never hit the slow subnormal path. Call from the audio thread.
+void Dsp_flush_denormals(void);
+
+// w[k] = b0 * x[k + 2] + b1 * x[k + 1] + b2 * x[k] for k in [0, n).
+typedef void (*DspFirFunc)(const float *x, float *w, int n, float b0, float b1, float b2);
+// Block biquad built on a vectorised feed-forward pass; shared by the ISA kernel files.
+void Dsp_biquad_block_split(BiquadFilter *filter, float *buf, int n, DspFirFunc fir);
+// The DSP_SINC_TAPS table samples the sinc reads around index0: a pointer into table, or
+// scratch filled with wrapped samples when the taps straddle the end.
+const float *Dsp_sinc_taps(const float *table, size_t length, int index0, float *scratch);
+
+// Per-ISA tables, NULL when the ISA is not compiled into this binary.
+const DspKernels *Dsp_kernels_scalar(void);
+const DspKernels *Dsp_kernels_sse2(void);
+const DspKernels *Dsp_kernels_avx2(void);
+const DspKernels *Dsp_kernels_avx512(void);
+const DspKernels *Dsp_kernels_neon(void);
@@ -0,0 +1,65 @@
+#pragma once
+#include "config.h"
+#include <stddef.h>
+
+#define FX_FDN_LINES 8
+// Longest echo of the stereo delay, in seconds.
+#define FX_DELAY_MAX_SECONDS 1.25f
+
+// Power-of-two delay buffer; positions only ever grow and are masked on access.
+typedef struct {
+    float *data;
+    size_t mask;
+} DelayLine;
+
+// Send effects after the voice mix: a stereo ping-pong delay and an eight-line feedback
+// delay network reverb, both fed from the mono mix by their send level. Everything runs a
+// block at a time. Every delay is at least BLOCK_SIZE long, so a block reads only samples
+// written before it, and modulation and delay-time glides are computed once per block and
+// ramped across it.
+typedef struct {
+    // Stereo delay: echoes alternate left and right.
+    DelayLine echo[2];
+    size_t echo_pos;
+    double echo_time;   // samples, gliding towards echo_target
+    double echo_target;
+    float echo_feedback;
+    float delay_send;
+
+    // Reverb: lines mixed through a Hadamard matrix, each with a one-pole damping filter
+    // and a gain setting its decay, and their read taps slowly modulated.
+    DelayLine lines[FX_FDN_LINES];
+    size_t fdn_pos;
+    double line_delay[FX_FDN_LINES]; // current modulated delay, samples
+    double mod_phase[FX_FDN_LINES];  // radians
+    float line_gain[FX_FDN_LINES];
+    float damp_state[FX_FDN_LINES];
+    float decay;   // RT60 in seconds
+    float damping; // 0 (bright) to FX_MAX_DAMPING (dark)
+    float reverb_send;
+
+    // Silence tracking: a path whose input has been quiet for longer than its tail is
+    // skipped until it gets input again.
+    long delay_quiet, reverb_quiet; // frames of quiet input
+    long delay_tail, reverb_tail;   // frames for the tail to fall below SILENCE_THRESHOLD
+
+    float frames[BLOCK_SIZE * FX_FDN_LINES]; // one block of line outputs, frame by frame
+    float scratch[2][BLOCK_SIZE];
+} Effects;
+
+#define FX_MAX_FEEDBACK 0.95f
+#define FX_MAX_DAMPING 0.9f
+
+// Both sends start at zero, so the stage passes the mix through until one is raised.
+Effects *Effects_create(void);
+void Effects_destroy(Effects *fx);
+
+// Parameters are clamped to their ranges. The delay time glides to a new setting while
+// echoes are sounding.
+void Effects_set_delay(Effects *fx, float send, float seconds, float feedback);
+void Effects_set_reverb(Effects *fx, float send, float decay, float damping);
+
+// left[i] = right[i] = in[i], plus the wet signal of each path. n <= BLOCK_SIZE.
+void Effects_process(Effects *fx, const float *in, float *left, float *right, int n);
+// 1 once both tails have died away after the input went quiet.
+int Effects_settled(const Effects *fx);
@@ -0,0 +1,28 @@
+#pragma once
+#include "wavetable.h"
+#include <stddef.h>
+
+// Turning a recorded note into a single-cycle wavetable, as resampler/resampler.py does.
+
+typedef struct {
+    double freq;       // pitch of the note in Hz; <= 0 detects it with YIN
+    size_t table_size; // samples in the output table
+    float top_db;      // frames this far below the loudest one are trimmed as silence
+} ExtractOptions;
+
+ExtractOptions ExtractOptions_default(void);
+
+// Scale so the largest absolute value is 1 (no-op for silence).
+void Extract_normalize(float *data, size_t length);
+// Bounds [*start, *end) of the longest non-silent stretch, using centred 2048/512 RMS frames.
+void Extract_trim(const float *data, size_t length, float top_db, size_t *start, size_t *end);
+// YIN estimate of the fundamental over data, in Hz, or 0 if nothing periodic was found.
+double Extract_detect_pitch(const float *data, size_t length, int sample_rate, double fmin,
+                            double fmax);
+// Band-limited resample of one period via FFT (same result as scipy.signal.resample).
+void Extract_resample_fft(const float *in, size_t in_len, float *out, size_t out_len);
+
+// Full pipeline: normalise, trim, find the pitch, cut a period from the middle, resample and
+// normalise again. Returns NULL if the sound is too short or has no detectable pitch.
+Wavetable *Extract_wavetable(const float *samples, size_t length, int sample_rate,
+                             const ExtractOptions *opts, double *freq_out);
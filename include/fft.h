@@ -0,0 +1,26 @@
+#pragma once
+#include <stddef.h>
+
+typedef struct {
+    float re, im;
+} FftComplex;
+
+// Complex FFT plan for any size. Powers of two run radix-2 directly; other sizes go through
+// Bluestein's algorithm on a padded power-of-two transform. All buffers are allocated up
+// front, so transforms never allocate.
+typedef struct {
+    size_t n;              // transform size
+    size_t m;              // radix-2 working size (== n for powers of two)
+    FftComplex *twiddles;  // m / 2 roots of unity
+    FftComplex *chirp;     // Bluestein chirp (n entries), NULL for powers of two
+    FftComplex *chirp_fft; // FFT of the padded conjugate chirp (m entries)
+    FftComplex *work;      // m-entry scratch buffer
+} Fft;
+
+Fft *Fft_create(size_t n);
+void Fft_destroy(Fft *fft);
+
+// In-place forward transform, unnormalised.
+void Fft_forward(Fft *fft, FftComplex *data);
+// In-place inverse transform, scaled by 1 / n.
+void Fft_inverse(Fft *fft, FftComplex *data);
@@ -10,6 +10,11 @@ void Biquad_init(BiquadFilter *filter, float b0, float b1, float b2, float a1, f
 float Biquad_process(BiquadFilter *filter, float input);
 void Biquad_design_lowpass(BiquadFilter *filter, float cutoff, float Q);
 void Biquad_design_highpass(BiquadFilter *filter, float cutoff, float Q);
+// With zero input from here on: if the state is within threshold of zero, clear it and
+// return 1 (the output stays exactly zero), otherwise return 0.
+int Biquad_settle(BiquadFilter *filter, float threshold);
+// Take src's coefficients but keep filter's state, so a swap does not click.
+void Biquad_copy_coefficients(BiquadFilter *filter, const BiquadFilter *src);
 
 typedef struct {
     BiquadFilter biquad;
@@ -19,5 +24,7 @@ typedef struct {
 
 void Lowpass_init(LowpassFilter *filter);
 float Lowpass_process(LowpassFilter *filter, float input);
+void Lowpass_process_block(LowpassFilter *filter, float *buf, int n);
+int Lowpass_settle(LowpassFilter *filter, float threshold);
 void Lowpass_set_cutoff(LowpassFilter *filter, float cutoff);
 void Lowpass_set_q(LowpassFilter *filter, float q);
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+#include <stddef.h>
+
+// Golden-output regression harness: fixed scenarios are rendered through the engine and
+// compared against a double-precision model of it that is stored under tests/golden. A change
+// passes if it stays within the scenario's SNR and max-error bounds, so faster variants
+// (SIMD, float phase, fixed point) can be judged on what they sound like.
+
+#define GOLDEN_MAX_EVENTS 256
+
+typedef enum {
+    GOLDEN_NOTE_ON,  // voice, value = frequency in Hz (restarts the voice's phase)
+    GOLDEN_NOTE_OFF, // voice
+    GOLDEN_FREQ,     // voice, value = frequency in Hz (keeps phase, for glides)
+    GOLDEN_LEVEL,    // slot = wavetable, value = level
+    GOLDEN_CUTOFF,   // value = lowpass cutoff in Hz (redesigning the filter clears its state)
+    GOLDEN_Q,        // value = lowpass Q
+} GoldenEventType;
+
+typedef struct {
+    int frame;
+    GoldenEventType type;
+    int target; // voice or wavetable slot
+    double value;
+} GoldenEvent;
+
+typedef struct {
+    const char *name;
+    int frames;
+    int num_events; // sorted by frame
+    GoldenEvent events[GOLDEN_MAX_EVENTS];
+    double min_snr_db;    // pass thresholds against the reference
+    double max_abs_error;
+} GoldenScenario;
+
+typedef struct {
+    double snr_db; // reference power over error power; INFINITY for a bit-exact match
+    double max_abs_error;
+    size_t worst_frame;
+} GoldenStats;
+
+int Golden_scenario_count(void);
+// Fill sc with built-in scenario index (0 <= index < Golden_scenario_count()).
+void Golden_scenario(int index, GoldenScenario *sc);
+
+// Render sc->frames samples through the engine with the active DSP kernels, in BLOCK_SIZE
+// blocks split at event frames, or one sample at a time through State_mix_sample.
+void Golden_render(const GoldenScenario *sc, float *out, int per_sample);
+// Same scenario through the double-precision model.
+void Golden_render_reference(const GoldenScenario *sc, double *out);
+
+void Golden_compare(const float *actual, const double *reference, size_t n, GoldenStats *stats);
+int Golden_passes(const GoldenScenario *sc, const GoldenStats *stats);
+
+// Little-endian "WGLD" + uint32 count + float64 samples. Load returns -1 on a missing or
+// malformed file; the caller frees *samples.
+int Golden_save(const char *filename, const double *samples, size_t n);
+int Golden_load(const char *filename, double **samples, size_t *n);
@@ -1,5 +1,30 @@
 #pragma once
+#include "mixer.h"
 #include <raylib.h>
 #include <stdio.h>
 
-void DrawSlider(int x, int y, int width, int height, float level, const char *label);
\ No newline at end of file
+void DrawSlider(int x, int y, int width, int height, float level, const char *label);
+// 2D mixer shape (faces in angular order, as MixerShape_polygon makes them) and its cursor.
+void DrawMixer(int x, int y, int size, const MixerShape *shape, const float *cursor);
+// Bar per harmonic magnitude (0..1), with the selected one highlighted.
+void DrawHarmonics(int x, int y, int width, int height, const float *magnitudes, int count,
+                   int selected, float rebuild_ms);
+
+// Analyzer bands as bars with peak marks above a scrolling spectrogram. The spectrogram is a
+// texture one texel per band high; each new spectrum replaces a single column and the texture
+// is drawn in two pieces starting after that column, so it scrolls without being redrawn.
+// Frequency gridlines and labels are rendered once into their own texture. Needs a window.
+typedef struct {
+    int width, height; // on screen
+    Texture2D spectrogram; // width columns by ANALYZER_BANDS rows
+    RenderTexture2D grid;
+    Color *column; // one column of texels
+    int next;      // column the next spectrum goes into
+} SpectrumView;
+
+SpectrumView *SpectrumView_create(int width, int height);
+void SpectrumView_destroy(SpectrumView *view);
+// Scroll in one spectrum as Analyzer_read gives it.
+void SpectrumView_push(SpectrumView *view, const float *db);
+void DrawSpectrum(int x, int y, const SpectrumView *view, const float *db, const float *peaks,
+                  float analysis_ms);
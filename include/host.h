@@ -0,0 +1,61 @@
+#pragma once
+#include "config.h"
+#include "state.h"
+#include <pthread.h>
+
+#define HOST_MAX_CORES 64
+
+typedef struct {
+    State *state; // NULL while the slot is free
+    int worker;   // renders this engine
+    _Alignas(64) float out[BLOCK_SIZE]; // last block, after the engine's lowpass
+} HostEngine;
+
+typedef struct Host Host;
+
+typedef struct {
+    Host *host;
+    int index;
+    int core;    // CPU the thread is pinned to, -1 if the system refused
+    int engines; // assigned to it
+    pthread_t thread;
+} HostWorker;
+
+// Many engines in one process, e.g. one per MIDI channel or a farm rendering previews. Every
+// engine is a shared State on the host's table pool, so each costs only its voices and filter.
+// One worker thread per core renders the engines assigned to it; engines go to the least
+// loaded worker and stay there. Host_render runs one block on every engine and waits for all
+// workers, so engines and their States may be changed freely between renders, from the thread
+// that calls Host_render.
+struct Host {
+    TablePool *pool;
+    HostEngine *engines;
+    int max_engines;
+    HostWorker *workers;
+    int num_workers;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t start, done;
+    unsigned long generation; // blocks requested
+    int finished;             // workers done with the current block
+    int frames;
+    int running;
+};
+
+// One worker per entry of cores, pinned to that CPU; NULL cores means CPUs 0 to
+// num_cores - 1. pool may be NULL to build a new one; otherwise the host takes a reference.
+// Returns NULL if a worker thread cannot be started.
+Host *Host_create(TablePool *pool, const int *cores, int num_cores, int max_engines);
+// Stops the workers and destroys every engine.
+void Host_destroy(Host *host);
+
+// Add an engine and return its index, or -1 when the host is full.
+int Host_add(Host *host);
+void Host_remove(Host *host, int engine);
+State *Host_state(Host *host, int engine);
+// The engine's last block; zeros until it first renders.
+const float *Host_output(const Host *host, int engine);
+int Host_engines(const Host *host);
+
+// Render frames (<= BLOCK_SIZE) on every engine and, if mix is not NULL, write their sum to it.
+void Host_render(Host *host, float *mix, int frames);
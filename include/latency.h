@@ -0,0 +1,50 @@
+#pragma once
+#include <limits.h>
+#include <stdatomic.h>
+
+#define LATENCY_MAX_STEPS 8
+// Length of one measurement window, in seconds.
+#define LATENCY_WINDOW 0.5
+// Clean windows required before trying the next smaller buffer.
+#define LATENCY_STABLE_WINDOWS 4
+// Fraction of real time a callback may spend rendering before the buffer is grown.
+#define LATENCY_MAX_LOAD 0.8f
+// Load below which a smaller buffer is worth trying.
+#define LATENCY_SHRINK_LOAD 0.4f
+
+// Picks the smallest software latency that stays underflow-free. Latencies are min * 2^step.
+// The audio thread reports callbacks and underflows; a control thread calls
+// LatencyManager_evaluate and reopens the stream when it returns a new latency.
+typedef struct {
+    double min, max;
+    int steps; // usable steps: min * 2^(steps - 1) <= max
+    int step;  // current step
+
+    // Lowest voice count that underflowed at each step (INT_MAX if none has).
+    int unsafe_voices[LATENCY_MAX_STEPS];
+    int stable_windows;
+    double window_start;
+    int settling; // first window after (re)opening the stream: underflows are expected
+    int total_underflows;
+
+    // Written by the audio thread.
+    atomic_int underflows;
+    _Atomic(float) peak_load; // highest render time / buffer duration this window
+} LatencyManager;
+
+// Start at the smallest step of [min, max] (seconds).
+void LatencyManager_init(LatencyManager *lm, double min, double max);
+double LatencyManager_latency(const LatencyManager *lm);
+
+// Audio thread.
+void LatencyManager_report_underflow(LatencyManager *lm);
+void LatencyManager_report_callback(LatencyManager *lm, double render_seconds,
+                                    double buffer_seconds);
+
+// Control thread, at any rate; now is a monotonic time in seconds. Returns the latency to
+// reopen the stream with, or 0 to keep the current one.
+double LatencyManager_evaluate(LatencyManager *lm, int voices, double now);
+// The stream could not be reopened at the latency evaluate returned and is back at step.
+// Return there, and stop offering the failed latency: a larger one caps the range, a smaller
+// one is never tried again.
+void LatencyManager_reject(LatencyManager *lm, int step, double now);
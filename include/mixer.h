@@ -0,0 +1,62 @@
+#pragma once
+#include "config.h"
+#include <stddef.h>
+
+#define MIXER_MAX_DIMS 16
+#define MIXER_MAX_FACES 32
+// When a face's table is replaced the old premix fades out over this long, like a reload does
+// outside the mixer.
+#define MIXER_FADE_FRAMES RELOAD_FADE_FRAMES
+
+// Convex shape given by its faces: a point x is inside when normal_f . x <= offset_f for
+// every face f. Normals are stored per dimension (normals[d * faces + f]) so distances to all
+// faces are computed as one vector operation per dimension.
+typedef struct {
+    int dims;
+    int faces;
+    float *normals; // dims * faces, unit length per face
+    float *offsets; // faces
+    float *spans;   // faces; distance from each face to the farthest point of the shape
+} MixerShape;
+
+// Regular polygon with the given number of edges, inradius 1, centred on the origin.
+MixerShape *MixerShape_polygon(int faces);
+// Square, cube, tesseract, ...: 2 * dims faces, inradius 1, centred on the origin.
+MixerShape *MixerShape_hypercube(int dims);
+void MixerShape_destroy(MixerShape *shape);
+
+// Geometric mixer: the cursor's distance to each face sets that table's gain. Gains are
+// computed at control rate, smoothed per block and folded into one pre-mixed table, so the
+// voices read a single table however many faces the shape has.
+typedef struct {
+    MixerShape *shape; // owned
+    size_t length;     // samples per table
+    float cursor[MIXER_MAX_DIMS];
+    float *target; // gains for the current cursor, normalised to sum to 1
+    float *gains;  // smoothed gains the premix was built with
+    float *premix;
+    float *previous;       // premix before the last table change, fading out
+    int fade;              // frames into that fade, MIXER_FADE_FRAMES when done
+    int built;             // premix reflects gains
+    float **faces;         // per face, a table of its own set with Mixer_set_face, or NULL
+    const float **sources; // per face, the table premix was built from
+} Mixer;
+
+Mixer *Mixer_create(MixerShape *shape, size_t length);
+void Mixer_destroy(Mixer *mixer);
+
+// Give face its own table (length samples, copied), played instead of the one passed to
+// Mixer_update; NULL goes back to that. Allocates, so set faces before the mixer plays.
+void Mixer_set_face(Mixer *mixer, int face, const float *table);
+
+// Move the cursor (shape->dims coordinates, clamped to the shape) and recompute target gains.
+void Mixer_set_cursor(Mixer *mixer, const float *position);
+// Compute per-face gains for a cursor position without touching the mixer's state.
+void Mixer_compute_gains(const MixerShape *shape, const float *position, float *gains);
+
+// Once per block on the audio thread: glide the gains towards the target over frames samples
+// and rebuild premix from tables (one per face, length samples each; NULL for a silent face) if
+// they moved, a face's table changed (a patch or reload swapped it) or force is set. A face with
+// its own table plays that instead. Returns the table to play; while fade is short of
+// MIXER_FADE_FRAMES, previous should be played too, at 1 - fade / MIXER_FADE_FRAMES.
+const float *Mixer_update(Mixer *mixer, const float *const *tables, int frames, int force);
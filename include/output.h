@@ -0,0 +1,33 @@
+#pragma once
+#include "config.h"
+#include <soundio/soundio.h>
+#include <stdint.h>
+
+// Converts engine blocks to the device's sample format: mono blocks are fanned out to every
+// channel, stereo pairs go to the first two. Integer formats get TPDF dither; interleaved
+// buffers take a contiguous fast path.
+typedef struct {
+    enum SoundIoFormat format;
+    int bytes_per_sample;
+    float scale;    // full scale for integer formats, 0 for float formats
+    int dither;     // add TPDF dither of one LSB before quantising
+    uint32_t noise_state;
+    float noise[BLOCK_SIZE];
+    // Converted blocks, sized for the widest format: mono or left, right, and the stereo mid.
+    uint64_t scratch[3][BLOCK_SIZE];
+    float mid[BLOCK_SIZE];        // stereo average for devices with more than two channels
+} OutputFormat;
+
+// Best native-endian format the device supports (float32, s32, s24, s16, float64), or
+// SoundIoFormatInvalid if it supports none of them.
+enum SoundIoFormat Output_pick_format(struct SoundIoDevice *device);
+// Returns -1 if format is not one Output_pick_format can return.
+int OutputFormat_init(OutputFormat *of, enum SoundIoFormat format);
+// Write n (<= BLOCK_SIZE) frames of samples to every channel starting at frame. Dither is
+// added to samples in place.
+void OutputFormat_write(OutputFormat *of, const struct SoundIoChannelArea *areas, int channels,
+                        int frame, float *samples, int n);
+// Write a stereo pair: left to channel 0, right to channel 1 and their average to any
+// further channels, or only the average on a mono device. Overwrites left and right.
+void OutputFormat_write_stereo(OutputFormat *of, const struct SoundIoChannelArea *areas,
+                               int channels, int frame, float *left, float *right, int n);
@@ -0,0 +1,70 @@
+#pragma once
+#include "dsp.h"
+#include "filter.h"
+#include "wavetable.h"
+#include <stdatomic.h>
+
+#define PATCH_NAME_SIZE 32
+
+// Everything a preset sets: the table in each slot, the slot levels and the lowpass. A patch
+// is built and precomputed on a non-audio thread and never changes once published, so the
+// audio thread can read it without locks. Edits are made on a clone that is published in turn.
+typedef struct Patch {
+    char name[PATCH_NAME_SIZE];
+    Wavetable *tables; // NUM_WAVETABLES tables owned by the patch
+    float *levels;     // NUM_WAVETABLES level multipliers
+    float cutoff, q;
+    BiquadFilter filter; // coefficients designed from cutoff and q; z1/z2 are unused
+    DspInterp interp;    // oscillator interpolation
+
+    // Set by PatchSlot.
+    unsigned long serial; // distinct for every publish, so readers can spot a new patch
+    unsigned long retired_at;
+    struct Patch *next_retired;
+} Patch;
+
+int Patch_preset_count(void);
+// Build preset index (0 <= index < Patch_preset_count()), loading and computing its tables.
+Patch *Patch_preset(int index);
+
+// Sine, saw, square and triangle at full level with the lowpass wide open.
+Patch *Patch_create(const char *name);
+Patch *Patch_clone(const Patch *patch);
+void Patch_destroy(Patch *patch);
+
+// Only for patches that have not been published.
+void Patch_set_waveform(Patch *patch, int slot, Waveform type);
+// Returns -1 and keeps the current table if filename cannot be read.
+int Patch_load_table(Patch *patch, int slot, const char *filename);
+void Patch_set_level(Patch *patch, int slot, float level);
+void Patch_set_filter(Patch *patch, float cutoff, float q);
+void Patch_set_interp(Patch *patch, DspInterp interp);
+
+// Read-copy-update holder for the playing patch. One publisher thread swaps patches in with a
+// single atomic exchange; one reader (the audio thread) brackets each block with enter/exit.
+// A replaced patch is freed by the publisher once the reader has finished a block after the
+// swap, so it can never be freed while a block is still using it.
+typedef struct {
+    _Atomic(Patch *) current;
+    atomic_ulong quiescent; // blocks the reader has finished
+
+    // Publisher-owned.
+    unsigned long next_serial;
+    Patch *retired;
+} PatchSlot;
+
+void PatchSlot_init(PatchSlot *slot);
+// Frees the current and retired patches; the reader must have stopped.
+void PatchSlot_destroy(PatchSlot *slot);
+
+// Publisher. Publish takes ownership of patch (NULL clears the slot) and retires the old
+// one. Current is the publisher's view and stays valid until its next publish or reclaim.
+void PatchSlot_publish(PatchSlot *slot, Patch *patch);
+const Patch *PatchSlot_current(PatchSlot *slot);
+// Free retired patches the reader has moved past; returns how many.
+int PatchSlot_reclaim(PatchSlot *slot);
+
+// Reader: wait-free. The patch from enter stays valid until exit; exit on its own just
+// reports that the reader holds nothing (e.g. for a block that did not render).
+const Patch *PatchSlot_enter(PatchSlot *slot);
+void PatchSlot_exit(PatchSlot *slot);
@@ -0,0 +1,47 @@
+#pragma once
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+typedef enum {
+    RECORDER_WAV, // stereo IEEE float WAV at SAMPLE_RATE
+    RECORDER_RAW, // headerless little-endian float32, left and right interleaved
+} RecorderFormat;
+
+// Records the stereo master output to disk. The audio thread interleaves blocks into a
+// single-producer, single-consumer ring without locks or allocation; a writer thread drains it
+// to the file in large sequential writes into preallocated space. If the disk falls behind,
+// frames that do not fit are dropped and counted rather than blocking the callback.
+typedef struct {
+    float *ring;
+    size_t capacity; // power of two, in samples (two per frame)
+    atomic_size_t write_pos; // advanced by the audio thread only
+    atomic_size_t read_pos;  // advanced by the writer only
+    atomic_int recording;
+    atomic_ulong overruns; // frames dropped because the ring was full
+    atomic_ulong frames;   // frames written to the current file
+
+    // Writer-owned.
+    int fd;
+    RecorderFormat format;
+    float *chunk;
+    size_t allocated; // bytes reserved on disk
+    pthread_t thread;
+    atomic_int stopping;
+} Recorder;
+
+// capacity is rounded up to a power of two; it is all the memory a recording ever uses.
+Recorder *Recorder_create(size_t capacity);
+// Stops any recording in progress.
+void Recorder_destroy(Recorder *rec);
+
+// UI thread. Start returns -1 if the file cannot be created or a recording is running. Stop
+// drains what is buffered, finalises the header and trims the preallocation.
+int Recorder_start(Recorder *rec, const char *filename, RecorderFormat format);
+void Recorder_stop(Recorder *rec);
+int Recorder_is_recording(Recorder *rec);
+double Recorder_seconds(Recorder *rec);
+unsigned long Recorder_overruns(Recorder *rec);
+
+// Audio thread: wait-free, a no-op when not recording. Records n frames of left and right.
+void Recorder_write(Recorder *rec, const float *left, const float *right, int n);
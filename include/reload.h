@@ -0,0 +1,45 @@
+#pragma once
+#include "state.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+#define RELOAD_MAX_WATCHES 8
+#define RELOAD_MAX_LENGTH (1 << 20) // longest table file accepted, in samples
+
+// Watches a directory with inotify and reloads wavetable files (the .bin format written by
+// resampler.py and wave_extract) into their slots while the engine plays. A background thread
+// reads and validates the file, resamples it to the slot's length and builds mips, then offers
+// it to the State, which fades it in; the audio thread never touches the filesystem or the
+// allocator. Tables the audio thread has finished with are freed on the reload thread.
+typedef struct {
+    State *state;
+    char dir[256];
+    int num_watches;
+    struct {
+        int slot;
+        char filename[64];
+    } watches[RELOAD_MAX_WATCHES];
+
+    int fd;      // inotify instance
+    int wake[2]; // self-pipe that stops the thread
+    pthread_t thread;
+    int running;
+    atomic_ulong reloads;  // tables offered to the engine
+    atomic_ulong rejected; // files that failed to load or validate
+} Reloader;
+
+Reloader *Reloader_create(State *state, const char *dir);
+// Stops watching. Call before State_destroy.
+void Reloader_destroy(Reloader *reloader);
+
+// Reload slot from dir/filename whenever it is written or moved into place. Before start.
+int Reloader_watch(Reloader *reloader, int slot, const char *filename);
+// Returns -1 if inotify or the thread cannot be set up; reloads can still be done by hand.
+int Reloader_start(Reloader *reloader);
+
+// Load, validate and offer one watched slot now, on the calling thread. Returns -1 if the
+// file is missing, malformed or holds non-finite samples.
+int Reloader_load(Reloader *reloader, int slot);
+unsigned long Reloader_reloads(Reloader *reloader);
+unsigned long Reloader_rejected(Reloader *reloader);
@@ -0,0 +1,83 @@
+#pragma once
+#include "fft.h"
+#include "wavetable.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+#define SPECTRAL_MAX_MIPS 12
+
+typedef struct {
+    int harmonic;
+    float magnitude, phase;
+} SpectralEdit;
+
+// One published build of a spectral table. mips[0] holds every harmonic; each further level
+// halves the harmonic count so high notes can play a band-limited copy.
+typedef struct {
+    size_t length;
+    int num_mips;
+    float *mips[SPECTRAL_MAX_MIPS];
+    int max_harmonic[SPECTRAL_MAX_MIPS];
+} SpectralFrame;
+
+// Additive wavetable edited by harmonic magnitude and phase. Edits come from any non-audio
+// thread; a worker thread rebuilds only what changed and publishes a new frame with an atomic
+// pointer swap. One audio thread reads it through acquire/release and never blocks.
+typedef struct {
+    size_t length;
+    int num_harmonics; // harmonics 1..num_harmonics (length / 2 - 1)
+    int num_mips;
+
+    // Requested spectrum, guarded by mutex.
+    float *magnitudes, *phases; // indexed by harmonic number
+    unsigned char *dirty;
+    int pending; // edits not yet picked up by the worker
+    int busy;    // worker is rebuilding
+    pthread_mutex_t mutex;
+    pthread_cond_t wake;
+    pthread_cond_t idle;
+
+    // Worker-owned.
+    float *built_magnitudes, *built_phases; // what the published frame contains
+    float *sin_table, *cos_table;           // one period, for per-harmonic deltas
+    float *delta;
+    SpectralEdit *edits;
+    int updates_since_full;
+    Fft *fft;
+    FftComplex *spectrum;
+    pthread_t thread;
+    int running;
+
+    // Three frames: the published one, the one the audio thread may still hold, and a spare.
+    SpectralFrame frames[3];
+    _Atomic(SpectralFrame *) published;
+    _Atomic(SpectralFrame *) in_use;
+    _Atomic(float) last_rebuild_ms;
+} SpectralTable;
+
+// length must be a power of two; num_mips is clamped to what the harmonic count allows.
+SpectralTable *SpectralTable_create(size_t length, int num_mips);
+void SpectralTable_destroy(SpectralTable *st);
+
+// Editor side. Harmonics are 1-based; phase is in radians of a sine.
+void SpectralTable_set_harmonic(SpectralTable *st, int harmonic, float magnitude, float phase);
+float SpectralTable_get_magnitude(SpectralTable *st, int harmonic);
+float SpectralTable_get_phase(SpectralTable *st, int harmonic);
+// Replace the whole spectrum with the analysis of wt (resampled lengths are not supported).
+int SpectralTable_analyze(SpectralTable *st, const Wavetable *wt);
+// Block until every edit so far has been published.
+void SpectralTable_flush(SpectralTable *st);
+float SpectralTable_last_rebuild_ms(SpectralTable *st);
+
+// Audio side: pin the current frame for the duration of a block, then release it.
+const SpectralFrame *SpectralTable_acquire(SpectralTable *st);
+void SpectralTable_release(SpectralTable *st);
+// Most detailed mip whose harmonics all stay below Nyquist at phase_inc table samples per
+// output sample.
+const float *SpectralFrame_mip(const SpectralFrame *frame, double phase_inc);
+
+// Standalone frame band-limited from one period of table (any length >= 4), each mip keeping
+// half the harmonics of the one before. Allocates; for non-audio threads.
+SpectralFrame *SpectralFrame_build(const float *table, size_t length, int num_mips);
+void SpectralFrame_destroy(SpectralFrame *frame);
@@ -1,28 +1,93 @@
 #pragma once
 #include "osc.h"
 #include "wavetable.h"
+#include "effects.h"
 #include "filter.h"
+#include "mixer.h"
+#include "patch.h"
+#include "spectral.h"
 
 // Fixed constants.
 extern const int NUM_OSCS;       // oscillators per voice (e.g., 4)
 extern const int NUM_WAVETABLES; // number of shared wavetables (e.g., 4)
 extern const int NUM_VOICES;     // maximum polyphony (e.g., 8)
 
+// The static tables, built once and shared read-only by every State that plays them. Each
+// State holds a reference; the tables are freed with the last one.
+typedef struct {
+    Wavetable *wts; // NUM_WAVETABLES tables: sine, saw, square and Trumpet.bin
+    atomic_int refs;
+} TablePool;
+
+// Builds the tables (and reads Trumpet.bin) with one reference held by the caller.
+TablePool *TablePool_create(void);
+TablePool *TablePool_retain(TablePool *pool);
+void TablePool_release(TablePool *pool);
+
+// Hands a replacement table for one slot to the audio thread, which fades it in over
+// RELOAD_FADE_FRAMES and passes the table it replaced back to be freed. Each mailbox holds
+// one frame, so the audio thread never allocates or frees.
+typedef struct {
+    _Atomic(SpectralFrame *) pending; // offered, not yet taken by the audio thread
+    _Atomic(SpectralFrame *) retired; // faded out, waiting to be freed
+    // Audio-owned.
+    SpectralFrame *playing;  // NULL plays wts[slot]
+    SpectralFrame *previous; // fading out; NULL while fading means wts[slot]
+    int fade;                // frames into the crossfade, RELOAD_FADE_FRAMES when done
+} HotSlot;
+
 typedef struct {
     Osc *oscs;        // array of oscillators; size = NUM_VOICES * NUM_OSCS
-    Wavetable *wts;   // shared array of NUM_WAVETABLES wavetables
+    TablePool *pool;
+    const Wavetable *wts; // pool->wts, never written through a State
     float *wt_levels; // per-wavetable level multipliers; array of NUM_WAVETABLES floats
     int *active;      // for each voice (size NUM_VOICES), 1 if active, 0 if not
+    SpectralTable **spectral; // per-wavetable spectral source (NULL plays wts[i] as is)
+    HotSlot *hot;             // per-wavetable reloaded table, replacing wts[i] when set
+    Mixer *mixer;             // geometric mixer; NULL mixes oscillators with wt_levels
     LowpassFilter lpf;
+    Effects *effects;           // send effects after lpf, run by the audio callback
+    DspInterp interp;           // oscillator interpolation in the live settings
+    PatchSlot patches;          // published patch; while one is set it replaces wts, wt_levels,
+                                // interp and the lowpass coefficients
+    unsigned long patch_serial; // patch whose coefficients lpf holds, 0 for the live settings
 } State;
 
+// A standalone engine: its own table pool and send effects.
 State *State_create(void);
+// A lightweight engine playing pool's tables (it takes a reference) with no send effects
+// (effects is NULL), so it owns only its voices, levels, filter and reload slots.
+State *State_create_shared(TablePool *pool);
 void State_destroy(State *state);
 
 // For a given voice (0-indexed), set the note (all oscillators in that voice).
 void State_set_note(State *state, int voice, double freq);
+// Change a playing voice's frequency without restarting its phase (glides).
+void State_set_freq(State *state, int voice, double freq);
 // Clear (turn off) a given voice.
 void State_clear_voice(State *state, int voice);
+// Number of voices currently playing.
+int State_active_voices(const State *state);
+
+// Play slot from st instead of its static table; NULL detaches. The caller keeps ownership
+// of a detached table, but State_destroy destroys any that are still attached.
+void State_set_spectral(State *state, int slot, SpectralTable *st);
+
+// Mix wavetables through a geometric mixer instead of wt_levels; face f plays slot f, or the
+// table set with Mixer_set_face, and faces past the slots are silent without one. A slot whose
+// table is not mixer->length samples is silent. NULL detaches. Ownership works as for
+// State_set_spectral.
+void State_set_mixer(State *state, Mixer *mixer);
+
+// Replace slot's table with frame (see reload.h); takes ownership. Frames must be
+// wts[slot].length long. A frame offered before the last was taken is freed unplayed.
+void State_offer_table(State *state, int slot, SpectralFrame *frame);
+// Free tables the audio thread has finished with; returns how many. Same thread as offer.
+int State_collect_tables(State *state);
 
-// Mix and return one audio sample.
+// Mix and return one audio sample (per-sample reference path; always uses wts, wt_levels and
+// interp).
 float State_mix_sample(State *state);
+// Mix frames samples into out using the active DSP kernels. Reads the published patch once
+// for the whole block and, when it has changed, moves lpf onto its coefficients.
+void State_render(State *state, float *out, int frames);
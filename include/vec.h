@@ -18,6 +18,8 @@ typedef struct {
 Vec *Vec_create(size_t element_size, ElemDestroyFunc destroy_func);
 void Vec_push_back(Vec *vec, const void *element);
 void Vec_get(const Vec *vec, size_t index, void *out_element);
+// Pointer to the element in place; valid until the next push_back.
+void *Vec_at(const Vec *vec, size_t index);
 void Vec_set(Vec *vec, size_t index, const void *element);
 void Vec_pop_back(Vec *vec);
 void Vec_destroy(Vec *vec);
@@ -32,6 +34,9 @@ void Vec_destroy(Vec *vec);
  * This macro creates:
  *  - A typedef for a structure wrapping a generic Vec pointer.
  *  - Inline functions for creating, destroying, pushing back, and getting elements.
+ *
+ * push_back may reallocate, so keep these off the audio thread; containers.h has fixed-size
+ * equivalents for engine code.
  */
 #define DECLARE_VEC_TYPE(Type, Name, DestroyFunc)                                                  \
     typedef struct {                                                                               \
@@ -58,4 +63,8 @@ void Vec_destroy(Vec *vec);
         Type temp;                                                                                 \
         Vec_get(typed->vec, index, &temp);                                                         \
         return temp;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static inline Type *Vec_##Name##_at(const Vec_##Name *typed, size_t index) {                   \
+        return Vec_at(typed->vec, index);                                                          \
     }
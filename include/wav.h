@@ -0,0 +1,6 @@
+#pragma once
+#include <stddef.h>
+
+// Read a PCM (8/16/24/32-bit) or IEEE float (32/64-bit) WAV file and downmix it to mono
+// floats in [-1, 1]. On success *samples is malloc'd and owned by the caller.
+int Wav_read_mono(const char *filename, float **samples, size_t *length, int *sample_rate);
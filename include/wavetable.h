@@ -1,4 +1,5 @@
 #pragma once
+#include <stdio.h>
 #include <stdlib.h>
 
 typedef enum { WAVEFORM_SINE, WAVEFORM_SAW, WAVEFORM_SQUARE, WAVEFORM_TRIANGLE, WAVEFORM_CUSTOM } Waveform;
@@ -12,4 +13,12 @@ typedef struct {
 Wavetable *Wavetable_create(Waveform type, size_t length);
 void Wavetable_destroy(Wavetable *wt);
 
-int Wavetable_load(Wavetable *wt, const char *filename);
\ No newline at end of file
+// Replaces wt's data and length without freeing the old data, so load into an empty table.
+// On failure wt->data is NULL or untouched.
+int Wavetable_load(Wavetable *wt, const char *filename);
+// As Wavetable_load, but fails without allocating if the file's length field is over max_length
+// samples or more than the file holds.
+int Wavetable_load_max(Wavetable *wt, const char *filename, size_t max_length);
+int Wavetable_save(const Wavetable *wt, const char *filename);
+// Append one .bin record to an open file (bank files are records back to back).
+int Wavetable_write(const Wavetable *wt, FILE *f);
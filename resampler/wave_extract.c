@@ -0,0 +1,215 @@
+// Native replacement for resampler.py: turns WAV notes into .bin wavetables, one file per
+// worker thread across all cores.
+//
+//   wave_extract [-j threads] [--freq hz] [--table-size n] [--top-db db] [-o dir]
+//                [--bank file] input.wav|dir ...
+
+#include "extract.h"
+#include "wav.h"
+#include "wavetable.h"
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef struct {
+    char *path;
+    Wavetable *wt; // result, kept for --bank
+    double freq;
+    int ok;
+} Job;
+
+typedef struct {
+    Job *jobs;
+    int count;
+    int next;
+    const char *out_dir;
+    ExtractOptions opts;
+    pthread_mutex_t mutex;
+} Queue;
+
+static int has_wav_ext(const char *name) {
+    size_t len = strlen(name);
+    return len > 4 && (strcmp(name + len - 4, ".wav") == 0 || strcmp(name + len - 4, ".WAV") == 0);
+}
+
+static int compare_jobs(const void *a, const void *b) {
+    return strcmp(((const Job *)a)->path, ((const Job *)b)->path);
+}
+
+static void add_job(Job **jobs, int *count, int *capacity, const char *path) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 16;
+        *jobs = realloc(*jobs, *capacity * sizeof(Job));
+        if (!*jobs) {
+            fprintf(stderr, "Out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    (*jobs)[*count] = (Job){strdup(path), NULL, 0.0, 0};
+    (*count)++;
+}
+
+static void add_input(Job **jobs, int *count, int *capacity, const char *path) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        fprintf(stderr, "%s: not found\n", path);
+        return;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        add_job(jobs, count, capacity, path);
+        return;
+    }
+    DIR *dir = opendir(path);
+    if (!dir) {
+        fprintf(stderr, "%s: cannot open directory\n", path);
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir))) {
+        if (!has_wav_ext(entry->d_name))
+            continue;
+        char full[4096];
+        snprintf(full, sizeof(full), "%s/%s", path, entry->d_name);
+        add_job(jobs, count, capacity, full);
+    }
+    closedir(dir);
+}
+
+static void output_path(const char *out_dir, const char *input, char *out, size_t size) {
+    const char *base = strrchr(input, '/');
+    base = base ? base + 1 : input;
+    const char *dot = strrchr(base, '.');
+    int stem = dot ? (int)(dot - base) : (int)strlen(base);
+    snprintf(out, size, "%s/%.*s.bin", out_dir, stem, base);
+}
+
+static void process(Queue *queue, Job *job) {
+    float *samples = NULL;
+    size_t length = 0;
+    int sample_rate = 0;
+    if (Wav_read_mono(job->path, &samples, &length, &sample_rate) != 0) {
+        fprintf(stderr, "%s: unreadable or unsupported WAV\n", job->path);
+        return;
+    }
+    job->wt = Extract_wavetable(samples, length, sample_rate, &queue->opts, &job->freq);
+    free(samples);
+    if (!job->wt) {
+        fprintf(stderr, "%s: could not extract a cycle (pitch %.2f Hz)\n", job->path, job->freq);
+        return;
+    }
+    char out[4096];
+    output_path(queue->out_dir, job->path, out, sizeof(out));
+    if (Wavetable_save(job->wt, out) != 0) {
+        fprintf(stderr, "%s: cannot write\n", out);
+        return;
+    }
+    job->ok = 1;
+    printf("%s: %.2f Hz -> %s\n", job->path, job->freq, out);
+}
+
+static void *worker(void *arg) {
+    Queue *queue = arg;
+    for (;;) {
+        pthread_mutex_lock(&queue->mutex);
+        int index = queue->next < queue->count ? queue->next++ : -1;
+        pthread_mutex_unlock(&queue->mutex);
+        if (index < 0)
+            return NULL;
+        process(queue, &queue->jobs[index]);
+    }
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [-j threads] [--freq hz] [--table-size n] [--top-db db] [-o dir]\n"
+            "       [--bank file] input.wav|dir ...\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    Queue queue;
+    queue.opts = ExtractOptions_default();
+    queue.out_dir = "bin_samples";
+    queue.next = 0;
+    pthread_mutex_init(&queue.mutex, NULL);
+    const char *bank_path = NULL;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    Job *jobs = NULL;
+    int count = 0, capacity = 0;
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        int has_value = i + 1 < argc;
+        if (strcmp(arg, "-j") == 0 && has_value) {
+            threads = atol(argv[++i]);
+        } else if (strcmp(arg, "--freq") == 0 && has_value) {
+            queue.opts.freq = atof(argv[++i]);
+        } else if (strcmp(arg, "--table-size") == 0 && has_value) {
+            queue.opts.table_size = (size_t)atol(argv[++i]);
+        } else if (strcmp(arg, "--top-db") == 0 && has_value) {
+            queue.opts.top_db = (float)atof(argv[++i]);
+        } else if (strcmp(arg, "-o") == 0 && has_value) {
+            queue.out_dir = argv[++i];
+        } else if (strcmp(arg, "--bank") == 0 && has_value) {
+            bank_path = argv[++i];
+        } else if (arg[0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            add_input(&jobs, &count, &capacity, arg);
+        }
+    }
+    if (count == 0 || queue.opts.table_size == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    qsort(jobs, count, sizeof(Job), compare_jobs);
+    mkdir(queue.out_dir, 0755);
+
+    if (threads < 1)
+        threads = 1;
+    if (threads > count)
+        threads = count;
+    queue.jobs = jobs;
+    queue.count = count;
+    pthread_t *pool = malloc(threads * sizeof(pthread_t));
+    if (!pool) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    long started = 0;
+    while (started < threads && pthread_create(&pool[started], NULL, worker, &queue) == 0)
+        started++;
+    if (started < threads) {
+        // Workers pull from a shared queue, so this thread takes up whatever they leave.
+        fprintf(stderr, "Started %ld of %ld threads\n", started, threads);
+        worker(&queue);
+    }
+    for (long t = 0; t < started; t++)
+        pthread_join(pool[t], NULL);
+    free(pool);
+
+    int failed = 0;
+    FILE *bank = NULL;
+    if (bank_path && !(bank = fopen(bank_path, "wb"))) {
+        fprintf(stderr, "%s: cannot write\n", bank_path);
+        failed = 1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (!jobs[i].ok)
+            failed = 1;
+        else if (bank && Wavetable_write(jobs[i].wt, bank) != 0)
+            failed = 1;
+        Wavetable_destroy(jobs[i].wt);
+        free(jobs[i].path);
+    }
+    if (bank && fclose(bank) != 0)
+        failed = 1;
+    free(jobs);
+    pthread_mutex_destroy(&queue.mutex);
+    return failed;
+}
@@ -0,0 +1,213 @@
+#include "analyzer.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ANALYZER_POLL_NS (4 * 1000 * 1000)
+
+_Static_assert((ANALYZER_FFT_SIZE & (ANALYZER_FFT_SIZE - 1)) == 0,
+               "the analyzer history is indexed with a mask");
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static float band_edge(float band) {
+    return ANALYZER_MIN_HZ * powf(ANALYZER_MAX_HZ / ANALYZER_MIN_HZ, band / ANALYZER_BANDS);
+}
+
+float Analyzer_band_hz(int band) {
+    return band_edge(band + 0.5f);
+}
+
+// Reset what the display shows; the worker must not be running.
+static void clear(Analyzer *an) {
+    memset(an->history, 0, ANALYZER_FFT_SIZE * sizeof(float));
+    an->history_pos = 0;
+    an->pending = ANALYZER_HOP - ANALYZER_FFT_SIZE;
+    for (int b = 0; b < ANALYZER_BANDS; b++) {
+        an->bands[b] = an->peaks[b] = ANALYZER_FLOOR_DB;
+        an->hold[b] = 0.0f;
+    }
+    pthread_mutex_lock(&an->mutex);
+    memcpy(an->published_bands, an->bands, sizeof(an->bands));
+    memcpy(an->published_peaks, an->peaks, sizeof(an->peaks));
+    an->produced = an->consumed = 0;
+    pthread_mutex_unlock(&an->mutex);
+}
+
+Analyzer *Analyzer_create(void) {
+    Analyzer *an = calloc(1, sizeof(Analyzer));
+    assert(an);
+    SpscRing_AnalyzerBlock_init(&an->tap);
+    atomic_init(&an->enabled, 0);
+    atomic_init(&an->dropped, 0);
+    atomic_init(&an->stopping, 0);
+    atomic_init(&an->last_analysis_ms, 0.0f);
+    pthread_mutex_init(&an->mutex, NULL);
+    an->fft = Fft_create(ANALYZER_FFT_SIZE);
+    an->spectrum = malloc(ANALYZER_FFT_SIZE * sizeof(FftComplex));
+    an->window = malloc(ANALYZER_FFT_SIZE * sizeof(float));
+    an->history = malloc(ANALYZER_FFT_SIZE * sizeof(float));
+    assert(an->spectrum && an->window && an->history);
+    // Periodic Hann window: overlapping at a quarter of its length, frames sum to a constant.
+    for (int i = 0; i < ANALYZER_FFT_SIZE; i++)
+        an->window[i] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / ANALYZER_FFT_SIZE);
+    // Bins each band covers. Low bands are narrower than a bin and read between bins instead.
+    const float bin_hz = (float)SAMPLE_RATE / ANALYZER_FFT_SIZE;
+    for (int b = 0; b < ANALYZER_BANDS; b++) {
+        an->band_first[b] = (int)ceilf(band_edge((float)b) / bin_hz);
+        an->band_last[b] = (int)ceilf(band_edge(b + 1.0f) / bin_hz) - 1;
+        if (an->band_last[b] >= ANALYZER_FFT_SIZE / 2)
+            an->band_last[b] = ANALYZER_FFT_SIZE / 2 - 1;
+        an->band_center[b] = Analyzer_band_hz(b) / bin_hz;
+    }
+    clear(an);
+    return an;
+}
+
+void Analyzer_destroy(Analyzer *an) {
+    if (!an)
+        return;
+    Analyzer_stop(an);
+    pthread_mutex_destroy(&an->mutex);
+    Fft_destroy(an->fft);
+    free(an->history);
+    free(an->window);
+    free(an->spectrum);
+    free(an);
+}
+
+static float power(const FftComplex *bin) {
+    return bin->re * bin->re + bin->im * bin->im;
+}
+
+// Transform the last ANALYZER_FFT_SIZE samples and publish their bands.
+static void analyze(Analyzer *an) {
+    double start = now_ms();
+    const size_t mask = ANALYZER_FFT_SIZE - 1;
+    for (size_t i = 0; i < ANALYZER_FFT_SIZE; i++) {
+        an->spectrum[i].re = an->history[(an->history_pos + i) & mask] * an->window[i];
+        an->spectrum[i].im = 0.0f;
+    }
+    Fft_forward(an->fft, an->spectrum);
+
+    // A full-scale sine peaks at N / 4 through the Hann window's gain of one half.
+    const float scale = 16.0f / ((float)ANALYZER_FFT_SIZE * ANALYZER_FFT_SIZE);
+    const float dt = (float)ANALYZER_HOP / SAMPLE_RATE;
+    for (int b = 0; b < ANALYZER_BANDS; b++) {
+        // The strongest bin in the band, so a narrow alias stays visible at high frequencies.
+        float p = 0.0f;
+        if (an->band_first[b] <= an->band_last[b]) {
+            for (int k = an->band_first[b]; k <= an->band_last[b]; k++)
+                p = fmaxf(p, power(&an->spectrum[k]));
+        } else {
+            int k = (int)an->band_center[b];
+            float frac = an->band_center[b] - k;
+            float a = sqrtf(power(&an->spectrum[k])), c = sqrtf(power(&an->spectrum[k + 1]));
+            p = a + frac * (c - a);
+            p *= p;
+        }
+        float db = 10.0f * log10f(p * scale + 1e-20f);
+        an->bands[b] = fmaxf(db, ANALYZER_FLOOR_DB);
+        if (an->bands[b] >= an->peaks[b]) {
+            an->peaks[b] = an->bands[b];
+            an->hold[b] = ANALYZER_HOLD_SECONDS;
+        } else if (an->hold[b] > 0.0f) {
+            an->hold[b] -= dt;
+        } else {
+            an->peaks[b] = fmaxf(an->peaks[b] - ANALYZER_FALL_DB * dt, an->bands[b]);
+        }
+    }
+    atomic_store(&an->last_analysis_ms, (float)(now_ms() - start));
+
+    pthread_mutex_lock(&an->mutex);
+    memcpy(an->published_bands, an->bands, sizeof(an->bands));
+    memcpy(an->published_peaks, an->peaks, sizeof(an->peaks));
+    an->produced++;
+    pthread_mutex_unlock(&an->mutex);
+}
+
+static void feed(Analyzer *an, const float *samples, int n) {
+    for (int i = 0; i < n; i++) {
+        an->history[an->history_pos] = samples[i];
+        an->history_pos = (an->history_pos + 1) & (ANALYZER_FFT_SIZE - 1);
+        if (++an->pending == ANALYZER_HOP) {
+            an->pending = 0;
+            analyze(an);
+        }
+    }
+}
+
+static void *worker(void *arg) {
+    Analyzer *an = arg;
+    while (!atomic_load(&an->stopping)) {
+        AnalyzerBlock *block = SpscRing_AnalyzerBlock_read_slot(&an->tap);
+        if (!block) {
+            struct timespec pause = {0, ANALYZER_POLL_NS};
+            nanosleep(&pause, NULL);
+            continue;
+        }
+        feed(an, block->samples, block->n);
+        SpscRing_AnalyzerBlock_release(&an->tap);
+    }
+    return NULL;
+}
+
+int Analyzer_start(Analyzer *an) {
+    if (atomic_load(&an->enabled))
+        return 0;
+    // Nothing is reading the tap yet, so this thread can empty it.
+    while (SpscRing_AnalyzerBlock_read_slot(&an->tap))
+        SpscRing_AnalyzerBlock_release(&an->tap);
+    clear(an);
+    atomic_store(&an->stopping, 0);
+    if (pthread_create(&an->thread, NULL, worker, an) != 0)
+        return -1;
+    atomic_store(&an->enabled, 1);
+    return 0;
+}
+
+void Analyzer_stop(Analyzer *an) {
+    if (!atomic_load(&an->enabled))
+        return;
+    atomic_store(&an->enabled, 0);
+    atomic_store(&an->stopping, 1);
+    pthread_join(an->thread, NULL);
+}
+
+int Analyzer_running(Analyzer *an) {
+    return atomic_load(&an->enabled);
+}
+
+int Analyzer_read(Analyzer *an, float *bands, float *peaks) {
+    pthread_mutex_lock(&an->mutex);
+    memcpy(bands, an->published_bands, sizeof(an->published_bands));
+    memcpy(peaks, an->published_peaks, sizeof(an->published_peaks));
+    int fresh = (int)(an->produced - an->consumed);
+    an->consumed = an->produced;
+    pthread_mutex_unlock(&an->mutex);
+    return fresh;
+}
+
+float Analyzer_last_analysis_ms(Analyzer *an) {
+    return atomic_load(&an->last_analysis_ms);
+}
+
+void Analyzer_write(Analyzer *an, const float *samples, int n) {
+    if (!atomic_load_explicit(&an->enabled, memory_order_acquire))
+        return;
+    assert(n <= BLOCK_SIZE);
+    AnalyzerBlock *block = SpscRing_AnalyzerBlock_write_slot(&an->tap);
+    if (!block) {
+        atomic_fetch_add_explicit(&an->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    block->n = n;
+    memcpy(block->samples, samples, n * sizeof(float));
+    SpscRing_AnalyzerBlock_commit(&an->tap);
+}
@@ -0,0 +1,127 @@
+#include "audio.h"
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Bounds for the latency search, in frames; the device's own range narrows them further.
+#define LATENCY_MIN_FRAMES 128
+#define LATENCY_MAX_FRAMES 8192
+
+static const char *const backend_names[AUDIO_BACKEND_COUNT] = {"soundio", "jack", "null"};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+const AudioBackend *Audio_backend(AudioBackendType type) {
+    switch (type) {
+    case AUDIO_BACKEND_SOUNDIO:
+        return Audio_soundio_backend();
+    case AUDIO_BACKEND_JACK:
+        return Audio_jack_backend();
+    case AUDIO_BACKEND_NULL:
+        return Audio_null_backend();
+    default:
+        return NULL;
+    }
+}
+
+int Audio_backend_parse(const char *name) {
+    for (int i = 0; i < AUDIO_BACKEND_COUNT; i++) {
+        if (strcmp(name, backend_names[i]) == 0)
+            return i;
+    }
+    return -1;
+}
+
+int AudioOutput_open(AudioOutput *audio, const AudioConfig *config, AudioRenderFn render,
+                     void *userdata) {
+    memset(audio, 0, sizeof(*audio));
+    audio->render = render;
+    audio->userdata = userdata;
+    atomic_init(&audio->callbacks, 0);
+    atomic_init(&audio->xruns, 0);
+    atomic_init(&audio->max_late_ms, 0.0f);
+    const AudioBackend *backend = Audio_backend(config->type);
+    if (!backend) {
+        fprintf(stderr, "Audio backend %s is not built in.\n",
+                config->type < AUDIO_BACKEND_COUNT ? backend_names[config->type] : "?");
+        return -1;
+    }
+    audio->backend = backend;
+
+    double min = (double)LATENCY_MIN_FRAMES / SAMPLE_RATE;
+    double max = (double)LATENCY_MAX_FRAMES / SAMPLE_RATE;
+    int err = backend->connect(audio, config, &min, &max);
+    if (err) {
+        AudioOutput_close(audio);
+        return err;
+    }
+    if (config->period > 0.0)
+        min = max = config->period;
+    LatencyManager_init(&audio->latency, min, max);
+    err = backend->start(audio, LatencyManager_latency(&audio->latency));
+    if (err)
+        AudioOutput_close(audio);
+    return err;
+}
+
+void AudioOutput_close(AudioOutput *audio) {
+    if (!audio->backend)
+        return;
+    audio->backend->stop(audio);
+    audio->backend->disconnect(audio);
+    audio->backend = NULL;
+}
+
+int AudioOutput_set_latency(AudioOutput *audio, double seconds) {
+    double previous = audio->backend->latency(audio);
+    audio->backend->stop(audio);
+    int err = audio->backend->start(audio, seconds);
+    if (!err)
+        return 0;
+    fprintf(stderr, "Cannot restart audio at %.1f ms; restoring %.1f ms\n", seconds * 1000.0,
+            previous * 1000.0);
+    if (previous <= 0.0 || audio->backend->start(audio, previous) != 0) {
+        fprintf(stderr, "Cannot restore audio output\n");
+        return AUDIO_STOPPED;
+    }
+    return err;
+}
+
+int AudioOutput_tune(AudioOutput *audio, int voices) {
+    if (audio->backend->poll)
+        audio->backend->poll(audio);
+    int step = audio->latency.step;
+    double latency = LatencyManager_evaluate(&audio->latency, voices, now_seconds());
+    if (latency <= 0.0)
+        return 0;
+    int err = AudioOutput_set_latency(audio, latency);
+    if (!err)
+        return 1;
+    LatencyManager_reject(&audio->latency, step, now_seconds());
+    return err == AUDIO_STOPPED ? -1 : 0;
+}
+
+double AudioOutput_latency(const AudioOutput *audio) {
+    return audio->backend ? audio->backend->latency(audio) : 0.0;
+}
+
+double AudioOutput_begin_callback(AudioOutput *audio) {
+    (void)audio;
+    return now_seconds();
+}
+
+void AudioOutput_end_callback(AudioOutput *audio, double start, int frames) {
+    LatencyManager_report_callback(&audio->latency, now_seconds() - start,
+                                   (double)frames / SAMPLE_RATE);
+    atomic_fetch_add_explicit(&audio->callbacks, 1, memory_order_relaxed);
+}
+
+void AudioOutput_report_xrun(AudioOutput *audio) {
+    LatencyManager_report_underflow(&audio->latency);
+    atomic_fetch_add_explicit(&audio->xruns, 1, memory_order_relaxed);
+}
@@ -0,0 +1,134 @@
+#include "audio.h"
+#include "config.h"
+#include <stddef.h>
+
+#ifdef WAVE_HAVE_JACK
+#include <assert.h>
+#include <jack/jack.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// A JACK client with two output ports, connected to the first two physical playback ports.
+// The server owns the period, so the latency manager is pinned to its buffer size.
+typedef struct {
+    jack_client_t *client;
+    jack_port_t *ports[2];
+    int active;
+} JackOutput;
+
+// JACK hands out float buffers, so blocks render straight into them.
+static int process(jack_nframes_t nframes, void *arg) {
+    AudioOutput *audio = arg;
+    JackOutput *jack = audio->impl;
+    float *left = jack_port_get_buffer(jack->ports[0], nframes);
+    float *right = jack_port_get_buffer(jack->ports[1], nframes);
+    double start = AudioOutput_begin_callback(audio);
+    for (int offset = 0; offset < (int)nframes; offset += BLOCK_SIZE) {
+        int block = (int)nframes - offset < BLOCK_SIZE ? (int)nframes - offset : BLOCK_SIZE;
+        audio->render(audio->userdata, left + offset, right + offset, block);
+    }
+    AudioOutput_end_callback(audio, start, (int)nframes);
+    return 0;
+}
+
+static int xrun(void *arg) {
+    AudioOutput_report_xrun(arg);
+    return 0;
+}
+
+static int jk_connect(AudioOutput *audio, const AudioConfig *config, double *min, double *max) {
+    (void)config;
+    JackOutput *jack = calloc(1, sizeof(JackOutput));
+    assert(jack);
+    audio->impl = jack;
+    jack_status_t status;
+    jack->client = jack_client_open("wave", JackNoStartServer, &status);
+    if (!jack->client) {
+        fprintf(stderr, "Cannot connect to the JACK server (status 0x%x)\n", (unsigned)status);
+        return -1;
+    }
+    if (jack_get_sample_rate(jack->client) != SAMPLE_RATE) {
+        fprintf(stderr, "JACK runs at %u Hz; wave needs %d Hz\n",
+                (unsigned)jack_get_sample_rate(jack->client), SAMPLE_RATE);
+        return -1;
+    }
+    const char *names[2] = {"out_1", "out_2"};
+    for (int i = 0; i < 2; i++) {
+        jack->ports[i] = jack_port_register(jack->client, names[i], JACK_DEFAULT_AUDIO_TYPE,
+                                            JackPortIsOutput, 0);
+        if (!jack->ports[i]) {
+            fprintf(stderr, "Cannot register JACK port %s\n", names[i]);
+            return -1;
+        }
+    }
+    jack_set_process_callback(jack->client, process, audio);
+    jack_set_xrun_callback(jack->client, xrun, audio);
+    printf("Using output device: JACK\n");
+    *min = *max = (double)jack_get_buffer_size(jack->client) / SAMPLE_RATE;
+    return 0;
+}
+
+static int jk_start(AudioOutput *audio, double seconds) {
+    (void)seconds;
+    JackOutput *jack = audio->impl;
+    if (jack_activate(jack->client) != 0) {
+        fprintf(stderr, "Cannot activate the JACK client\n");
+        return -1;
+    }
+    jack->active = 1;
+    const char **playback = jack_get_ports(jack->client, NULL, JACK_DEFAULT_AUDIO_TYPE,
+                                           JackPortIsPhysical | JackPortIsInput);
+    for (int i = 0; playback && i < 2 && playback[i]; i++) {
+        if (jack_connect(jack->client, jack_port_name(jack->ports[i]), playback[i]) != 0)
+            fprintf(stderr, "Cannot connect to %s\n", playback[i]);
+    }
+    jack_free(playback);
+    printf("Output format: float32, %.1f ms\n",
+           jack_get_buffer_size(jack->client) * 1000.0 / SAMPLE_RATE);
+    return 0;
+}
+
+static void jk_stop(AudioOutput *audio) {
+    JackOutput *jack = audio->impl;
+    if (jack && jack->active)
+        jack_deactivate(jack->client);
+    if (jack)
+        jack->active = 0;
+}
+
+static void jk_disconnect(AudioOutput *audio) {
+    JackOutput *jack = audio->impl;
+    if (!jack)
+        return;
+    if (jack->client)
+        jack_client_close(jack->client);
+    free(jack);
+    audio->impl = NULL;
+}
+
+static double jk_latency(const AudioOutput *audio) {
+    const JackOutput *jack = audio->impl;
+    return jack && jack->active ? (double)jack_get_buffer_size(jack->client) / SAMPLE_RATE : 0.0;
+}
+
+static const AudioBackend jack_backend = {
+    .name = "jack",
+    .connect = jk_connect,
+    .start = jk_start,
+    .stop = jk_stop,
+    .disconnect = jk_disconnect,
+    .poll = NULL,
+    .latency = jk_latency,
+};
+
+const AudioBackend *Audio_jack_backend(void) {
+    return &jack_backend;
+}
+
+#else
+
+const AudioBackend *Audio_jack_backend(void) {
+    return NULL;
+}
+
+#endif
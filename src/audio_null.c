@@ -0,0 +1,138 @@
+#include "audio.h"
+#include "config.h"
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Well above desktop threads, below the kernel's own interrupt threads (50 on PREEMPT_RT).
+#define NULL_CLOCK_PRIORITY 40
+
+// A device without a device: a thread wakes every period on an absolute CLOCK_MONOTONIC
+// timer, renders one period and throws it away. A render that finishes after the next wake-up
+// is when a real buffer would have run dry, so it counts as an xrun and the timer restarts
+// from there.
+typedef struct {
+    pthread_t thread;
+    atomic_int running;
+    int realtime; // asked for SCHED_FIFO
+    int frames;   // per period
+    float left[BLOCK_SIZE], right[BLOCK_SIZE];
+} NullClock;
+
+static void add_ns(struct timespec *t, long ns) {
+    t->tv_nsec += ns;
+    while (t->tv_nsec >= 1000000000L) {
+        t->tv_nsec -= 1000000000L;
+        t->tv_sec++;
+    }
+}
+
+static double diff_ms(const struct timespec *a, const struct timespec *b) {
+    return (a->tv_sec - b->tv_sec) * 1000.0 + (a->tv_nsec - b->tv_nsec) / 1e6;
+}
+
+static void *tick(void *arg) {
+    AudioOutput *audio = arg;
+    NullClock *timer = audio->impl;
+    long period_ns = (long)((double)timer->frames * 1e9 / SAMPLE_RATE);
+    struct timespec next, now;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (atomic_load_explicit(&timer->running, memory_order_relaxed)) {
+        double start = AudioOutput_begin_callback(audio);
+        for (int offset = 0; offset < timer->frames; offset += BLOCK_SIZE) {
+            int block = timer->frames - offset < BLOCK_SIZE ? timer->frames - offset : BLOCK_SIZE;
+            audio->render(audio->userdata, timer->left, timer->right, block);
+        }
+        AudioOutput_end_callback(audio, start, timer->frames);
+
+        add_ns(&next, period_ns);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (diff_ms(&now, &next) > 0.0) {
+            AudioOutput_report_xrun(audio);
+            next = now;
+            continue;
+        }
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR)
+            ;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        float late = (float)diff_ms(&now, &next);
+        if (late > atomic_load_explicit(&audio->max_late_ms, memory_order_relaxed))
+            atomic_store_explicit(&audio->max_late_ms, late, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+static int null_connect(AudioOutput *audio, const AudioConfig *config, double *min,
+                        double *max) {
+    (void)min;
+    (void)max;
+    NullClock *timer = calloc(1, sizeof(NullClock));
+    assert(timer);
+    atomic_init(&timer->running, 0);
+    timer->realtime = config->realtime;
+    audio->impl = timer;
+    printf("Using output device: null clock\n");
+    return 0;
+}
+
+static int null_start(AudioOutput *audio, double seconds) {
+    NullClock *timer = audio->impl;
+    timer->frames = (int)(seconds * SAMPLE_RATE + 0.5);
+    if (timer->frames < 1)
+        timer->frames = 1;
+    atomic_store(&timer->running, 1);
+    int fifo = 0;
+    if (timer->realtime) {
+        pthread_attr_t attr;
+        struct sched_param param = {.sched_priority = NULL_CLOCK_PRIORITY};
+        pthread_attr_init(&attr);
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        pthread_attr_setschedparam(&attr, &param);
+        fifo = pthread_create(&timer->thread, &attr, tick, audio) == 0;
+        pthread_attr_destroy(&attr);
+    }
+    // Without CAP_SYS_NICE or an rtprio limit, run at normal priority instead.
+    if (!fifo && pthread_create(&timer->thread, NULL, tick, audio) != 0) {
+        atomic_store(&timer->running, 0);
+        fprintf(stderr, "Null clock: cannot start thread\n");
+        return -1;
+    }
+    printf("Output format: null, %.1f ms%s\n", timer->frames * 1000.0 / SAMPLE_RATE,
+           fifo ? ", SCHED_FIFO" : timer->realtime ? ", SCHED_FIFO refused" : "");
+    return 0;
+}
+
+static void null_stop(AudioOutput *audio) {
+    NullClock *timer = audio->impl;
+    if (timer && atomic_exchange(&timer->running, 0))
+        pthread_join(timer->thread, NULL);
+}
+
+static void null_disconnect(AudioOutput *audio) {
+    free(audio->impl);
+    audio->impl = NULL;
+}
+
+static double null_latency(const AudioOutput *audio) {
+    const NullClock *timer = audio->impl;
+    return timer ? (double)timer->frames / SAMPLE_RATE : 0.0;
+}
+
+static const AudioBackend null_backend = {
+    .name = "null",
+    .connect = null_connect,
+    .start = null_start,
+    .stop = null_stop,
+    .disconnect = null_disconnect,
+    .poll = NULL,
+    .latency = null_latency,
+};
+
+const AudioBackend *Audio_null_backend(void) {
+    return &null_backend;
+}
@@ -0,0 +1,185 @@
+#include "audio.h"
+#include "config.h"
+#include "output.h"
+#include <assert.h>
+#include <soundio/soundio.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct {
+    struct SoundIo *soundio;
+    struct SoundIoDevice *device;
+    struct SoundIoOutStream *outstream;
+    OutputFormat output;
+    float left[BLOCK_SIZE], right[BLOCK_SIZE];
+} SoundioOutput;
+
+// Fill what the device asks for a block at a time, converting each to its format.
+static void write_callback(struct SoundIoOutStream *outstream, int frame_count_min,
+                           int frame_count_max) {
+    (void)frame_count_min;
+    AudioOutput *audio = outstream->userdata;
+    SoundioOutput *sio = audio->impl;
+    double start = AudioOutput_begin_callback(audio);
+    int frames_left = frame_count_max;
+    while (frames_left > 0) {
+        int frame_count = frames_left;
+        struct SoundIoChannelArea *areas;
+        int err = soundio_outstream_begin_write(outstream, &areas, &frame_count);
+        if (err) {
+            fprintf(stderr, "begin write error: %s\n", soundio_strerror(err));
+            exit(1);
+        }
+        if (frame_count == 0)
+            break;
+        for (int offset = 0; offset < frame_count; offset += BLOCK_SIZE) {
+            int block = frame_count - offset < BLOCK_SIZE ? frame_count - offset : BLOCK_SIZE;
+            audio->render(audio->userdata, sio->left, sio->right, block);
+            OutputFormat_write_stereo(&sio->output, areas, outstream->layout.channel_count,
+                                      offset, sio->left, sio->right, block);
+        }
+        err = soundio_outstream_end_write(outstream);
+        if (err == SoundIoErrorUnderflow) {
+            // The stream is still valid; let the latency manager grow the buffer.
+            AudioOutput_report_xrun(audio);
+        } else if (err) {
+            fprintf(stderr, "end write error: %s\n", soundio_strerror(err));
+            exit(1);
+        }
+        frames_left -= frame_count;
+    }
+    AudioOutput_end_callback(audio, start, frame_count_max);
+}
+
+static void underflow(struct SoundIoOutStream *outstream) {
+    AudioOutput_report_xrun(outstream->userdata);
+}
+
+static int sio_start(AudioOutput *audio, double seconds) {
+    SoundioOutput *sio = audio->impl;
+    struct SoundIoDevice *device = sio->device;
+    struct SoundIoOutStream *outstream = soundio_outstream_create(device);
+    if (!outstream) {
+        fprintf(stderr, "Out of memory.\n");
+        return SoundIoErrorNoMem;
+    }
+    outstream->format = Output_pick_format(device);
+    if (outstream->format == SoundIoFormatInvalid) {
+        fprintf(stderr, "Device supports no usable sample format.\n");
+        soundio_outstream_destroy(outstream);
+        return SoundIoErrorIncompatibleDevice;
+    }
+    OutputFormat_init(&sio->output, outstream->format);
+    outstream->sample_rate = SAMPLE_RATE;
+    outstream->software_latency = seconds;
+    if (device->layout_count > 0) {
+        int found = 0;
+        for (int i = 0; i < device->layout_count; i++) {
+            if (device->layouts[i].channel_count == 2) {
+                outstream->layout = device->layouts[i];
+                found = 1;
+                break;
+            }
+        }
+        if (!found)
+            outstream->layout = device->layouts[0];
+    } else {
+        outstream->layout = *soundio_channel_layout_get_default(2);
+    }
+    outstream->userdata = audio;
+    outstream->write_callback = write_callback;
+    outstream->underflow_callback = underflow;
+    int err = soundio_outstream_open(outstream);
+    if (err) {
+        fprintf(stderr, "Error opening stream: %s\n", soundio_strerror(err));
+        soundio_outstream_destroy(outstream);
+        return err;
+    }
+    if (outstream->layout_error)
+        fprintf(stderr, "Channel layout error: %s\n", soundio_strerror(outstream->layout_error));
+    err = soundio_outstream_start(outstream);
+    if (err) {
+        fprintf(stderr, "Error starting stream: %s\n", soundio_strerror(err));
+        soundio_outstream_destroy(outstream);
+        return err;
+    }
+    sio->outstream = outstream;
+    printf("Output format: %s, %.1f ms\n", soundio_format_string(outstream->format),
+           outstream->software_latency * 1000.0);
+    return 0;
+}
+
+static void sio_stop(AudioOutput *audio) {
+    SoundioOutput *sio = audio->impl;
+    if (sio && sio->outstream)
+        soundio_outstream_destroy(sio->outstream);
+    if (sio)
+        sio->outstream = NULL;
+}
+
+static void sio_disconnect(AudioOutput *audio) {
+    SoundioOutput *sio = audio->impl;
+    if (!sio)
+        return;
+    if (sio->device)
+        soundio_device_unref(sio->device);
+    if (sio->soundio)
+        soundio_destroy(sio->soundio);
+    free(sio);
+    audio->impl = NULL;
+}
+
+static int sio_connect(AudioOutput *audio, const AudioConfig *config, double *min, double *max) {
+    SoundioOutput *sio = calloc(1, sizeof(SoundioOutput));
+    assert(sio);
+    audio->impl = sio;
+    sio->soundio = soundio_create();
+    if (!sio->soundio) {
+        fprintf(stderr, "Out of memory.\n");
+        return SoundIoErrorNoMem;
+    }
+    enum SoundIoBackend backend = (enum SoundIoBackend)config->soundio_backend;
+    int err = backend == SoundIoBackendNone ? soundio_connect(sio->soundio)
+                                            : soundio_connect_backend(sio->soundio, backend);
+    if (err) {
+        fprintf(stderr, "Error connecting: %s\n", soundio_strerror(err));
+        return err;
+    }
+    soundio_flush_events(sio->soundio);
+    int index = soundio_default_output_device_index(sio->soundio);
+    sio->device = index < 0 ? NULL : soundio_get_output_device(sio->soundio, index);
+    if (!sio->device) {
+        fprintf(stderr, "No output device found.\n");
+        return SoundIoErrorNoSuchDevice;
+    }
+    printf("Using output device: %s\n", sio->device->name);
+    if (sio->device->software_latency_min > *min)
+        *min = sio->device->software_latency_min;
+    if (sio->device->software_latency_max > 0.0 && sio->device->software_latency_max < *max)
+        *max = sio->device->software_latency_max;
+    return 0;
+}
+
+static void sio_poll(AudioOutput *audio) {
+    SoundioOutput *sio = audio->impl;
+    soundio_flush_events(sio->soundio);
+}
+
+static double sio_latency(const AudioOutput *audio) {
+    const SoundioOutput *sio = audio->impl;
+    return sio && sio->outstream ? sio->outstream->software_latency : 0.0;
+}
+
+static const AudioBackend soundio_backend = {
+    .name = "soundio",
+    .connect = sio_connect,
+    .start = sio_start,
+    .stop = sio_stop,
+    .disconnect = sio_disconnect,
+    .poll = sio_poll,
+    .latency = sio_latency,
+};
+
+const AudioBackend *Audio_soundio_backend(void) {
+    return &soundio_backend;
+}
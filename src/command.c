@@ -0,0 +1,112 @@
+#include "command.h"
+#include "config.h"
+#include <string.h>
+#include <time.h>
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void CommandQueue_init(CommandQueue *queue) {
+    SpscRing_CommandBatch_init(&queue->batches);
+    atomic_init(&queue->applied, 0);
+    atomic_init(&queue->dropped, 0);
+    atomic_init(&queue->last_latency_ms, 0.0f);
+    atomic_init(&queue->max_latency_ms, 0.0f);
+}
+
+CommandBatch *CommandQueue_begin(CommandQueue *queue) {
+    CommandBatch *batch = SpscRing_CommandBatch_write_slot(&queue->batches);
+    if (!batch) {
+        atomic_fetch_add(&queue->dropped, 1);
+        return NULL;
+    }
+    batch->count = 0;
+    batch->received = now_seconds();
+    return batch;
+}
+
+void CommandQueue_push(CommandQueue *queue) {
+    SpscRing_CommandBatch_commit(&queue->batches);
+}
+
+static void apply(const Command *command, State *state) {
+    switch (command->type) {
+    case COMMAND_NOTE_ON:
+        State_set_note(state, command->target, command->args[0]);
+        break;
+    case COMMAND_NOTE_OFF:
+        State_clear_voice(state, command->target);
+        break;
+    case COMMAND_LEVEL:
+        if (command->target >= 0 && command->target < NUM_WAVETABLES)
+            state->wt_levels[command->target] = clamp_unit(command->args[0]);
+        break;
+    case COMMAND_CUTOFF:
+        Lowpass_set_cutoff(&state->lpf, clamp_SR(command->args[0]));
+        break;
+    case COMMAND_Q:
+        Lowpass_set_q(&state->lpf, clamp_unit(command->args[0]) + 0.01f);
+        break;
+    case COMMAND_CURSOR:
+        // Coordinates left out keep their current value.
+        if (state->mixer) {
+            float cursor[MIXER_MAX_DIMS];
+            memcpy(cursor, state->mixer->cursor, sizeof(cursor));
+            memcpy(cursor, command->args, command->target * sizeof(float));
+            Mixer_set_cursor(state->mixer, cursor);
+        }
+        break;
+    case COMMAND_DELAY: {
+        // Values left out keep their current setting, as for the cursor. Shared engines
+        // have no send effects.
+        Effects *fx = state->effects;
+        if (!fx)
+            break;
+        float v[3] = {fx->delay_send, (float)(fx->echo_target / SAMPLE_RATE), fx->echo_feedback};
+        memcpy(v, command->args, command->target * sizeof(float));
+        Effects_set_delay(fx, v[0], v[1], v[2]);
+        break;
+    }
+    case COMMAND_REVERB: {
+        Effects *fx = state->effects;
+        if (!fx)
+            break;
+        float v[3] = {fx->reverb_send, fx->decay, fx->damping};
+        memcpy(v, command->args, command->target * sizeof(float));
+        Effects_set_reverb(fx, v[0], v[1], v[2]);
+        break;
+    }
+    case COMMAND_INTERP:
+        if (command->target >= 0 && command->target < DSP_INTERP_COUNT)
+            state->interp = (DspInterp)command->target;
+        break;
+    }
+}
+
+void CommandQueue_apply(CommandQueue *queue, State *state) {
+    const CommandBatch *batch = SpscRing_CommandBatch_read_slot(&queue->batches);
+    if (!batch)
+        return;
+    double now = now_seconds();
+    float max = atomic_load_explicit(&queue->max_latency_ms, memory_order_relaxed);
+    unsigned long applied = 0;
+    for (; batch; batch = SpscRing_CommandBatch_read_slot(&queue->batches)) {
+        for (int i = 0; i < batch->count; i++)
+            apply(&batch->commands[i], state);
+        applied += batch->count;
+        float latency = (float)((now - batch->received) * 1000.0);
+        atomic_store_explicit(&queue->last_latency_ms, latency, memory_order_relaxed);
+        if (latency > max)
+            max = latency;
+        SpscRing_CommandBatch_release(&queue->batches);
+    }
+    atomic_store_explicit(&queue->max_latency_ms, max, memory_order_relaxed);
+    atomic_fetch_add_explicit(&queue->applied, applied, memory_order_relaxed);
+}
+
+void CommandQueue_reset_latency(CommandQueue *queue) {
+    atomic_store(&queue->max_latency_ms, 0.0f);
+}
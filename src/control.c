@@ -0,0 +1,294 @@
+#include "control.h"
+#include <arpa/inet.h>
+#include <assert.h>
+#include <errno.h>
+#include <float.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CONTROL_MAX_PACKET 65536
+#define CONTROL_MAX_DEPTH 4             // nested bundles
+#define CONTROL_RECV_BUFFER (1 << 20) // room for a burst while the thread is descheduled
+
+// --- OSC decoding ---
+
+typedef struct {
+    const unsigned char *p, *end;
+} OscReader;
+
+static int read_u32(OscReader *r, uint32_t *value) {
+    if (r->end - r->p < 4)
+        return -1;
+    *value = (uint32_t)r->p[0] << 24 | (uint32_t)r->p[1] << 16 | (uint32_t)r->p[2] << 8 | r->p[3];
+    r->p += 4;
+    return 0;
+}
+
+// OSC strings are NUL-terminated and padded to a multiple of four bytes.
+static int read_string(OscReader *r, const char **s) {
+    const unsigned char *nul = memchr(r->p, 0, r->end - r->p);
+    if (!nul)
+        return -1;
+    size_t padded = ((size_t)(nul - r->p) + 4) & ~(size_t)3;
+    if ((size_t)(r->end - r->p) < padded)
+        return -1;
+    *s = (const char *)r->p;
+    r->p += padded;
+    return 0;
+}
+
+static int read_arg(OscReader *r, char tag, double *value) {
+    uint32_t hi, lo;
+    switch (tag) {
+    case 'i':
+        if (read_u32(r, &hi) != 0)
+            return -1;
+        *value = (int32_t)hi;
+        return 0;
+    case 'f': {
+        if (read_u32(r, &hi) != 0)
+            return -1;
+        float f;
+        memcpy(&f, &hi, sizeof(f));
+        *value = f;
+        return 0;
+    }
+    case 'd': {
+        if (read_u32(r, &hi) != 0 || read_u32(r, &lo) != 0)
+            return -1;
+        uint64_t bits = (uint64_t)hi << 32 | lo;
+        memcpy(value, &bits, sizeof(*value));
+        return 0;
+    }
+    default:
+        return -1;
+    }
+}
+
+static int add(CommandBatch *batch, CommandType type, int target, const double *args, int nargs) {
+    if (batch->count >= COMMAND_BATCH_MAX)
+        return -1;
+    Command *command = &batch->commands[batch->count++];
+    command->type = type;
+    command->target = target;
+    for (int i = 0; i < nargs; i++)
+        command->args[i] = (float)args[i];
+    return 0;
+}
+
+// Whether value names one of count things; checked before any cast, since converting a double
+// outside int's range is undefined.
+static int is_index(double value, int count) {
+    return value >= 0.0 && value < count;
+}
+
+static int decode_message(OscReader *r, CommandBatch *batch, int *query) {
+    const char *address, *tags;
+    if (read_string(r, &address) != 0)
+        return -1;
+    // A message without a type tag string has no arguments.
+    tags = ",";
+    if (r->p < r->end && read_string(r, &tags) != 0)
+        return -1;
+    if (tags[0] != ',')
+        return -1;
+    double args[MIXER_MAX_DIMS];
+    int nargs = 0;
+    for (const char *t = tags + 1; *t; t++) {
+        if (nargs == MIXER_MAX_DIMS || read_arg(r, *t, &args[nargs]) != 0)
+            return -1;
+        // Arguments end up as floats (and targets as ints), so reject what cannot convert.
+        if (!isfinite(args[nargs]) || fabs(args[nargs]) > FLT_MAX)
+            return -1;
+        nargs++;
+    }
+
+    if (strcmp(address, "/wave/note_on") == 0 && nargs == 2 && is_index(args[0], NUM_VOICES) &&
+        args[1] > 0.0)
+        return add(batch, COMMAND_NOTE_ON, (int)args[0], args + 1, 1);
+    if (strcmp(address, "/wave/note_off") == 0 && nargs == 1 && is_index(args[0], NUM_VOICES))
+        return add(batch, COMMAND_NOTE_OFF, (int)args[0], NULL, 0);
+    if (strcmp(address, "/wave/level") == 0 && nargs == 2 && is_index(args[0], NUM_WAVETABLES))
+        return add(batch, COMMAND_LEVEL, (int)args[0], args + 1, 1);
+    if (strcmp(address, "/wave/cutoff") == 0 && nargs == 1)
+        return add(batch, COMMAND_CUTOFF, 0, args, 1);
+    if (strcmp(address, "/wave/q") == 0 && nargs == 1)
+        return add(batch, COMMAND_Q, 0, args, 1);
+    if (strcmp(address, "/wave/cursor") == 0 && nargs >= 1)
+        return add(batch, COMMAND_CURSOR, nargs, args, nargs);
+    if (strcmp(address, "/wave/delay") == 0 && nargs >= 1 && nargs <= 3)
+        return add(batch, COMMAND_DELAY, nargs, args, nargs);
+    if (strcmp(address, "/wave/reverb") == 0 && nargs >= 1 && nargs <= 3)
+        return add(batch, COMMAND_REVERB, nargs, args, nargs);
+    if (strcmp(address, "/wave/interp") == 0 && nargs == 1 && is_index(args[0], DSP_INTERP_COUNT))
+        return add(batch, COMMAND_INTERP, (int)args[0], NULL, 0);
+    if (strcmp(address, "/wave/latency") == 0 && nargs == 0) {
+        *query = 1;
+        return 0;
+    }
+    return -1;
+}
+
+static int decode(const unsigned char *packet, size_t size, CommandBatch *batch, int *query,
+                  int depth) {
+    OscReader r = {packet, packet + size};
+    if (size < 8 || memcmp(packet, "#bundle", 8) != 0)
+        return decode_message(&r, batch, query);
+    if (depth >= CONTROL_MAX_DEPTH || size < 16)
+        return -1;
+    r.p += 16; // "#bundle\0" and the time tag
+    while (r.p < r.end) {
+        uint32_t element;
+        if (read_u32(&r, &element) != 0 || element > (size_t)(r.end - r.p) || element % 4)
+            return -1;
+        if (decode(r.p, element, batch, query, depth + 1) != 0)
+            return -1;
+        r.p += element;
+    }
+    return 0;
+}
+
+int Control_decode(const unsigned char *packet, size_t size, CommandBatch *batch, int *query) {
+    int before = batch->count;
+    *query = 0;
+    if (size % 4 || decode(packet, size, batch, query, 0) != 0) {
+        batch->count = before; // all of a packet or none of it
+        return -1;
+    }
+    return batch->count - before;
+}
+
+// --- Server ---
+
+static size_t put_u32(unsigned char *p, uint32_t value) {
+    p[0] = (unsigned char)(value >> 24);
+    p[1] = (unsigned char)(value >> 16);
+    p[2] = (unsigned char)(value >> 8);
+    p[3] = (unsigned char)value;
+    return 4;
+}
+
+static size_t put_float(unsigned char *p, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return put_u32(p, bits);
+}
+
+static void reply_latency(ControlServer *server, const struct sockaddr_in *to) {
+    CommandQueue *queue = server->queue;
+    unsigned char reply[64];
+    size_t n = 0;
+    memcpy(reply, "/wave/latency\0\0\0,ffii\0\0\0", 24);
+    n += 24;
+    n += put_float(reply + n, atomic_load(&queue->last_latency_ms));
+    n += put_float(reply + n, atomic_load(&queue->max_latency_ms));
+    n += put_u32(reply + n, (uint32_t)atomic_load(&queue->applied));
+    n += put_u32(reply + n, (uint32_t)atomic_load(&queue->dropped));
+    sendto(server->fd, reply, n, 0, (const struct sockaddr *)to, sizeof(*to));
+}
+
+static void *receiver(void *arg) {
+    ControlServer *server = arg;
+    unsigned char *packet = malloc(CONTROL_MAX_PACKET);
+    CommandBatch *scratch = malloc(sizeof(CommandBatch));
+    assert(packet && scratch);
+    struct pollfd fds[2] = {{server->fd, POLLIN, 0}, {server->wake[0], POLLIN, 0}};
+    for (;;) {
+        if (poll(fds, 2, -1) < 0 && errno != EINTR)
+            break;
+        if (fds[1].revents)
+            break;
+        if (!(fds[0].revents & POLLIN))
+            continue;
+        // Drain everything that has arrived before sleeping again.
+        for (;;) {
+            struct sockaddr_in from;
+            socklen_t from_len = sizeof(from);
+            ssize_t size = recvfrom(server->fd, packet, CONTROL_MAX_PACKET, MSG_DONTWAIT,
+                                    (struct sockaddr *)&from, &from_len);
+            if (size < 0)
+                break;
+            atomic_fetch_add(&server->packets, 1);
+            int query;
+            scratch->count = 0;
+            if (Control_decode(packet, (size_t)size, scratch, &query) < 0) {
+                atomic_fetch_add(&server->malformed, 1);
+                continue;
+            }
+            if (scratch->count > 0) {
+                CommandBatch *batch = CommandQueue_begin(server->queue);
+                if (batch) {
+                    memcpy(batch->commands, scratch->commands, scratch->count * sizeof(Command));
+                    batch->count = scratch->count;
+                    CommandQueue_push(server->queue);
+                }
+            }
+            if (query)
+                reply_latency(server, &from);
+        }
+    }
+    free(scratch);
+    free(packet);
+    return NULL;
+}
+
+ControlServer *ControlServer_start(CommandQueue *queue, int port) {
+    ControlServer *server = calloc(1, sizeof(ControlServer));
+    assert(server);
+    server->queue = queue;
+    server->wake[0] = server->wake[1] = -1;
+    atomic_init(&server->packets, 0);
+    atomic_init(&server->malformed, 0);
+    server->fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (server->fd < 0) {
+        free(server);
+        return NULL;
+    }
+    int buffer = CONTROL_RECV_BUFFER;
+    setsockopt(server->fd, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(server->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || pipe(server->wake) != 0 ||
+        pthread_create(&server->thread, NULL, receiver, server) != 0) {
+        fprintf(stderr, "Control: cannot listen on port %d: %s\n", port, strerror(errno));
+        ControlServer_stop(server);
+        return NULL;
+    }
+    server->running = 1;
+    return server;
+}
+
+void ControlServer_stop(ControlServer *server) {
+    if (!server)
+        return;
+    if (server->running) {
+        char byte = 0;
+        if (write(server->wake[1], &byte, 1) != 1)
+            fprintf(stderr, "Control: cannot wake thread: %s\n", strerror(errno));
+        pthread_join(server->thread, NULL);
+    }
+    for (int i = 0; i < 2; i++) {
+        if (server->wake[i] >= 0)
+            close(server->wake[i]);
+    }
+    close(server->fd);
+    free(server);
+}
+
+int ControlServer_port(const ControlServer *server) {
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    if (getsockname(server->fd, (struct sockaddr *)&addr, &len) != 0)
+        return -1;
+    return ntohs(addr.sin_port);
+}
@@ -0,0 +1,238 @@
+#include "dsp.h"
+#include <math.h>
+
+// NEON kernels for the Pi. AArch64 always has NEON; 32-bit ARM builds this file with
+// -mfpu=neon (see CMakeLists.txt) and Dsp_init checks HWCAP_NEON before selecting it.
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+
+static void osc_interp_neon(const float *table, size_t length, double *phase, double phase_inc,
+                            float gain, float *out, int n) {
+    const double len = (double)length;
+    const float32x4_t vgain = vdupq_n_f32(gain);
+    double pos = *phase;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        // Positions stay in double (32-bit ARM has no double lanes); the lerp is vectorised.
+        float a[4], b[4], frac[4];
+        double p = pos;
+        for (int k = 0; k < 4; k++) {
+            int index0 = (int)p;
+            int index1 = index0 + 1 == (int)length ? 0 : index0 + 1;
+            a[k] = table[index0];
+            b[k] = table[index1];
+            frac[k] = (float)(p - index0);
+            p += phase_inc;
+            if (p >= len)
+                p = fmod(p, len);
+        }
+        float32x4_t va = vld1q_f32(a);
+        float32x4_t s = vmlaq_f32(va, vld1q_f32(frac), vsubq_f32(vld1q_f32(b), va));
+        vst1q_f32(out + i, vmlaq_f32(vld1q_f32(out + i), vgain, s));
+        pos = p;
+    }
+    for (; i < n; i++) {
+        int index0 = (int)pos;
+        int index1 = (index0 + 1) % length;
+        double frac = pos - index0;
+        out[i] += gain * (float)((1.0 - frac) * table[index0] + frac * table[index1]);
+        pos += phase_inc;
+        if (pos >= len)
+            pos -= len;
+    }
+    *phase = pos;
+}
+
+static float32x4_t hermite_neon(float32x4_t xm1, float32x4_t x0, float32x4_t x1, float32x4_t x2,
+                                 float32x4_t t) {
+    float32x4_t c1 = vmulq_n_f32(vsubq_f32(x1, xm1), 0.5f);
+    float32x4_t c2 = vmlsq_n_f32(vaddq_f32(xm1, vaddq_f32(x1, x1)), x0, 2.5f);
+    c2 = vmlsq_n_f32(c2, x2, 0.5f);
+    float32x4_t c3 = vmulq_n_f32(vsubq_f32(x0, x1), 1.5f);
+    c3 = vmlaq_n_f32(c3, vsubq_f32(x2, xm1), 0.5f);
+    float32x4_t y = vmlaq_f32(c2, c3, t);
+    y = vmlaq_f32(c1, y, t);
+    return vmlaq_f32(x0, y, t);
+}
+
+static void osc_hermite_neon(const float *table, size_t length, double *phase, double phase_inc,
+                             float gain, float *out, int n) {
+    const int last = (int)length - 1;
+    const float32x4_t vgain = vdupq_n_f32(gain);
+    double pos = *phase;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        // Stepped exactly like the scalar kernel; only the polynomial is vectorised.
+        float xm1[4], x0[4], x1[4], x2[4], frac[4];
+        for (int k = 0; k < 4; k++) {
+            int index0 = (int)pos;
+            int i1 = index0 == last ? 0 : index0 + 1;
+            xm1[k] = table[index0 == 0 ? last : index0 - 1];
+            x0[k] = table[index0];
+            x1[k] = table[i1];
+            x2[k] = table[i1 == last ? 0 : i1 + 1];
+            frac[k] = (float)(pos - index0);
+            pos += phase_inc;
+            if (pos >= length)
+                pos -= length;
+        }
+        float32x4_t s = hermite_neon(vld1q_f32(xm1), vld1q_f32(x0), vld1q_f32(x1), vld1q_f32(x2),
+                                     vld1q_f32(frac));
+        vst1q_f32(out + i, vmlaq_f32(vld1q_f32(out + i), vgain, s));
+    }
+    *phase = pos;
+    Dsp_kernels_scalar()->osc_hermite(table, length, phase, phase_inc, gain, out + i, n - i);
+}
+
+static void osc_sinc_neon(const float *table, size_t length, double *phase, double phase_inc,
+                          float gain, float *out, int n) {
+    const float *rows = Dsp_sinc_table();
+    double pos = *phase;
+    for (int i = 0; i < n; i++) {
+        int index0 = (int)pos;
+        double p = (pos - index0) * DSP_SINC_PHASES;
+        int row = (int)p;
+        float t = (float)(p - row);
+        const float *c = rows + row * DSP_SINC_TAPS;
+        float scratch[DSP_SINC_TAPS];
+        const float *x = Dsp_sinc_taps(table, length, index0, scratch);
+        float32x4_t lo = vld1q_f32(c), hi = vld1q_f32(c + 4);
+        lo = vmlaq_n_f32(lo, vsubq_f32(vld1q_f32(c + DSP_SINC_TAPS), lo), t);
+        hi = vmlaq_n_f32(hi, vsubq_f32(vld1q_f32(c + DSP_SINC_TAPS + 4), hi), t);
+        float32x4_t acc = vmlaq_f32(vmulq_f32(lo, vld1q_f32(x)), hi, vld1q_f32(x + 4));
+        // Pairwise adds rather than vaddvq_f32, which AArch64 has and 32-bit ARM lacks.
+        float32x2_t sum = vpadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+        out[i] += gain * vget_lane_f32(vpadd_f32(sum, sum), 0);
+        pos += phase_inc;
+        if (pos >= length)
+            pos -= length;
+    }
+    *phase = pos;
+}
+
+static void fir_neon(const float *x, float *w, int n, float b0, float b1, float b2) {
+    int k = 0;
+    for (; k + 4 <= n; k += 4) {
+        float32x4_t acc = vmulq_n_f32(vld1q_f32(x + k), b2);
+        acc = vmlaq_n_f32(acc, vld1q_f32(x + k + 1), b1);
+        acc = vmlaq_n_f32(acc, vld1q_f32(x + k + 2), b0);
+        vst1q_f32(w + k, acc);
+    }
+    for (; k < n; k++)
+        w[k] = b0 * x[k + 2] + b1 * x[k + 1] + b2 * x[k];
+}
+
+static void biquad_block_neon(BiquadFilter *filter, float *buf, int n) {
+    Dsp_biquad_block_split(filter, buf, n, fir_neon);
+}
+
+// Butterflies within four lanes: (0,1)(2,3), then (0,2)(1,3).
+static float32x4_t hadamard4_neon(float32x4_t x) {
+    static const float alt[4] = {1.0f, -1.0f, 1.0f, -1.0f};
+    static const float pairs[4] = {1.0f, 1.0f, -1.0f, -1.0f};
+    x = vmlaq_f32(vrev64q_f32(x), x, vld1q_f32(alt));
+    float32x4_t swapped = vcombine_f32(vget_high_f32(x), vget_low_f32(x));
+    return vmlaq_f32(swapped, x, vld1q_f32(pairs));
+}
+
+static void hadamard8_neon(float *frames, int n) {
+    for (int f = 0; f < n; f++) {
+        float *x = frames + 8 * f;
+        float32x4_t lo = hadamard4_neon(vld1q_f32(x));
+        float32x4_t hi = hadamard4_neon(vld1q_f32(x + 4));
+        vst1q_f32(x, vaddq_f32(lo, hi));
+        vst1q_f32(x + 4, vsubq_f32(lo, hi));
+    }
+}
+
+static void mix_add_neon(float *dst, const float *src, float gain, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(dst + i, vmlaq_n_f32(vld1q_f32(dst + i), vld1q_f32(src + i), gain));
+    }
+    for (; i < n; i++)
+        dst[i] += gain * src[i];
+}
+
+static inline int32x4_t round_s32(float32x4_t a) {
+#if defined(__aarch64__)
+    return vcvtnq_s32_f32(a);
+#else
+    // ARMv7 conversion truncates; bias away from zero to round to nearest.
+    const uint32x4_t sign = vdupq_n_u32(0x80000000u);
+    const uint32x4_t half_bits = vreinterpretq_u32_f32(vdupq_n_f32(0.5f));
+    float32x4_t half =
+        vreinterpretq_f32_u32(vorrq_u32(vandq_u32(vreinterpretq_u32_f32(a), sign), half_bits));
+    return vcvtq_s32_f32(vaddq_f32(a, half));
+#endif
+}
+
+static void convert_s16_neon(const float *src, int16_t *dst, int n) {
+    const float32x4_t lo = vdupq_n_f32(-1.0f), hi = vdupq_n_f32(1.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t a = vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(src + i), lo), hi), 32767.0f);
+        float32x4_t b =
+            vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(src + i + 4), lo), hi), 32767.0f);
+        int32x4_t ia = round_s32(a), ib = round_s32(b);
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(ia), vqmovn_s32(ib)));
+    }
+    for (; i < n; i++) {
+        float s = src[i] > 1.0f ? 1.0f : (src[i] < -1.0f ? -1.0f : src[i]);
+        dst[i] = (int16_t)lrintf(s * 32767.0f);
+    }
+}
+
+static void convert_s32_neon(const float *src, int32_t *dst, float scale, int n) {
+    const float32x4_t lo = vdupq_n_f32(-1.0f), hi = vdupq_n_f32(1.0f);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t a = vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(src + i), lo), hi), scale);
+        vst1q_s32(dst + i, round_s32(a));
+    }
+    for (; i < n; i++) {
+        float s = src[i] > 1.0f ? 1.0f : (src[i] < -1.0f ? -1.0f : src[i]);
+        dst[i] = (int32_t)lrintf(s * scale);
+    }
+}
+
+static void convert_f64_neon(const float *src, double *dst, int n) {
+    int i = 0;
+#if defined(__aarch64__)
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t s = vld1q_f32(src + i);
+        vst1q_f64(dst + i, vcvt_f64_f32(vget_low_f32(s)));
+        vst1q_f64(dst + i + 2, vcvt_high_f64_f32(s));
+    }
+#endif
+    // ARMv7 NEON has no double lanes; VFP converts one at a time.
+    for (; i < n; i++)
+        dst[i] = src[i];
+}
+
+static const DspKernels kernels_neon = {
+    .isa = DSP_ISA_NEON,
+    .name = "neon",
+    .osc_interp = osc_interp_neon,
+    .osc_hermite = osc_hermite_neon,
+    .osc_sinc = osc_sinc_neon,
+    .biquad_block = biquad_block_neon,
+    .hadamard8 = hadamard8_neon,
+    .mix_add = mix_add_neon,
+    .convert_s16 = convert_s16_neon,
+    .convert_s32 = convert_s32_neon,
+    .convert_f64 = convert_f64_neon,
+};
+
+const DspKernels *Dsp_kernels_neon(void) {
+    return &kernels_neon;
+}
+
+#else
+
+const DspKernels *Dsp_kernels_neon(void) {
+    return NULL;
+}
+
+#endif
@@ -0,0 +1,733 @@
+#include "dsp.h"
+#include <math.h>
+
+// SSE2, AVX2 and AVX-512 kernels. Each function carries its own target attribute so the rest
+// of the binary stays baseline x86 and Dsp_init only calls what cpuid reports.
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+
+// Advance the block-start phase and wrap it the same way the scalar path does.
+static double advance_phase(double pos, double phase_inc, int steps, double len) {
+    pos += phase_inc * steps;
+    if (pos >= len)
+        pos = fmod(pos, len);
+    return pos;
+}
+
+// Scalar tail shared by all widths.
+static double osc_interp_tail(const float *table, size_t length, double pos, double phase_inc,
+                              float gain, float *out, int n) {
+    for (int i = 0; i < n; i++) {
+        int index0 = (int)pos;
+        int index1 = (index0 + 1) % length;
+        double frac = pos - index0;
+        out[i] += gain * (float)((1.0 - frac) * table[index0] + frac * table[index1]);
+        pos += phase_inc;
+        if (pos >= length)
+            pos -= length;
+    }
+    return pos;
+}
+
+// --- SSE2 ---
+
+// Wrap lane positions into [0, len). Lanes may be several table lengths ahead at high pitch.
+TARGET_SSE2 static __m128d wrap_pd_sse2(__m128d p, __m128d len, __m128d inv_len) {
+    __m128d k = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_mul_pd(p, inv_len)));
+    p = _mm_sub_pd(p, _mm_mul_pd(k, len));
+    p = _mm_add_pd(p, _mm_and_pd(_mm_cmplt_pd(p, _mm_setzero_pd()), len));
+    p = _mm_sub_pd(p, _mm_and_pd(_mm_cmpge_pd(p, len), len));
+    return p;
+}
+
+// Table index and fraction of the four lanes starting at pos.
+TARGET_SSE2 static __m128i lanes_sse2(double pos, __m128d step01, __m128d step23, __m128d vlen,
+                                      __m128d vinv, __m128 *frac) {
+    __m128d base = _mm_set1_pd(pos);
+    __m128d p01 = wrap_pd_sse2(_mm_add_pd(base, step01), vlen, vinv);
+    __m128d p23 = wrap_pd_sse2(_mm_add_pd(base, step23), vlen, vinv);
+    __m128i i01 = _mm_cvttpd_epi32(p01);
+    __m128i i23 = _mm_cvttpd_epi32(p23);
+    __m128 f01 = _mm_cvtpd_ps(_mm_sub_pd(p01, _mm_cvtepi32_pd(i01)));
+    __m128 f23 = _mm_cvtpd_ps(_mm_sub_pd(p23, _mm_cvtepi32_pd(i23)));
+    *frac = _mm_movelh_ps(f01, f23);
+    return _mm_unpacklo_epi64(i01, i23);
+}
+
+TARGET_SSE2 static void osc_interp_sse2(const float *table, size_t length, double *phase,
+                                        double phase_inc, float gain, float *out, int n) {
+    const double len = (double)length;
+    const __m128d vlen = _mm_set1_pd(len);
+    const __m128d vinv = _mm_set1_pd(1.0 / len);
+    const __m128d step01 = _mm_set_pd(phase_inc, 0.0);
+    const __m128d step23 = _mm_set_pd(3.0 * phase_inc, 2.0 * phase_inc);
+    const __m128 vgain = _mm_set1_ps(gain);
+    double pos = *phase;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 frac;
+        int idx[4];
+        _mm_storeu_si128((__m128i *)idx, lanes_sse2(pos, step01, step23, vlen, vinv, &frac));
+        float a[4], b[4];
+        for (int k = 0; k < 4; k++) {
+            int next = idx[k] + 1;
+            a[k] = table[idx[k]];
+            b[k] = table[next == (int)length ? 0 : next];
+        }
+        __m128 va = _mm_loadu_ps(a);
+        __m128 s = _mm_add_ps(va, _mm_mul_ps(frac, _mm_sub_ps(_mm_loadu_ps(b), va)));
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(vgain, s)));
+        pos = advance_phase(pos, phase_inc, 4, len);
+    }
+    *phase = osc_interp_tail(table, length, pos, phase_inc, gain, out + i, n - i);
+}
+
+TARGET_SSE2 static __m128 hermite_sse2(__m128 xm1, __m128 x0, __m128 x1, __m128 x2, __m128 t) {
+    const __m128 half = _mm_set1_ps(0.5f);
+    __m128 c1 = _mm_mul_ps(half, _mm_sub_ps(x1, xm1));
+    __m128 c2 = _mm_sub_ps(_mm_add_ps(xm1, _mm_add_ps(x1, x1)),
+                           _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.5f), x0), _mm_mul_ps(half, x2)));
+    __m128 c3 = _mm_add_ps(_mm_mul_ps(half, _mm_sub_ps(x2, xm1)),
+                           _mm_mul_ps(_mm_set1_ps(1.5f), _mm_sub_ps(x0, x1)));
+    __m128 y = _mm_add_ps(_mm_mul_ps(c3, t), c2);
+    y = _mm_add_ps(_mm_mul_ps(y, t), c1);
+    return _mm_add_ps(_mm_mul_ps(y, t), x0);
+}
+
+TARGET_SSE2 static void osc_hermite_sse2(const float *table, size_t length, double *phase,
+                                         double phase_inc, float gain, float *out, int n) {
+    const double len = (double)length;
+    const __m128d vlen = _mm_set1_pd(len);
+    const __m128d vinv = _mm_set1_pd(1.0 / len);
+    const __m128d step01 = _mm_set_pd(phase_inc, 0.0);
+    const __m128d step23 = _mm_set_pd(3.0 * phase_inc, 2.0 * phase_inc);
+    const __m128 vgain = _mm_set1_ps(gain);
+    const int last = (int)length - 1;
+    double pos = *phase;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 frac;
+        int idx[4];
+        _mm_storeu_si128((__m128i *)idx, lanes_sse2(pos, step01, step23, vlen, vinv, &frac));
+        float xm1[4], x0[4], x1[4], x2[4];
+        for (int k = 0; k < 4; k++) {
+            int i1 = idx[k] == last ? 0 : idx[k] + 1;
+            xm1[k] = table[idx[k] == 0 ? last : idx[k] - 1];
+            x0[k] = table[idx[k]];
+            x1[k] = table[i1];
+            x2[k] = table[i1 == last ? 0 : i1 + 1];
+        }
+        __m128 s = hermite_sse2(_mm_loadu_ps(xm1), _mm_loadu_ps(x0), _mm_loadu_ps(x1),
+                                _mm_loadu_ps(x2), frac);
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(vgain, s)));
+        pos = advance_phase(pos, phase_inc, 4, len);
+    }
+    *phase = pos;
+    Dsp_kernels_scalar()->osc_hermite(table, length, phase, phase_inc, gain, out + i, n - i);
+}
+
+// Tap products of one sinc output, folded to four lanes.
+TARGET_SSE2 static __m128 sinc_products_sse2(const float *rows, const float *table, size_t length,
+                                             double pos) {
+    int index0 = (int)pos;
+    double p = (pos - index0) * DSP_SINC_PHASES;
+    int row = (int)p;
+    __m128 t = _mm_set1_ps((float)(p - row));
+    const float *c = rows + row * DSP_SINC_TAPS;
+    float scratch[DSP_SINC_TAPS];
+    const float *x = Dsp_sinc_taps(table, length, index0, scratch);
+    __m128 lo = _mm_loadu_ps(c), hi = _mm_loadu_ps(c + 4);
+    lo = _mm_add_ps(lo, _mm_mul_ps(t, _mm_sub_ps(_mm_loadu_ps(c + DSP_SINC_TAPS), lo)));
+    hi = _mm_add_ps(hi, _mm_mul_ps(t, _mm_sub_ps(_mm_loadu_ps(c + DSP_SINC_TAPS + 4), hi)));
+    return _mm_add_ps(_mm_mul_ps(lo, _mm_loadu_ps(x)), _mm_mul_ps(hi, _mm_loadu_ps(x + 4)));
+}
+
+// The taps are vectorised per output; four outputs are then summed with one transpose instead
+// of four horizontal adds. The phase steps exactly as in the scalar kernel.
+TARGET_SSE2 static void osc_sinc_sse2(const float *table, size_t length, double *phase,
+                                      double phase_inc, float gain, float *out, int n) {
+    const float *rows = Dsp_sinc_table();
+    const __m128 vgain = _mm_set1_ps(gain);
+    double pos = *phase;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 d[4];
+        for (int k = 0; k < 4; k++) {
+            d[k] = sinc_products_sse2(rows, table, length, pos);
+            pos += phase_inc;
+            if (pos >= length)
+                pos -= length;
+        }
+        _MM_TRANSPOSE4_PS(d[0], d[1], d[2], d[3]);
+        __m128 s = _mm_add_ps(_mm_add_ps(d[0], d[1]), _mm_add_ps(d[2], d[3]));
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(vgain, s)));
+    }
+    *phase = pos;
+    Dsp_kernels_scalar()->osc_sinc(table, length, phase, phase_inc, gain, out + i, n - i);
+}
+
+TARGET_SSE2 static void fir_sse2(const float *x, float *w, int n, float b0, float b1, float b2) {
+    const __m128 vb0 = _mm_set1_ps(b0), vb1 = _mm_set1_ps(b1), vb2 = _mm_set1_ps(b2);
+    int k = 0;
+    for (; k + 4 <= n; k += 4) {
+        __m128 acc = _mm_mul_ps(vb0, _mm_loadu_ps(x + k + 2));
+        acc = _mm_add_ps(acc, _mm_mul_ps(vb1, _mm_loadu_ps(x + k + 1)));
+        acc = _mm_add_ps(acc, _mm_mul_ps(vb2, _mm_loadu_ps(x + k)));
+        _mm_storeu_ps(w + k, acc);
+    }
+    for (; k < n; k++)
+        w[k] = b0 * x[k + 2] + b1 * x[k + 1] + b2 * x[k];
+}
+
+TARGET_SSE2 static void biquad_block_sse2(BiquadFilter *filter, float *buf, int n) {
+    Dsp_biquad_block_split(filter, buf, n, fir_sse2);
+}
+
+// Butterflies within four lanes: (0,1)(2,3), then (0,2)(1,3).
+TARGET_SSE2 static __m128 hadamard4_sse2(__m128 x) {
+    const __m128 alt = _mm_set_ps(-1.0f, 1.0f, -1.0f, 1.0f);
+    const __m128 pairs = _mm_set_ps(-1.0f, -1.0f, 1.0f, 1.0f);
+    x = _mm_add_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1)), _mm_mul_ps(x, alt));
+    return _mm_add_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 0, 3, 2)), _mm_mul_ps(x, pairs));
+}
+
+TARGET_SSE2 static void hadamard8_sse2(float *frames, int n) {
+    for (int f = 0; f < n; f++) {
+        float *x = frames + 8 * f;
+        __m128 lo = hadamard4_sse2(_mm_loadu_ps(x));
+        __m128 hi = hadamard4_sse2(_mm_loadu_ps(x + 4));
+        _mm_storeu_ps(x, _mm_add_ps(lo, hi));
+        _mm_storeu_ps(x + 4, _mm_sub_ps(lo, hi));
+    }
+}
+
+TARGET_SSE2 static void mix_add_sse2(float *dst, const float *src, float gain, int n) {
+    const __m128 vgain = _mm_set1_ps(gain);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 d = _mm_loadu_ps(dst + i);
+        _mm_storeu_ps(dst + i, _mm_add_ps(d, _mm_mul_ps(vgain, _mm_loadu_ps(src + i))));
+    }
+    for (; i < n; i++)
+        dst[i] += gain * src[i];
+}
+
+TARGET_SSE2 static void convert_s16_sse2(const float *src, int16_t *dst, int n) {
+    const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f), scale = _mm_set1_ps(32767.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128 a = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), lo), hi), scale);
+        __m128 b = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), lo), hi), scale);
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128((__m128i *)(dst + i), packed);
+    }
+    for (; i < n; i++) {
+        float s = src[i] > 1.0f ? 1.0f : (src[i] < -1.0f ? -1.0f : src[i]);
+        dst[i] = (int16_t)lrintf(s * 32767.0f);
+    }
+}
+
+TARGET_SSE2 static void convert_s32_sse2(const float *src, int32_t *dst, float scale, int n) {
+    const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f), vscale = _mm_set1_ps(scale);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 a = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), lo), hi), vscale);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_cvtps_epi32(a));
+    }
+    for (; i < n; i++) {
+        float s = src[i] > 1.0f ? 1.0f : (src[i] < -1.0f ? -1.0f : src[i]);
+        dst[i] = (int32_t)lrintf(s * scale);
+    }
+}
+
+TARGET_SSE2 static void convert_f64_sse2(const float *src, double *dst, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 s = _mm_loadu_ps(src + i);
+        _mm_storeu_pd(dst + i, _mm_cvtps_pd(s));
+        _mm_storeu_pd(dst + i + 2, _mm_cvtps_pd(_mm_movehl_ps(s, s)));
+    }
+    for (; i < n; i++)
+        dst[i] = src[i];
+}
+
+static const DspKernels kernels_sse2 = {
+    .isa = DSP_ISA_SSE2,
+    .name = "sse2",
+    .osc_interp = osc_interp_sse2,
+    .osc_hermite = osc_hermite_sse2,
+    .osc_sinc = osc_sinc_sse2,
+    .biquad_block = biquad_block_sse2,
+    .hadamard8 = hadamard8_sse2,
+    .mix_add = mix_add_sse2,
+    .convert_s16 = convert_s16_sse2,
+    .convert_s32 = convert_s32_sse2,
+    .convert_f64 = convert_f64_sse2,
+};
+
+// --- AVX2 ---
+
+TARGET_AVX2 static __m256d wrap_pd_avx2(__m256d p, __m256d len, __m256d inv_len) {
+    __m256d k = _mm256_cvtepi32_pd(_mm256_cvttpd_epi32(_mm256_mul_pd(p, inv_len)));
+    p = _mm256_fnmadd_pd(k, len, p);
+    p = _mm256_add_pd(p, _mm256_and_pd(_mm256_cmp_pd(p, _mm256_setzero_pd(), _CMP_LT_OQ), len));
+    p = _mm256_sub_pd(p, _mm256_and_pd(_mm256_cmp_pd(p, len, _CMP_GE_OQ), len));
+    return p;
+}
+
+TARGET_AVX2 static __m256i lanes_avx2(double pos, __m256d step_lo, __m256d step_hi, __m256d vlen,
+                                      __m256d vinv, __m256 *frac) {
+    __m256d base = _mm256_set1_pd(pos);
+    __m256d p_lo = wrap_pd_avx2(_mm256_add_pd(base, step_lo), vlen, vinv);
+    __m256d p_hi = wrap_pd_avx2(_mm256_add_pd(base, step_hi), vlen, vinv);
+    __m128i i_lo = _mm256_cvttpd_epi32(p_lo);
+    __m128i i_hi = _mm256_cvttpd_epi32(p_hi);
+    __m128 f_lo = _mm256_cvtpd_ps(_mm256_sub_pd(p_lo, _mm256_cvtepi32_pd(i_lo)));
+    __m128 f_hi = _mm256_cvtpd_ps(_mm256_sub_pd(p_hi, _mm256_cvtepi32_pd(i_hi)));
+    *frac = _mm256_set_m128(f_hi, f_lo);
+    return _mm256_set_m128i(i_hi, i_lo);
+}
+
+TARGET_AVX2 static void osc_interp_avx2(const float *table, size_t length, double *phase,
+                                        double phase_inc, float gain, float *out, int n) {
+    const double len = (double)length;
+    const __m256d vlen = _mm256_set1_pd(len);
+    const __m256d vinv = _mm256_set1_pd(1.0 / len);
+    const __m256d vinc = _mm256_set1_pd(phase_inc);
+    const __m256d step_lo = _mm256_mul_pd(_mm256_set_pd(3.0, 2.0, 1.0, 0.0), vinc);
+    const __m256d step_hi = _mm256_mul_pd(_mm256_set_pd(7.0, 6.0, 5.0, 4.0), vinc);
+    const __m256i vlength = _mm256_set1_epi32((int)length);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256 vgain = _mm256_set1_ps(gain);
+    double pos = *phase;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 frac;
+        __m256i idx0 = lanes_avx2(pos, step_lo, step_hi, vlen, vinv, &frac);
+        __m256i idx1 = _mm256_add_epi32(idx0, one);
+        idx1 = _mm256_andnot_si256(_mm256_cmpeq_epi32(idx1, vlength), idx1);
+        __m256 a = _mm256_i32gather_ps(table, idx0, 4);
+        __m256 b = _mm256_i32gather_ps(table, idx1, 4);
+        __m256 s = _mm256_fmadd_ps(frac, _mm256_sub_ps(b, a), a);
+        _mm256_storeu_ps(out + i, _mm256_fmadd_ps(vgain, s, _mm256_loadu_ps(out + i)));
+        pos = advance_phase(pos, phase_inc, 8, len);
+    }
+    *phase = osc_interp_tail(table, length, pos, phase_inc, gain, out + i, n - i);
+}
+
+TARGET_AVX2 static __m256 hermite_avx2(__m256 xm1, __m256 x0, __m256 x1, __m256 x2, __m256 t) {
+    const __m256 half = _mm256_set1_ps(0.5f);
+    __m256 c1 = _mm256_mul_ps(half, _mm256_sub_ps(x1, xm1));
+    __m256 c2 = _mm256_add_ps(xm1, _mm256_add_ps(x1, x1));
+    c2 = _mm256_fnmadd_ps(_mm256_set1_ps(2.5f), x0, c2);
+    c2 = _mm256_fnmadd_ps(half, x2, c2);
+    __m256 c3 = _mm256_mul_ps(_mm256_set1_ps(1.5f), _mm256_sub_ps(x0, x1));
+    c3 = _mm256_fmadd_ps(half, _mm256_sub_ps(x2, xm1), c3);
+    __m256 y = _mm256_fmadd_ps(c3, t, c2);
+    y = _mm256_fmadd_ps(y, t, c1);
+    return _mm256_fmadd_ps(y, t, x0);
+}
+
+TARGET_AVX2 static void osc_hermite_avx2(const float *table, size_t length, double *phase,
+                                         double phase_inc, float gain, float *out, int n) {
+    const double len = (double)length;
+    const __m256d vlen = _mm256_set1_pd(len);
+    const __m256d vinv = _mm256_set1_pd(1.0 / len);
+    const __m256d vinc = _mm256_set1_pd(phase_inc);
+    const __m256d step_lo = _mm256_mul_pd(_mm256_set_pd(3.0, 2.0, 1.0, 0.0), vinc);
+    const __m256d step_hi = _mm256_mul_pd(_mm256_set_pd(7.0, 6.0, 5.0, 4.0), vinc);
+    const __m256i vlength = _mm256_set1_epi32((int)length);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256 vgain = _mm256_set1_ps(gain);
+    double pos = *phase;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 frac;
+        __m256i idx0 = lanes_avx2(pos, step_lo, step_hi, vlen, vinv, &frac);
+        __m256i im1 = _mm256_sub_epi32(idx0, one);
+        im1 = _mm256_add_epi32(im1, _mm256_and_si256(_mm256_srai_epi32(im1, 31), vlength));
+        __m256i idx1 = _mm256_add_epi32(idx0, one);
+        idx1 = _mm256_andnot_si256(_mm256_cmpeq_epi32(idx1, vlength), idx1);
+        __m256i idx2 = _mm256_add_epi32(idx1, one);
+        idx2 = _mm256_andnot_si256(_mm256_cmpeq_epi32(idx2, vlength), idx2);
+        __m256 s = hermite_avx2(_mm256_i32gather_ps(table, im1, 4),
+                                _mm256_i32gather_ps(table, idx0, 4),
+                                _mm256_i32gather_ps(table, idx1, 4),
+                                _mm256_i32gather_ps(table, idx2, 4), frac);
+        _mm256_storeu_ps(out + i, _mm256_fmadd_ps(vgain, s, _mm256_loadu_ps(out + i)));
+        pos = advance_phase(pos, phase_inc, 8, len);
+    }
+    *phase = pos;
+    Dsp_kernels_scalar()->osc_hermite(table, length, phase, phase_inc, gain, out + i, n - i);
+}
+
+// All eight taps of one output in a single register, folded to four lanes.
+TARGET_AVX2 static __m128 sinc_products_avx2(const float *rows, const float *table, size_t length,
+                                             double pos) {
+    int index0 = (int)pos;
+    double p = (pos - index0) * DSP_SINC_PHASES;
+    int row = (int)p;
+    const float *c = rows + row * DSP_SINC_TAPS;
+    float scratch[DSP_SINC_TAPS];
+    const float *x = Dsp_sinc_taps(table, length, index0, scratch);
+    __m256 c0 = _mm256_loadu_ps(c);
+    __m256 coeffs = _mm256_fmadd_ps(_mm256_set1_ps((float)(p - row)),
+                                    _mm256_sub_ps(_mm256_loadu_ps(c + DSP_SINC_TAPS), c0), c0);
+    __m256 products = _mm256_mul_ps(coeffs, _mm256_loadu_ps(x));
+    return _mm_add_ps(_mm256_castps256_ps128(products), _mm256_extractf128_ps(products, 1));
+}
+
+TARGET_AVX2 static void osc_sinc_avx2(const float *table, size_t length, double *phase,
+                                      double phase_inc, float gain, float *out, int n) {
+    const float *rows = Dsp_sinc_table();
+    const __m128 vgain = _mm_set1_ps(gain);
+    double pos = *phase;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 d[4];
+        for (int k = 0; k < 4; k++) {
+            d[k] = sinc_products_avx2(rows, table, length, pos);
+            pos += phase_inc;
+            if (pos >= length)
+                pos -= length;
+        }
+        _MM_TRANSPOSE4_PS(d[0], d[1], d[2], d[3]);
+        __m128 s = _mm_add_ps(_mm_add_ps(d[0], d[1]), _mm_add_ps(d[2], d[3]));
+        _mm_storeu_ps(out + i, _mm_fmadd_ps(vgain, s, _mm_loadu_ps(out + i)));
+    }
+    *phase = pos;
+    Dsp_kernels_scalar()->osc_sinc(table, length, phase, phase_inc, gain, out + i, n - i);
+}
+
+TARGET_AVX2 static void fir_avx2(const float *x, float *w, int n, float b0, float b1, float b2) {
+    const __m256 vb0 = _mm256_set1_ps(b0), vb1 = _mm256_set1_ps(b1), vb2 = _mm256_set1_ps(b2);
+    int k = 0;
+    for (; k + 8 <= n; k += 8) {
+        __m256 acc = _mm256_mul_ps(vb2, _mm256_loadu_ps(x + k));
+        acc = _mm256_fmadd_ps(vb1, _mm256_loadu_ps(x + k + 1), acc);
+        acc = _mm256_fmadd_ps(vb0, _mm256_loadu_ps(x + k + 2), acc);
+        _mm256_storeu_ps(w + k, acc);
+    }
+    for (; k < n; k++)
+        w[k] = b0 * x[k + 2] + b1 * x[k + 1] + b2 * x[k];
+}
+
+TARGET_AVX2 static void biquad_block_avx2(BiquadFilter *filter, float *buf, int n) {
+    Dsp_biquad_block_split(filter, buf, n, fir_avx2);
+}
+
+// One frame per register: the two in-lane stages, then across the halves.
+TARGET_AVX2 static __m256 hadamard8_avx2_frame(__m256 x) {
+    const __m256 alt = _mm256_set_ps(-1, 1, -1, 1, -1, 1, -1, 1);
+    const __m256 pairs = _mm256_set_ps(-1, -1, 1, 1, -1, -1, 1, 1);
+    const __m256 halves = _mm256_set_ps(-1, -1, -1, -1, 1, 1, 1, 1);
+    x = _mm256_fmadd_ps(x, alt, _mm256_permute_ps(x, _MM_SHUFFLE(2, 3, 0, 1)));
+    x = _mm256_fmadd_ps(x, pairs, _mm256_permute_ps(x, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm256_fmadd_ps(x, halves, _mm256_permute2f128_ps(x, x, 1));
+}
+
+TARGET_AVX2 static void hadamard8_avx2(float *frames, int n) {
+    for (int f = 0; f < n; f++) {
+        float *x = frames + 8 * f;
+        _mm256_storeu_ps(x, hadamard8_avx2_frame(_mm256_loadu_ps(x)));
+    }
+}
+
+TARGET_AVX2 static void mix_add_avx2(float *dst, const float *src, float gain, int n) {
+    const __m256 vgain = _mm256_set1_ps(gain);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 d = _mm256_loadu_ps(dst + i);
+        _mm256_storeu_ps(dst + i, _mm256_fmadd_ps(vgain, _mm256_loadu_ps(src + i), d));
+    }
+    for (; i < n; i++)
+        dst[i] += gain * src[i];
+}
+
+TARGET_AVX2 static void convert_s16_avx2(const float *src, int16_t *dst, int n) {
+    const __m256 lo = _mm256_set1_ps(-1.0f), hi = _mm256_set1_ps(1.0f);
+    const __m256 scale = _mm256_set1_ps(32767.0f);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i), lo), hi);
+        __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i + 8), lo), hi);
+        __m256i ia = _mm256_cvtps_epi32(_mm256_mul_ps(a, scale));
+        __m256i ib = _mm256_cvtps_epi32(_mm256_mul_ps(b, scale));
+        // packs works per 128-bit lane; restore sample order afterwards.
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(ia, ib), 0xd8);
+        _mm256_storeu_si256((__m256i *)(dst + i), packed);
+    }
+    for (; i < n; i++) {
+        float s = src[i] > 1.0f ? 1.0f : (src[i] < -1.0f ? -1.0f : src[i]);
+        dst[i] = (int16_t)lrintf(s * 32767.0f);
+    }
+}
+
+TARGET_AVX2 static void convert_s32_avx2(const float *src, int32_t *dst, float scale, int n) {
+    const __m256 lo = _mm256_set1_ps(-1.0f), hi = _mm256_set1_ps(1.0f);
+    const __m256 vscale = _mm256_set1_ps(scale);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i), lo), hi);
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_cvtps_epi32(_mm256_mul_ps(a, vscale)));
+    }
+    for (; i < n; i++) {
+        float s = src[i] > 1.0f ? 1.0f : (src[i] < -1.0f ? -1.0f : src[i]);
+        dst[i] = (int32_t)lrintf(s * scale);
+    }
+}
+
+TARGET_AVX2 static void convert_f64_avx2(const float *src, double *dst, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(dst + i, _mm256_cvtps_pd(_mm_loadu_ps(src + i)));
+    for (; i < n; i++)
+        dst[i] = src[i];
+}
+
+static const DspKernels kernels_avx2 = {
+    .isa = DSP_ISA_AVX2,
+    .name = "avx2",
+    .osc_interp = osc_interp_avx2,
+    .osc_hermite = osc_hermite_avx2,
+    .osc_sinc = osc_sinc_avx2,
+    .biquad_block = biquad_block_avx2,
+    .hadamard8 = hadamard8_avx2,
+    .mix_add = mix_add_avx2,
+    .convert_s16 = convert_s16_avx2,
+    .convert_s32 = convert_s32_avx2,
+    .convert_f64 = convert_f64_avx2,
+};
+
+// --- AVX-512 ---
+
+TARGET_AVX512 static __m512d wrap_pd_avx512(__m512d p, __m512d len, __m512d inv_len) {
+    __m512d k = _mm512_cvtepi32_pd(_mm512_cvttpd_epi32(_mm512_mul_pd(p, inv_len)));
+    p = _mm512_fnmadd_pd(k, len, p);
+    p = _mm512_mask_add_pd(p, _mm512_cmp_pd_mask(p, _mm512_setzero_pd(), _CMP_LT_OQ), p, len);
+    p = _mm512_mask_sub_pd(p, _mm512_cmp_pd_mask(p, len, _CMP_GE_OQ), p, len);
+    return p;
+}
+
+TARGET_AVX512 static __m512i lanes_avx512(double pos, __m512d step_lo, __m512d step_hi,
+                                          __m512d vlen, __m512d vinv, __m512 *frac) {
+    __m512d base = _mm512_set1_pd(pos);
+    __m512d p_lo = wrap_pd_avx512(_mm512_add_pd(base, step_lo), vlen, vinv);
+    __m512d p_hi = wrap_pd_avx512(_mm512_add_pd(base, step_hi), vlen, vinv);
+    __m256i i_lo = _mm512_cvttpd_epi32(p_lo);
+    __m256i i_hi = _mm512_cvttpd_epi32(p_hi);
+    __m256 f_lo = _mm512_cvtpd_ps(_mm512_sub_pd(p_lo, _mm512_cvtepi32_pd(i_lo)));
+    __m256 f_hi = _mm512_cvtpd_ps(_mm512_sub_pd(p_hi, _mm512_cvtepi32_pd(i_hi)));
+    *frac = _mm512_castpd_ps(_mm512_insertf64x4(_mm512_castps_pd(_mm512_castps256_ps512(f_lo)),
+                                                _mm256_castps_pd(f_hi), 1));
+    return _mm512_inserti64x4(_mm512_castsi256_si512(i_lo), i_hi, 1);
+}
+
+TARGET_AVX512 static void osc_interp_avx512(const float *table, size_t length, double *phase,
+                                            double phase_inc, float gain, float *out, int n) {
+    const double len = (double)length;
+    const __m512d vlen = _mm512_set1_pd(len);
+    const __m512d vinv = _mm512_set1_pd(1.0 / len);
+    const __m512d vinc = _mm512_set1_pd(phase_inc);
+    const __m512d step_lo = _mm512_mul_pd(_mm512_set_pd(7, 6, 5, 4, 3, 2, 1, 0), vinc);
+    const __m512d step_hi = _mm512_mul_pd(_mm512_set_pd(15, 14, 13, 12, 11, 10, 9, 8), vinc);
+    const __m512i vlength = _mm512_set1_epi32((int)length);
+    const __m512i one = _mm512_set1_epi32(1);
+    const __m512 vgain = _mm512_set1_ps(gain);
+    double pos = *phase;
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 frac;
+        __m512i idx0 = lanes_avx512(pos, step_lo, step_hi, vlen, vinv, &frac);
+        __m512i idx1 = _mm512_add_epi32(idx0, one);
+        idx1 = _mm512_mask_mov_epi32(idx1, _mm512_cmpeq_epi32_mask(idx1, vlength),
+                                     _mm512_setzero_si512());
+        __m512 a = _mm512_i32gather_ps(idx0, table, 4);
+        __m512 b = _mm512_i32gather_ps(idx1, table, 4);
+        __m512 s = _mm512_fmadd_ps(frac, _mm512_sub_ps(b, a), a);
+        _mm512_storeu_ps(out + i, _mm512_fmadd_ps(vgain, s, _mm512_loadu_ps(out + i)));
+        pos = advance_phase(pos, phase_inc, 16, len);
+    }
+    *phase = osc_interp_tail(table, length, pos, phase_inc, gain, out + i, n - i);
+}
+
+TARGET_AVX512 static __m512 hermite_avx512(__m512 xm1, __m512 x0, __m512 x1, __m512 x2,
+                                           __m512 t) {
+    const __m512 half = _mm512_set1_ps(0.5f);
+    __m512 c1 = _mm512_mul_ps(half, _mm512_sub_ps(x1, xm1));
+    __m512 c2 = _mm512_add_ps(xm1, _mm512_add_ps(x1, x1));
+    c2 = _mm512_fnmadd_ps(_mm512_set1_ps(2.5f), x0, c2);
+    c2 = _mm512_fnmadd_ps(half, x2, c2);
+    __m512 c3 = _mm512_mul_ps(_mm512_set1_ps(1.5f), _mm512_sub_ps(x0, x1));
+    c3 = _mm512_fmadd_ps(half, _mm512_sub_ps(x2, xm1), c3);
+    __m512 y = _mm512_fmadd_ps(c3, t, c2);
+    y = _mm512_fmadd_ps(y, t, c1);
+    return _mm512_fmadd_ps(y, t, x0);
+}
+
+TARGET_AVX512 static void osc_hermite_avx512(const float *table, size_t length, double *phase,
+                                             double phase_inc, float gain, float *out, int n) {
+    const double len = (double)length;
+    const __m512d vlen = _mm512_set1_pd(len);
+    const __m512d vinv = _mm512_set1_pd(1.0 / len);
+    const __m512d vinc = _mm512_set1_pd(phase_inc);
+    const __m512d step_lo = _mm512_mul_pd(_mm512_set_pd(7, 6, 5, 4, 3, 2, 1, 0), vinc);
+    const __m512d step_hi = _mm512_mul_pd(_mm512_set_pd(15, 14, 13, 12, 11, 10, 9, 8), vinc);
+    const __m512i vlength = _mm512_set1_epi32((int)length);
+    const __m512i one = _mm512_set1_epi32(1);
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512 vgain = _mm512_set1_ps(gain);
+    double pos = *phase;
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 frac;
+        __m512i idx0 = lanes_avx512(pos, step_lo, step_hi, vlen, vinv, &frac);
+        __m512i im1 = _mm512_sub_epi32(idx0, one);
+        im1 = _mm512_mask_add_epi32(im1, _mm512_cmplt_epi32_mask(im1, zero), im1, vlength);
+        __m512i idx1 = _mm512_add_epi32(idx0, one);
+        idx1 = _mm512_mask_mov_epi32(idx1, _mm512_cmpeq_epi32_mask(idx1, vlength), zero);
+        __m512i idx2 = _mm512_add_epi32(idx1, one);
+        idx2 = _mm512_mask_mov_epi32(idx2, _mm512_cmpeq_epi32_mask(idx2, vlength), zero);
+        __m512 s = hermite_avx512(_mm512_i32gather_ps(im1, table, 4),
+                                  _mm512_i32gather_ps(idx0, table, 4),
+                                  _mm512_i32gather_ps(idx1, table, 4),
+                                  _mm512_i32gather_ps(idx2, table, 4), frac);
+        _mm512_storeu_ps(out + i, _mm512_fmadd_ps(vgain, s, _mm512_loadu_ps(out + i)));
+        pos = advance_phase(pos, phase_inc, 16, len);
+    }
+    *phase = pos;
+    Dsp_kernels_scalar()->osc_hermite(table, length, phase, phase_inc, gain, out + i, n - i);
+}
+
+TARGET_AVX512 static void fir_avx512(const float *x, float *w, int n, float b0, float b1,
+                                     float b2) {
+    const __m512 vb0 = _mm512_set1_ps(b0), vb1 = _mm512_set1_ps(b1), vb2 = _mm512_set1_ps(b2);
+    int k = 0;
+    for (; k + 16 <= n; k += 16) {
+        __m512 acc = _mm512_mul_ps(vb2, _mm512_loadu_ps(x + k));
+        acc = _mm512_fmadd_ps(vb1, _mm512_loadu_ps(x + k + 1), acc);
+        acc = _mm512_fmadd_ps(vb0, _mm512_loadu_ps(x + k + 2), acc);
+        _mm512_storeu_ps(w + k, acc);
+    }
+    for (; k < n; k++)
+        w[k] = b0 * x[k + 2] + b1 * x[k + 1] + b2 * x[k];
+}
+
+TARGET_AVX512 static void biquad_block_avx512(BiquadFilter *filter, float *buf, int n) {
+    Dsp_biquad_block_split(filter, buf, n, fir_avx512);
+}
+
+// Two frames per register; the last stage swaps 128-bit lanes within each frame.
+TARGET_AVX512 static void hadamard8_avx512(float *frames, int n) {
+    const __m512 alt = _mm512_set_ps(-1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1);
+    const __m512 pairs = _mm512_set_ps(-1, -1, 1, 1, -1, -1, 1, 1, -1, -1, 1, 1, -1, -1, 1, 1);
+    const __m512 halves = _mm512_set_ps(-1, -1, -1, -1, 1, 1, 1, 1, -1, -1, -1, -1, 1, 1, 1, 1);
+    int f = 0;
+    for (; f + 2 <= n; f += 2) {
+        __m512 x = _mm512_loadu_ps(frames + 8 * f);
+        x = _mm512_fmadd_ps(x, alt, _mm512_permute_ps(x, _MM_SHUFFLE(2, 3, 0, 1)));
+        x = _mm512_fmadd_ps(x, pairs, _mm512_permute_ps(x, _MM_SHUFFLE(1, 0, 3, 2)));
+        x = _mm512_fmadd_ps(x, halves, _mm512_shuffle_f32x4(x, x, _MM_SHUFFLE(2, 3, 0, 1)));
+        _mm512_storeu_ps(frames + 8 * f, x);
+    }
+    if (f < n)
+        hadamard8_avx2(frames + 8 * f, n - f);
+}
+
+TARGET_AVX512 static void mix_add_avx512(float *dst, const float *src, float gain, int n) {
+    const __m512 vgain = _mm512_set1_ps(gain);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 d = _mm512_loadu_ps(dst + i);
+        _mm512_storeu_ps(dst + i, _mm512_fmadd_ps(vgain, _mm512_loadu_ps(src + i), d));
+    }
+    if (i < n) {
+        __mmask16 m = (__mmask16)((1u << (n - i)) - 1);
+        __m512 d = _mm512_maskz_loadu_ps(m, dst + i);
+        __m512 s = _mm512_maskz_loadu_ps(m, src + i);
+        _mm512_mask_storeu_ps(dst + i, m, _mm512_fmadd_ps(vgain, s, d));
+    }
+}
+
+TARGET_AVX512 static void convert_s16_avx512(const float *src, int16_t *dst, int n) {
+    const __m512 lo = _mm512_set1_ps(-1.0f), hi = _mm512_set1_ps(1.0f);
+    const __m512 scale = _mm512_set1_ps(32767.0f);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 a = _mm512_min_ps(_mm512_max_ps(_mm512_loadu_ps(src + i), lo), hi);
+        __m256i s = _mm512_cvtsepi32_epi16(_mm512_cvtps_epi32(_mm512_mul_ps(a, scale)));
+        _mm256_storeu_si256((__m256i *)(dst + i), s);
+    }
+    for (; i < n; i++) {
+        float s = src[i] > 1.0f ? 1.0f : (src[i] < -1.0f ? -1.0f : src[i]);
+        dst[i] = (int16_t)lrintf(s * 32767.0f);
+    }
+}
+
+TARGET_AVX512 static void convert_s32_avx512(const float *src, int32_t *dst, float scale,
+                                             int n) {
+    const __m512 lo = _mm512_set1_ps(-1.0f), hi = _mm512_set1_ps(1.0f);
+    const __m512 vscale = _mm512_set1_ps(scale);
+    for (int i = 0; i < n; i += 16) {
+        __mmask16 m = n - i >= 16 ? (__mmask16)0xffff : (__mmask16)((1u << (n - i)) - 1);
+        __m512 a = _mm512_min_ps(_mm512_max_ps(_mm512_maskz_loadu_ps(m, src + i), lo), hi);
+        _mm512_mask_storeu_epi32(dst + i, m, _mm512_cvtps_epi32(_mm512_mul_ps(a, vscale)));
+    }
+}
+
+TARGET_AVX512 static void convert_f64_avx512(const float *src, double *dst, int n) {
+    for (int i = 0; i < n; i += 8) {
+        __mmask8 m = n - i >= 8 ? (__mmask8)0xff : (__mmask8)((1u << (n - i)) - 1);
+        __m256 s = _mm512_castps512_ps256(_mm512_maskz_loadu_ps((__mmask16)m, src + i));
+        _mm512_mask_storeu_pd(dst + i, m, _mm512_cvtps_pd(s));
+    }
+}
+
+static const DspKernels kernels_avx512 = {
+    .isa = DSP_ISA_AVX512,
+    .name = "avx512",
+    .osc_interp = osc_interp_avx512,
+    .osc_hermite = osc_hermite_avx512,
+    // Eight taps fill one AVX2 register exactly; the AVX2 sinc is already bound by the table
+    // reads, not the arithmetic.
+    .osc_sinc = osc_sinc_avx2,
+    .biquad_block = biquad_block_avx512,
+    .hadamard8 = hadamard8_avx512,
+    .mix_add = mix_add_avx512,
+    .convert_s16 = convert_s16_avx512,
+    .convert_s32 = convert_s32_avx512,
+    .convert_f64 = convert_f64_avx512,
+};
+
+const DspKernels *Dsp_kernels_sse2(void) {
+    return &kernels_sse2;
+}
+
+const DspKernels *Dsp_kernels_avx2(void) {
+    return &kernels_avx2;
+}
+
+const DspKernels *Dsp_kernels_avx512(void) {
+    return &kernels_avx512;
+}
+
+#else
+
+const DspKernels *Dsp_kernels_sse2(void) {
+    return NULL;
+}
+
+const DspKernels *Dsp_kernels_avx2(void) {
+    return NULL;
+}
+
+const DspKernels *Dsp_kernels_avx512(void) {
+    return NULL;
+}
+
+#endif
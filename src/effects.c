@@ -0,0 +1,202 @@
+#include "effects.h"
+#include "dsp.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+// Reverb line lengths at SAMPLE_RATE: mutually prime, 21 to 60 ms.
+#define FDN_SHORTEST 1031
+static const double fdn_lengths[FX_FDN_LINES] = {FDN_SHORTEST, 1327, 1523, 1801,
+                                                 2053,         2311, 2617, 2903};
+#define FX_MOD_DEPTH 8 // samples either side of the nominal length
+#define FX_MOD_RATE 0.1 // Hz for the first line; the others run a little faster
+// Fastest delay-time glide, in samples per sample of output (a quarter-tone-ish pitch bend).
+#define FX_GLIDE 0.25
+
+// Every tap reads whole blocks that were written before the block being produced.
+_Static_assert(FDN_SHORTEST - FX_MOD_DEPTH > BLOCK_SIZE, "reverb lines shorter than a block");
+
+static void DelayLine_init(DelayLine *line, size_t min_size) {
+    size_t size = 1;
+    while (size < min_size)
+        size <<= 1;
+    line->data = calloc(size, sizeof(float));
+    assert(line->data);
+    line->mask = size - 1;
+}
+
+// out[t * stride] = the line delayed by a delay ramping from d0 to d1 over the block, with
+// linear interpolation. pos is where the block's first sample will be written; both delays
+// must be at least n.
+static void read_ramp(const DelayLine *line, size_t pos, double d0, double d1, int n,
+                      float *out, int stride) {
+    double step = (d1 - d0) / n;
+    for (int t = 0; t < n; t++) {
+        double back = d0 + step * t - t; // samples behind pos
+        size_t whole = (size_t)back;
+        float frac = (float)(back - whole);
+        float a = line->data[(pos - whole) & line->mask];
+        float b = line->data[(pos - whole - 1) & line->mask];
+        out[t * stride] = a + frac * (b - a);
+    }
+}
+
+// A path that has already died away stays settled under its new settings.
+static void update_tails(Effects *fx) {
+    int delay_settled = fx->delay_quiet >= fx->delay_tail;
+    int reverb_settled = fx->reverb_quiet >= fx->reverb_tail;
+    double silence = log(SILENCE_THRESHOLD);
+    double time = fmax(fx->echo_time, fx->echo_target);
+    double echoes = fx->echo_feedback > 1e-3f ? silence / log(fx->echo_feedback) : 0.0;
+    fx->delay_tail = (long)(time * (echoes + 1.0)) + BLOCK_SIZE;
+    // RT60 is the time to fall 60 dB.
+    double seconds = fx->decay * (-20.0 * log10(SILENCE_THRESHOLD)) / 60.0;
+    fx->reverb_tail = (long)(seconds * SAMPLE_RATE + fdn_lengths[FX_FDN_LINES - 1]);
+    if (delay_settled)
+        fx->delay_quiet = fx->delay_tail;
+    if (reverb_settled)
+        fx->reverb_quiet = fx->reverb_tail;
+}
+
+Effects *Effects_create(void) {
+    Effects *fx = calloc(1, sizeof(Effects));
+    assert(fx);
+    size_t echo_size = (size_t)(FX_DELAY_MAX_SECONDS * SAMPLE_RATE) + BLOCK_SIZE + 2;
+    for (int side = 0; side < 2; side++)
+        DelayLine_init(&fx->echo[side], echo_size);
+    for (int i = 0; i < FX_FDN_LINES; i++) {
+        DelayLine_init(&fx->lines[i], (size_t)(fdn_lengths[i] + FX_MOD_DEPTH) + 2);
+        fx->mod_phase[i] = i * M_PI / 4.0;
+        fx->line_delay[i] = fdn_lengths[i] + FX_MOD_DEPTH * sin(fx->mod_phase[i]);
+    }
+    fx->echo_time = 0.375 * SAMPLE_RATE;
+    Effects_set_delay(fx, 0.0f, 0.375f, 0.4f);
+    Effects_set_reverb(fx, 0.0f, 2.0f, 0.3f); // the lines start empty, so both are settled
+    return fx;
+}
+
+void Effects_destroy(Effects *fx) {
+    if (!fx)
+        return;
+    for (int side = 0; side < 2; side++)
+        free(fx->echo[side].data);
+    for (int i = 0; i < FX_FDN_LINES; i++)
+        free(fx->lines[i].data);
+    free(fx);
+}
+
+void Effects_set_delay(Effects *fx, float send, float seconds, float feedback) {
+    fx->delay_send = clamp_unit(send);
+    float shortest = (float)BLOCK_SIZE / SAMPLE_RATE;
+    seconds = fminf(fmaxf(seconds, shortest), FX_DELAY_MAX_SECONDS);
+    fx->echo_target = seconds * SAMPLE_RATE;
+    fx->echo_feedback = fminf(fmaxf(feedback, 0.0f), FX_MAX_FEEDBACK);
+    update_tails(fx);
+}
+
+void Effects_set_reverb(Effects *fx, float send, float decay, float damping) {
+    fx->reverb_send = clamp_unit(send);
+    fx->decay = fminf(fmaxf(decay, 0.1f), 20.0f);
+    fx->damping = fminf(fmaxf(damping, 0.0f), FX_MAX_DAMPING);
+    // Per-line gain for -60 dB after decay seconds, whatever the line's length.
+    for (int i = 0; i < FX_FDN_LINES; i++)
+        fx->line_gain[i] = (float)pow(10.0, -3.0 * fdn_lengths[i] / (fx->decay * SAMPLE_RATE));
+    update_tails(fx);
+}
+
+static void process_delay(Effects *fx, const float *in, float *left, float *right, int n) {
+    const DspKernels *dsp = Dsp_get();
+    double from = fx->echo_time;
+    double glide = fx->echo_target - from;
+    double limit = FX_GLIDE * n;
+    double to = from + fmax(-limit, fmin(glide, limit));
+    float *l = fx->scratch[0], *r = fx->scratch[1];
+    read_ramp(&fx->echo[0], fx->echo_pos, from, to, n, l, 1);
+    read_ramp(&fx->echo[1], fx->echo_pos, from, to, n, r, 1);
+    // Ping-pong: the input enters on the left and every echo crosses over.
+    size_t mask = fx->echo[0].mask;
+    for (int t = 0; t < n; t++) {
+        size_t at = (fx->echo_pos + t) & mask;
+        fx->echo[0].data[at] = fx->delay_send * in[t] + fx->echo_feedback * r[t];
+        fx->echo[1].data[at] = fx->echo_feedback * l[t];
+    }
+    dsp->mix_add(left, l, 1.0f, n);
+    dsp->mix_add(right, r, 1.0f, n);
+    fx->echo_pos += n;
+    fx->echo_time = to;
+}
+
+static void process_reverb(Effects *fx, const float *in, float *left, float *right, int n) {
+    const DspKernels *dsp = Dsp_get();
+    const float norm = 1.0f / sqrtf(FX_FDN_LINES); // makes the Hadamard matrix orthonormal
+    float *frames = fx->frames;
+    // Control rate: one modulation step per line per block, ramped across the block.
+    for (int i = 0; i < FX_FDN_LINES; i++) {
+        double rate = FX_MOD_RATE * (1.0 + 0.37 * i);
+        fx->mod_phase[i] = fmod(fx->mod_phase[i] + 2.0 * M_PI * rate * n / SAMPLE_RATE,
+                                2.0 * M_PI);
+        double next = fdn_lengths[i] + FX_MOD_DEPTH * sin(fx->mod_phase[i]);
+        read_ramp(&fx->lines[i], fx->fdn_pos, fx->line_delay[i], next, n, frames + i,
+                  FX_FDN_LINES);
+        fx->line_delay[i] = next;
+    }
+    // Damp each line, tap even lines to the left and odd lines to the right, then apply the
+    // decay gain ahead of the mixing matrix.
+    float *l = fx->scratch[0], *r = fx->scratch[1];
+    for (int t = 0; t < n; t++) {
+        float *x = frames + t * FX_FDN_LINES;
+        float sum[2] = {0.0f, 0.0f};
+        for (int i = 0; i < FX_FDN_LINES; i++) {
+            float y = x[i] + fx->damping * (fx->damp_state[i] - x[i]);
+            fx->damp_state[i] = y;
+            sum[i & 1] += y;
+            x[i] = y * fx->line_gain[i] * norm;
+        }
+        l[t] = 0.5f * sum[0];
+        r[t] = 0.5f * sum[1];
+    }
+    dsp->hadamard8(frames, n);
+    for (int t = 0; t < n; t++) {
+        const float *x = frames + t * FX_FDN_LINES;
+        float input = fx->reverb_send * norm * in[t];
+        for (int i = 0; i < FX_FDN_LINES; i++) {
+            const DelayLine *line = &fx->lines[i];
+            // Alternating input signs keep the lines from starting out identical.
+            line->data[(fx->fdn_pos + t) & line->mask] = x[i] + (i & 1 ? -input : input);
+        }
+    }
+    dsp->mix_add(left, l, 1.0f, n);
+    dsp->mix_add(right, r, 1.0f, n);
+    fx->fdn_pos += n;
+}
+
+// Count quiet frames up to the tail length; returns 1 while the path still has to run.
+static int still_ringing(long *quiet, long tail, float peak, int n) {
+    if (peak >= SILENCE_THRESHOLD)
+        *quiet = 0;
+    else if (*quiet < tail)
+        *quiet += n;
+    return *quiet < tail;
+}
+
+void Effects_process(Effects *fx, const float *in, float *left, float *right, int n) {
+    assert(n <= BLOCK_SIZE);
+    float peak = 0.0f;
+    for (int t = 0; t < n; t++) {
+        left[t] = right[t] = in[t];
+        peak = fmaxf(peak, fabsf(in[t]));
+    }
+    int delay_settled = fx->delay_quiet >= fx->delay_tail;
+    if (still_ringing(&fx->delay_quiet, fx->delay_tail, peak * fx->delay_send, n)) {
+        // No echoes are sounding, so a new delay time can apply at once.
+        if (delay_settled)
+            fx->echo_time = fx->echo_target;
+        process_delay(fx, in, left, right, n);
+    }
+    if (still_ringing(&fx->reverb_quiet, fx->reverb_tail, peak * fx->reverb_send, n))
+        process_reverb(fx, in, left, right, n);
+}
+
+int Effects_settled(const Effects *fx) {
+    return fx->delay_quiet >= fx->delay_tail && fx->reverb_quiet >= fx->reverb_tail;
+}
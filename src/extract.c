@@ -0,0 +1,219 @@
+#include "extract.h"
+#include "config.h"
+#include "fft.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRIM_FRAME 2048
+#define TRIM_HOP 512
+#define YIN_THRESHOLD 0.1
+#define YIN_FMIN 50.0
+#define YIN_FMAX 2000.0
+
+ExtractOptions ExtractOptions_default(void) {
+    ExtractOptions opts;
+    opts.freq = 0.0;
+    opts.table_size = TABLE_SIZE;
+    opts.top_db = 20.0f;
+    return opts;
+}
+
+void Extract_normalize(float *data, size_t length) {
+    float peak = 0.0f;
+    for (size_t i = 0; i < length; i++) {
+        if (fabsf(data[i]) > peak)
+            peak = fabsf(data[i]);
+    }
+    if (peak > 0.0f) {
+        for (size_t i = 0; i < length; i++)
+            data[i] /= peak;
+    }
+}
+
+void Extract_trim(const float *data, size_t length, float top_db, size_t *start, size_t *end) {
+    size_t frames = length / TRIM_HOP + 1;
+    float *rms = malloc(frames * sizeof(float));
+    if (!rms) {
+        *start = 0;
+        *end = length;
+        return;
+    }
+    float peak = 0.0f;
+    for (size_t i = 0; i < frames; i++) {
+        long centre = (long)(i * TRIM_HOP);
+        double sum = 0.0;
+        for (long j = centre - TRIM_FRAME / 2; j < centre + TRIM_FRAME / 2; j++) {
+            if (j >= 0 && j < (long)length)
+                sum += (double)data[j] * data[j];
+        }
+        rms[i] = (float)sqrt(sum / TRIM_FRAME);
+        if (rms[i] > peak)
+            peak = rms[i];
+    }
+    float threshold = peak * powf(10.0f, -top_db / 20.0f);
+    // Longest run of loud frames; for a single note this is the same as trimming both ends.
+    size_t first = frames, last = 0, run_start = 0;
+    for (size_t i = 0; i < frames; i++) {
+        if (rms[i] <= threshold) {
+            run_start = i + 1;
+            continue;
+        }
+        if (first == frames || i - run_start > last - first) {
+            first = run_start;
+            last = i;
+        }
+    }
+    free(rms);
+    if (first == frames) {
+        *start = 0;
+        *end = 0;
+        return;
+    }
+    *start = first * TRIM_HOP;
+    *end = (last + 1) * TRIM_HOP < length ? (last + 1) * TRIM_HOP : length;
+}
+
+double Extract_detect_pitch(const float *data, size_t length, int sample_rate, double fmin,
+                            double fmax) {
+    size_t tau_min = (size_t)(sample_rate / fmax);
+    size_t tau_max = (size_t)(sample_rate / fmin) + 1;
+    if (tau_min < 2)
+        tau_min = 2;
+    if (length < 2 * tau_max)
+        tau_max = length / 2;
+    if (tau_max <= tau_min + 1)
+        return 0.0;
+    size_t window = length - tau_max;
+    if (window > 4 * tau_max)
+        window = 4 * tau_max;
+
+    double *cmnd = malloc((tau_max + 1) * sizeof(double));
+    if (!cmnd)
+        return 0.0;
+    // Cumulative mean normalised difference (YIN steps 2 and 3).
+    cmnd[0] = 1.0;
+    double running = 0.0;
+    for (size_t tau = 1; tau <= tau_max; tau++) {
+        double d = 0.0;
+        for (size_t j = 0; j < window; j++) {
+            double diff = (double)data[j] - data[j + tau];
+            d += diff * diff;
+        }
+        running += d;
+        cmnd[tau] = running > 0.0 ? d * tau / running : 1.0;
+    }
+    // First dip under the threshold, followed down to its local minimum; else the global one.
+    size_t best = 0;
+    for (size_t tau = tau_min; tau < tau_max; tau++) {
+        if (cmnd[tau] < YIN_THRESHOLD) {
+            while (tau + 1 < tau_max && cmnd[tau + 1] < cmnd[tau])
+                tau++;
+            best = tau;
+            break;
+        }
+    }
+    if (!best) {
+        best = tau_min;
+        for (size_t tau = tau_min; tau < tau_max; tau++) {
+            if (cmnd[tau] < cmnd[best])
+                best = tau;
+        }
+        if (cmnd[best] > 0.5) {
+            free(cmnd);
+            return 0.0;
+        }
+    }
+    // Parabolic interpolation between neighbouring lags.
+    double tau = (double)best;
+    if (best > 1 && best < tau_max) {
+        double a = cmnd[best - 1], b = cmnd[best], c = cmnd[best + 1];
+        double denom = a - 2.0 * b + c;
+        if (denom != 0.0)
+            tau += 0.5 * (a - c) / denom;
+    }
+    free(cmnd);
+    return sample_rate / tau;
+}
+
+void Extract_resample_fft(const float *in, size_t in_len, float *out, size_t out_len) {
+    Fft *fwd = Fft_create(in_len);
+    Fft *inv = Fft_create(out_len);
+    FftComplex *x = calloc(in_len, sizeof(FftComplex));
+    FftComplex *y = calloc(out_len, sizeof(FftComplex));
+    if (!x || !y) {
+        free(x);
+        free(y);
+        Fft_destroy(fwd);
+        Fft_destroy(inv);
+        memset(out, 0, out_len * sizeof(float));
+        return;
+    }
+    for (size_t i = 0; i < in_len; i++)
+        x[i].re = in[i];
+    Fft_forward(fwd, x);
+
+    // Keep the bins both lengths share; an even-length Nyquist bin is split or folded.
+    size_t n = in_len < out_len ? in_len : out_len;
+    size_t nyq = n / 2 + 1;
+    for (size_t k = 0; k < nyq && k <= out_len / 2; k++)
+        y[k] = x[k];
+    if (n % 2 == 0) {
+        float scale = out_len < in_len ? 2.0f : (in_len < out_len ? 0.5f : 1.0f);
+        y[n / 2].re *= scale;
+        y[n / 2].im *= scale;
+    }
+    // Mirror to a Hermitian spectrum so the inverse is real.
+    if (out_len % 2 == 0)
+        y[out_len / 2].im = 0.0f;
+    for (size_t k = 1; k < (out_len + 1) / 2; k++)
+        y[out_len - k] = (FftComplex){y[k].re, -y[k].im};
+    Fft_inverse(inv, y);
+
+    float gain = (float)out_len / in_len;
+    for (size_t i = 0; i < out_len; i++)
+        out[i] = y[i].re * gain;
+    free(x);
+    free(y);
+    Fft_destroy(fwd);
+    Fft_destroy(inv);
+}
+
+Wavetable *Extract_wavetable(const float *samples, size_t length, int sample_rate,
+                             const ExtractOptions *opts, double *freq_out) {
+    if (length == 0 || sample_rate <= 0 || opts->table_size == 0)
+        return NULL;
+    float *audio = malloc(length * sizeof(float));
+    if (!audio)
+        return NULL;
+    memcpy(audio, samples, length * sizeof(float));
+    Extract_normalize(audio, length);
+
+    size_t start, end;
+    Extract_trim(audio, length, opts->top_db, &start, &end);
+    const float *trimmed = audio + start;
+    size_t trimmed_len = end - start;
+
+    // Detect on the middle of the note, where the pitch is steadiest.
+    double freq = opts->freq;
+    if (freq <= 0.0) {
+        size_t span = (size_t)(sample_rate / YIN_FMIN) * 6;
+        size_t from = trimmed_len > span ? (trimmed_len - span) / 2 : 0;
+        size_t count = trimmed_len - from < span ? trimmed_len - from : span;
+        freq = Extract_detect_pitch(trimmed + from, count, sample_rate, YIN_FMIN, YIN_FMAX);
+    }
+    if (freq_out)
+        *freq_out = freq;
+    size_t period = freq > 0.0 ? (size_t)lround(sample_rate / freq) : 0;
+    long cycle_start = (long)(trimmed_len / 2) - (long)(period / 2);
+    if (period < 2 || cycle_start < 0 || cycle_start + period > trimmed_len) {
+        free(audio);
+        return NULL;
+    }
+
+    Wavetable *wt = Wavetable_create(WAVEFORM_CUSTOM, opts->table_size);
+    Extract_resample_fft(trimmed + cycle_start, period, wt->data, wt->length);
+    Extract_normalize(wt->data, wt->length);
+    free(audio);
+    return wt;
+}
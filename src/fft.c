@@ -0,0 +1,141 @@
+#include "fft.h"
+#include "config.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int is_pow2(size_t n) {
+    return n && !(n & (n - 1));
+}
+
+static size_t next_pow2(size_t n) {
+    size_t m = 1;
+    while (m < n)
+        m <<= 1;
+    return m;
+}
+
+// Iterative radix-2 transform of size m; inverse conjugates the twiddles.
+static void radix2(const FftComplex *twiddles, size_t m, FftComplex *data, int inverse) {
+    for (size_t i = 1, j = 0; i < m; i++) {
+        size_t bit = m >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            FftComplex tmp = data[i];
+            data[i] = data[j];
+            data[j] = tmp;
+        }
+    }
+    for (size_t len = 2; len <= m; len <<= 1) {
+        size_t half = len >> 1;
+        size_t stride = m / len;
+        for (size_t i = 0; i < m; i += len) {
+            for (size_t k = 0; k < half; k++) {
+                FftComplex w = twiddles[k * stride];
+                if (inverse)
+                    w.im = -w.im;
+                FftComplex a = data[i + k];
+                FftComplex b = data[i + k + half];
+                FftComplex t = {b.re * w.re - b.im * w.im, b.re * w.im + b.im * w.re};
+                data[i + k] = (FftComplex){a.re + t.re, a.im + t.im};
+                data[i + k + half] = (FftComplex){a.re - t.re, a.im - t.im};
+            }
+        }
+    }
+}
+
+Fft *Fft_create(size_t n) {
+    assert(n > 0);
+    Fft *fft = malloc(sizeof(Fft));
+    assert(fft);
+    fft->n = n;
+    fft->m = is_pow2(n) ? n : next_pow2(2 * n - 1);
+    fft->twiddles = malloc((fft->m / 2 + 1) * sizeof(FftComplex));
+    fft->work = malloc(fft->m * sizeof(FftComplex));
+    assert(fft->twiddles && fft->work);
+    for (size_t k = 0; k < fft->m / 2 + 1; k++) {
+        double angle = -2.0 * M_PI * k / fft->m;
+        fft->twiddles[k] = (FftComplex){(float)cos(angle), (float)sin(angle)};
+    }
+    fft->chirp = NULL;
+    fft->chirp_fft = NULL;
+    if (fft->m != n) {
+        fft->chirp = malloc(n * sizeof(FftComplex));
+        fft->chirp_fft = calloc(fft->m, sizeof(FftComplex));
+        assert(fft->chirp && fft->chirp_fft);
+        for (size_t k = 0; k < n; k++) {
+            // k^2 mod 2n keeps the angle small enough for double precision.
+            double angle = M_PI * (double)((k * k) % (2 * n)) / n;
+            fft->chirp[k] = (FftComplex){(float)cos(angle), (float)-sin(angle)};
+        }
+        fft->chirp_fft[0] = (FftComplex){fft->chirp[0].re, -fft->chirp[0].im};
+        for (size_t k = 1; k < n; k++) {
+            FftComplex c = {fft->chirp[k].re, -fft->chirp[k].im};
+            fft->chirp_fft[k] = c;
+            fft->chirp_fft[fft->m - k] = c;
+        }
+        radix2(fft->twiddles, fft->m, fft->chirp_fft, 0);
+    }
+    return fft;
+}
+
+void Fft_destroy(Fft *fft) {
+    if (!fft)
+        return;
+    free(fft->twiddles);
+    free(fft->chirp);
+    free(fft->chirp_fft);
+    free(fft->work);
+    free(fft);
+}
+
+static void bluestein(Fft *fft, FftComplex *data, int inverse) {
+    size_t n = fft->n, m = fft->m;
+    FftComplex *work = fft->work;
+    // An inverse transform is a forward one on conjugated input, conjugated again.
+    for (size_t k = 0; k < n; k++) {
+        FftComplex x = data[k];
+        if (inverse)
+            x.im = -x.im;
+        FftComplex c = fft->chirp[k];
+        work[k] = (FftComplex){x.re * c.re - x.im * c.im, x.re * c.im + x.im * c.re};
+    }
+    memset(work + n, 0, (m - n) * sizeof(FftComplex));
+    radix2(fft->twiddles, m, work, 0);
+    for (size_t k = 0; k < m; k++) {
+        FftComplex a = work[k], b = fft->chirp_fft[k];
+        work[k] = (FftComplex){a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re};
+    }
+    radix2(fft->twiddles, m, work, 1);
+    float scale = 1.0f / m;
+    for (size_t k = 0; k < n; k++) {
+        FftComplex a = {work[k].re * scale, work[k].im * scale};
+        FftComplex c = fft->chirp[k];
+        FftComplex y = {a.re * c.re - a.im * c.im, a.re * c.im + a.im * c.re};
+        if (inverse)
+            y.im = -y.im;
+        data[k] = y;
+    }
+}
+
+void Fft_forward(Fft *fft, FftComplex *data) {
+    if (fft->chirp)
+        bluestein(fft, data, 0);
+    else
+        radix2(fft->twiddles, fft->n, data, 0);
+}
+
+void Fft_inverse(Fft *fft, FftComplex *data) {
+    if (fft->chirp)
+        bluestein(fft, data, 1);
+    else
+        radix2(fft->twiddles, fft->n, data, 1);
+    float scale = 1.0f / fft->n;
+    for (size_t k = 0; k < fft->n; k++) {
+        data[k].re *= scale;
+        data[k].im *= scale;
+    }
+}
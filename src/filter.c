@@ -1,6 +1,7 @@
 #include <math.h>
 #include "filter.h"
 #include "config.h"
+#include "dsp.h"
 
 // Initialize the biquad filter
 void Biquad_init(BiquadFilter *filter, float b0, float b1, float b2, float a1, float a2) {
@@ -20,6 +21,22 @@ float Biquad_process(BiquadFilter *filter, float input) {
     return output;
 }
 
+int Biquad_settle(BiquadFilter *filter, float threshold) {
+    if (fabsf(filter->z1) >= threshold || fabsf(filter->z2) >= threshold)
+        return 0;
+    filter->z1 = 0.0f;
+    filter->z2 = 0.0f;
+    return 1;
+}
+
+void Biquad_copy_coefficients(BiquadFilter *filter, const BiquadFilter *src) {
+    filter->b0 = src->b0;
+    filter->b1 = src->b1;
+    filter->b2 = src->b2;
+    filter->a1 = src->a1;
+    filter->a2 = src->a2;
+}
+
 void Biquad_design_lowpass(BiquadFilter *filter, float cutoff, float Q) {
     float omega = 2.0f * M_PI * cutoff / SAMPLE_RATE;
     float sn = sinf(omega);
@@ -76,6 +93,14 @@ float Lowpass_process(LowpassFilter *filter, float input) {
     return Biquad_process(&filter->biquad, input);
 }
 
+void Lowpass_process_block(LowpassFilter *filter, float *buf, int n) {
+    Dsp_get()->biquad_block(&filter->biquad, buf, n);
+}
+
+int Lowpass_settle(LowpassFilter *filter, float threshold) {
+    return Biquad_settle(&filter->biquad, threshold);
+}
+
 void Lowpass_set_cutoff(LowpassFilter *filter, float cutoff) {
     filter->cutoff = cutoff;
     Biquad_design_lowpass(&filter->biquad, filter->cutoff, filter->q);
@@ -0,0 +1,277 @@
+#include "golden.h"
+#include "config.h"
+#include "state.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GOLDEN_FRAMES (SAMPLE_RATE / 4)
+
+static void add_event(GoldenScenario *sc, int frame, GoldenEventType type, int target,
+                      double value) {
+    assert(sc->num_events < GOLDEN_MAX_EVENTS);
+    sc->events[sc->num_events++] = (GoldenEvent){frame, type, target, value};
+}
+
+int Golden_scenario_count(void) {
+    return 3;
+}
+
+void Golden_scenario(int index, GoldenScenario *sc) {
+    memset(sc, 0, sizeof(*sc));
+    sc->frames = GOLDEN_FRAMES;
+    sc->min_snr_db = 90.0;
+    sc->max_abs_error = 1e-4;
+    // The fourth slot loads Trumpet.bin from the working directory; keep it out of the mix.
+    add_event(sc, 0, GOLDEN_LEVEL, 3, 0.0);
+    switch (index) {
+    case 0:
+        // C major triad, then the third is released halfway through.
+        sc->name = "chord";
+        add_event(sc, 0, GOLDEN_NOTE_ON, 0, 261.63);
+        add_event(sc, 0, GOLDEN_NOTE_ON, 1, 329.63);
+        add_event(sc, 0, GOLDEN_NOTE_ON, 2, 392.00);
+        add_event(sc, GOLDEN_FRAMES / 2, GOLDEN_NOTE_OFF, 1, 0.0);
+        break;
+    case 1:
+        // Phase-continuous exponential glide from 55 Hz to 3.5 kHz, updated every 128 frames.
+        sc->name = "sweep";
+        add_event(sc, 0, GOLDEN_NOTE_ON, 0, 55.0);
+        for (int frame = 128; frame < GOLDEN_FRAMES; frame += 128)
+            add_event(sc, frame, GOLDEN_FREQ, 0, 55.0 * pow(64.0, (double)frame / GOLDEN_FRAMES));
+        break;
+    default:
+        // Level and filter changes on a held two-note chord, at block and non-block frames.
+        sc->name = "levels";
+        add_event(sc, 0, GOLDEN_NOTE_ON, 4, 110.0);
+        add_event(sc, 0, GOLDEN_NOTE_ON, 5, 164.81);
+        add_event(sc, 1000, GOLDEN_LEVEL, 0, 0.3);
+        add_event(sc, 2048, GOLDEN_CUTOFF, 0, 2000.0);
+        add_event(sc, 4000, GOLDEN_LEVEL, 1, 0.0);
+        add_event(sc, 5555, GOLDEN_Q, 0, 4.0);
+        add_event(sc, 7000, GOLDEN_LEVEL, 2, 0.5);
+        add_event(sc, 9000, GOLDEN_CUTOFF, 0, 600.0);
+        add_event(sc, 10240, GOLDEN_NOTE_OFF, 4, 0.0);
+        break;
+    }
+}
+
+static void apply_event(State *state, const GoldenEvent *e) {
+    switch (e->type) {
+    case GOLDEN_NOTE_ON:
+        State_set_note(state, e->target, e->value);
+        break;
+    case GOLDEN_NOTE_OFF:
+        State_clear_voice(state, e->target);
+        break;
+    case GOLDEN_FREQ:
+        State_set_freq(state, e->target, e->value);
+        break;
+    case GOLDEN_LEVEL:
+        state->wt_levels[e->target] = (float)e->value;
+        break;
+    case GOLDEN_CUTOFF:
+        Lowpass_set_cutoff(&state->lpf, (float)e->value);
+        break;
+    case GOLDEN_Q:
+        Lowpass_set_q(&state->lpf, (float)e->value);
+        break;
+    }
+}
+
+void Golden_render(const GoldenScenario *sc, float *out, int per_sample) {
+    State *state = State_create();
+    int next = 0;
+    int frame = 0;
+    while (frame < sc->frames) {
+        while (next < sc->num_events && sc->events[next].frame <= frame)
+            apply_event(state, &sc->events[next++]);
+        int end = frame + BLOCK_SIZE < sc->frames ? frame + BLOCK_SIZE : sc->frames;
+        if (next < sc->num_events && sc->events[next].frame < end)
+            end = sc->events[next].frame;
+        if (per_sample) {
+            for (int i = frame; i < end; i++)
+                out[i] = Lowpass_process(&state->lpf, State_mix_sample(state));
+        } else {
+            State_render(state, out + frame, end - frame);
+            Lowpass_process_block(&state->lpf, out + frame, end - frame);
+        }
+        frame = end;
+    }
+    State_destroy(state);
+}
+
+// --- Double-precision model ---
+// Mirrors the engine's semantics (voices, per-slot levels, linear interpolation, RBJ lowpass
+// redesigned from scratch on every change) without sharing its arithmetic. Only the source
+// tables are taken from the engine.
+
+typedef struct {
+    double b0, b1, b2, a1, a2;
+    double z1, z2;
+} RefBiquad;
+
+static void ref_design(RefBiquad *f, double cutoff, double q) {
+    double omega = 2.0 * M_PI * cutoff / SAMPLE_RATE;
+    double cs = cos(omega);
+    double alpha = sin(omega) / (2.0 * q);
+    double a0 = 1.0 + alpha;
+    f->b0 = (1.0 - cs) / 2.0 / a0;
+    f->b1 = (1.0 - cs) / a0;
+    f->b2 = f->b0;
+    f->a1 = -2.0 * cs / a0;
+    f->a2 = (1.0 - alpha) / a0;
+    f->z1 = f->z2 = 0.0;
+}
+
+void Golden_render_reference(const GoldenScenario *sc, double *out) {
+    State *tables = State_create();
+    double *phase = calloc(NUM_VOICES, sizeof(double));
+    double *inc = calloc(NUM_VOICES, sizeof(double));
+    int *active = calloc(NUM_VOICES, sizeof(int));
+    double *levels = malloc(NUM_WAVETABLES * sizeof(double));
+    assert(phase && inc && active && levels);
+    for (int slot = 0; slot < NUM_WAVETABLES; slot++)
+        levels[slot] = tables->wt_levels[slot];
+    double cutoff = tables->lpf.cutoff, q = tables->lpf.q;
+    RefBiquad lpf;
+    ref_design(&lpf, cutoff, q);
+
+    int next = 0;
+    for (int frame = 0; frame < sc->frames; frame++) {
+        for (; next < sc->num_events && sc->events[next].frame <= frame; next++) {
+            const GoldenEvent *e = &sc->events[next];
+            switch (e->type) {
+            case GOLDEN_NOTE_ON:
+                active[e->target] = 1;
+                phase[e->target] = 0.0;
+                inc[e->target] = TABLE_SIZE * e->value / SAMPLE_RATE;
+                break;
+            case GOLDEN_NOTE_OFF:
+                active[e->target] = 0;
+                break;
+            case GOLDEN_FREQ:
+                inc[e->target] = TABLE_SIZE * e->value / SAMPLE_RATE;
+                break;
+            case GOLDEN_LEVEL:
+                levels[e->target] = e->value;
+                break;
+            case GOLDEN_CUTOFF:
+                cutoff = e->value;
+                ref_design(&lpf, cutoff, q);
+                break;
+            case GOLDEN_Q:
+                q = e->value;
+                ref_design(&lpf, cutoff, q);
+                break;
+            }
+        }
+        double mix = 0.0;
+        for (int voice = 0; voice < NUM_VOICES; voice++) {
+            if (!active[voice])
+                continue;
+            // Every oscillator of a voice shares its phase; oscillator i plays slot i.
+            int index0 = (int)phase[voice];
+            double frac = phase[voice] - index0;
+            for (int i = 0; i < NUM_OSCS; i++) {
+                const Wavetable *wt = &tables->wts[i % NUM_WAVETABLES];
+                if (levels[i % NUM_WAVETABLES] == 0.0)
+                    continue;
+                double a = wt->data[index0], b = wt->data[(index0 + 1) % wt->length];
+                mix += levels[i % NUM_WAVETABLES] * (a + frac * (b - a)) / NUM_OSCS;
+            }
+            phase[voice] = fmod(phase[voice] + inc[voice], TABLE_SIZE);
+        }
+        double y = lpf.b0 * mix + lpf.z1;
+        lpf.z1 = lpf.b1 * mix + lpf.z2 - lpf.a1 * y;
+        lpf.z2 = lpf.b2 * mix - lpf.a2 * y;
+        out[frame] = y;
+    }
+    free(levels);
+    free(active);
+    free(inc);
+    free(phase);
+    State_destroy(tables);
+}
+
+void Golden_compare(const float *actual, const double *reference, size_t n, GoldenStats *stats) {
+    double signal = 0.0, noise = 0.0;
+    stats->max_abs_error = 0.0;
+    stats->worst_frame = 0;
+    for (size_t i = 0; i < n; i++) {
+        double error = actual[i] - reference[i];
+        signal += reference[i] * reference[i];
+        noise += error * error;
+        if (fabs(error) > stats->max_abs_error) {
+            stats->max_abs_error = fabs(error);
+            stats->worst_frame = i;
+        }
+    }
+    stats->snr_db = noise > 0.0 ? 10.0 * log10(signal / noise) : INFINITY;
+}
+
+int Golden_passes(const GoldenScenario *sc, const GoldenStats *stats) {
+    return stats->snr_db >= sc->min_snr_db && stats->max_abs_error <= sc->max_abs_error;
+}
+
+static const unsigned char golden_magic[4] = {'W', 'G', 'L', 'D'};
+
+int Golden_save(const char *filename, const double *samples, size_t n) {
+    FILE *f = fopen(filename, "wb");
+    if (!f)
+        return -1;
+    unsigned char bytes[8];
+    int err = fwrite(golden_magic, 1, 4, f) != 4 ? -1 : 0;
+    for (int b = 0; b < 4; b++)
+        bytes[b] = (unsigned char)((uint32_t)n >> (8 * b));
+    if (!err && fwrite(bytes, 1, 4, f) != 4)
+        err = -1;
+    for (size_t i = 0; i < n && !err; i++) {
+        uint64_t u;
+        memcpy(&u, &samples[i], sizeof(u));
+        for (int b = 0; b < 8; b++)
+            bytes[b] = (unsigned char)(u >> (8 * b));
+        if (fwrite(bytes, 1, 8, f) != 8)
+            err = -1;
+    }
+    if (fclose(f) != 0)
+        err = -1;
+    return err;
+}
+
+int Golden_load(const char *filename, double **samples, size_t *n) {
+    FILE *f = fopen(filename, "rb");
+    if (!f)
+        return -1;
+    unsigned char bytes[8];
+    if (fread(bytes, 1, 8, f) != 8 || memcmp(bytes, golden_magic, 4) != 0) {
+        fclose(f);
+        return -1;
+    }
+    uint32_t count = 0;
+    for (int b = 0; b < 4; b++)
+        count |= (uint32_t)bytes[4 + b] << (8 * b);
+    double *data = malloc((count ? count : 1) * sizeof(double));
+    if (!data) {
+        fclose(f);
+        return -1;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (fread(bytes, 1, 8, f) != 8) {
+            free(data);
+            fclose(f);
+            return -1;
+        }
+        uint64_t u = 0;
+        for (int b = 0; b < 8; b++)
+            u |= (uint64_t)bytes[b] << (8 * b);
+        memcpy(&data[i], &u, sizeof(u));
+    }
+    fclose(f);
+    *samples = data;
+    *n = count;
+    return 0;
+}
@@ -1,5 +1,9 @@
 #include "graphics.h"
+#include "analyzer.h"
+#include <assert.h>
+#include <math.h>
 #include <raylib.h>
+#include <stdlib.h>
 
 void DrawSlider(int x, int y, int width, int height, float level, const char *label) {
     // Clamp level between 0 and 1
@@ -20,3 +24,142 @@ void DrawSlider(int x, int y, int width, int height, float level, const char *la
     // sprintf(levelText, "%.1f", level);
     // DrawText(levelText, x, y - 20, 20, DARKGRAY);
 }
+
+void DrawHarmonics(int x, int y, int width, int height, const float *magnitudes, int count,
+                   int selected, float rebuild_ms) {
+    DrawRectangleLines(x, y, width, height, BLACK);
+    int bar = width / count;
+    for (int i = 0; i < count; i++) {
+        float level = magnitudes[i];
+        if (level < 0.0f) level = 0.0f;
+        if (level > 1.0f) level = 1.0f;
+        int fillHeight = (int)(level * height);
+        DrawRectangle(x + i * bar + 1, y + (height - fillHeight), bar - 2, fillHeight,
+                      i == selected ? RED : GREEN);
+    }
+    DrawText(TextFormat("H%d  %.2f ms", selected + 1, rebuild_ms), x, y + height, 20, DARKGRAY);
+}
+
+void DrawMixer(int x, int y, int size, const MixerShape *shape, const float *cursor) {
+    DrawRectangle(x, y, size, size, RAYWHITE);
+    DrawRectangleLines(x, y, size, size, BLACK);
+    if (shape->dims != 2)
+        return;
+    // Shape coordinates span roughly [-1.5, 1.5]; y points up.
+    float scale = size / 3.0f;
+    float cx = x + size / 2.0f, cy = y + size / 2.0f;
+    int faces = shape->faces;
+    for (int f = 0; f < faces; f++) {
+        // Each vertex is where consecutive faces meet.
+        Vector2 v[2];
+        for (int k = 0; k < 2; k++) {
+            int a = (f + k + faces - 1) % faces, b = (f + k) % faces;
+            float a0 = shape->normals[a], a1 = shape->normals[faces + a];
+            float b0 = shape->normals[b], b1 = shape->normals[faces + b];
+            float det = a0 * b1 - a1 * b0;
+            float px = (shape->offsets[a] * b1 - shape->offsets[b] * a1) / det;
+            float py = (a0 * shape->offsets[b] - b0 * shape->offsets[a]) / det;
+            v[k] = (Vector2){cx + px * scale, cy - py * scale};
+        }
+        DrawLineEx(v[0], v[1], 2.0f, DARKGRAY);
+    }
+    DrawCircleV((Vector2){cx + cursor[0] * scale, cy - cursor[1] * scale}, 5.0f, RED);
+}
+
+// Spectrum view: bars over the top half, spectrogram over the bottom half.
+static float band_position(float hz) {
+    return ANALYZER_BANDS * logf(hz / ANALYZER_MIN_HZ) / logf(ANALYZER_MAX_HZ / ANALYZER_MIN_HZ);
+}
+
+static float db_unit(float db) {
+    float t = 1.0f - db / ANALYZER_FLOOR_DB;
+    return t < 0.0f ? 0.0f : t > 1.0f ? 1.0f : t;
+}
+
+// Black through blue and red to yellow as the level rises.
+static Color heat(float t) {
+    static const Color stops[4] = {{0, 0, 0, 255}, {0, 0, 200, 255}, {220, 0, 0, 255},
+                                   {255, 240, 0, 255}};
+    float at = t * 3.0f;
+    int i = at >= 3.0f ? 2 : (int)at;
+    float f = at - i;
+    Color a = stops[i], b = stops[i + 1];
+    return (Color){(unsigned char)(a.r + f * (b.r - a.r)), (unsigned char)(a.g + f * (b.g - a.g)),
+                   (unsigned char)(a.b + f * (b.b - a.b)), 255};
+}
+
+SpectrumView *SpectrumView_create(int width, int height) {
+    SpectrumView *view = calloc(1, sizeof(SpectrumView));
+    assert(view);
+    view->width = width;
+    view->height = height;
+    view->column = malloc(ANALYZER_BANDS * sizeof(Color));
+    assert(view->column);
+    Image blank = GenImageColor(width, ANALYZER_BANDS, BLACK);
+    view->spectrogram = LoadTextureFromImage(blank);
+    UnloadImage(blank);
+
+    // Gridlines at decades and every 24 dB, drawn once.
+    view->grid = LoadRenderTexture(width, height);
+    BeginTextureMode(view->grid);
+    ClearBackground(BLANK);
+    int bars = height / 2;
+    for (float hz = 100.0f; hz < ANALYZER_MAX_HZ; hz *= 10.0f) {
+        int x = (int)(band_position(hz) * width / ANALYZER_BANDS);
+        DrawLine(x, 0, x, height, GRAY);
+        DrawText(hz < 1000.0f ? TextFormat("%.0f", hz) : TextFormat("%.0fk", hz / 1000.0f),
+                 x + 3, bars - 12, 10, DARKGRAY);
+    }
+    for (float db = -24.0f; db > ANALYZER_FLOOR_DB; db -= 24.0f) {
+        int y = (int)((1.0f - db_unit(db)) * bars);
+        DrawLine(0, y, width, y, GRAY);
+        DrawText(TextFormat("%.0f dB", db), 3, y + 2, 10, DARKGRAY);
+    }
+    EndTextureMode();
+    return view;
+}
+
+void SpectrumView_destroy(SpectrumView *view) {
+    if (!view)
+        return;
+    UnloadTexture(view->spectrogram);
+    UnloadRenderTexture(view->grid);
+    free(view->column);
+    free(view);
+}
+
+void SpectrumView_push(SpectrumView *view, const float *db) {
+    // Row 0 is the top, so the highest band goes first.
+    for (int b = 0; b < ANALYZER_BANDS; b++)
+        view->column[ANALYZER_BANDS - 1 - b] = heat(db_unit(db[b]));
+    UpdateTextureRec(view->spectrogram, (Rectangle){(float)view->next, 0, 1, ANALYZER_BANDS},
+                     view->column);
+    view->next = (view->next + 1) % view->width;
+}
+
+void DrawSpectrum(int x, int y, const SpectrumView *view, const float *db, const float *peaks,
+                  float analysis_ms) {
+    int width = view->width, bars = view->height / 2, rows = view->height - bars;
+    DrawRectangle(x, y, width, bars, LIGHTGRAY);
+    float band_width = (float)width / ANALYZER_BANDS;
+    for (int b = 0; b < ANALYZER_BANDS; b++) {
+        int left = x + (int)(b * band_width), right = x + (int)((b + 1) * band_width);
+        int fill = (int)(db_unit(db[b]) * bars);
+        DrawRectangle(left, y + bars - fill, right - left, fill, GREEN);
+        int peak = (int)(db_unit(peaks[b]) * bars);
+        DrawRectangle(left, y + bars - peak, right - left, 2, RED);
+    }
+    // Oldest columns start just after the newest one.
+    float newer = (float)view->next, older = (float)(width - view->next);
+    Rectangle old_part = {newer, 0, older, ANALYZER_BANDS};
+    Rectangle new_part = {0, 0, newer, ANALYZER_BANDS};
+    DrawTexturePro(view->spectrogram, old_part, (Rectangle){x, y + bars, older, rows},
+                   (Vector2){0, 0}, 0.0f, WHITE);
+    DrawTexturePro(view->spectrogram, new_part, (Rectangle){x + older, y + bars, newer, rows},
+                   (Vector2){0, 0}, 0.0f, WHITE);
+    // Render textures come out upside down.
+    DrawTextureRec(view->grid.texture, (Rectangle){0, 0, (float)width, (float)-view->height},
+                   (Vector2){(float)x, (float)y}, WHITE);
+    DrawRectangleLines(x, y, width, view->height, BLACK);
+    DrawText(TextFormat("fft %.3f ms", analysis_ms), x + width - 110, y + 5, 10, DARKGRAY);
+}
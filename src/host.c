@@ -0,0 +1,185 @@
+#define _GNU_SOURCE // pthread_setaffinity_np
+#include "host.h"
+#include "dsp.h"
+#include <assert.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// One block of one engine, as the audio callback does it minus the send effects: an idle
+// engine whose filter has settled costs nothing.
+static void render_engine(HostEngine *engine, int frames) {
+    State *state = engine->state;
+    if (State_active_voices(state) == 0 && Lowpass_settle(&state->lpf, SILENCE_THRESHOLD)) {
+        memset(engine->out, 0, frames * sizeof(float));
+        PatchSlot_exit(&state->patches); // holds no patch, let retired ones go
+        return;
+    }
+    State_render(state, engine->out, frames);
+    Lowpass_process_block(&state->lpf, engine->out, frames);
+}
+
+static void *work(void *arg) {
+    HostWorker *worker = arg;
+    Host *host = worker->host;
+    Dsp_flush_denormals();
+    unsigned long seen = 0;
+    pthread_mutex_lock(&host->mutex);
+    for (;;) {
+        while (host->running && host->generation == seen)
+            pthread_cond_wait(&host->start, &host->mutex);
+        if (!host->running)
+            break;
+        seen = host->generation;
+        int frames = host->frames;
+        pthread_mutex_unlock(&host->mutex);
+
+        for (int i = 0; i < host->max_engines; i++) {
+            HostEngine *engine = &host->engines[i];
+            if (engine->state && engine->worker == worker->index)
+                render_engine(engine, frames);
+        }
+
+        pthread_mutex_lock(&host->mutex);
+        if (++host->finished == host->num_workers)
+            pthread_cond_signal(&host->done);
+    }
+    pthread_mutex_unlock(&host->mutex);
+    return NULL;
+}
+
+static void stop_workers(Host *host, int started) {
+    pthread_mutex_lock(&host->mutex);
+    host->running = 0;
+    pthread_cond_broadcast(&host->start);
+    pthread_mutex_unlock(&host->mutex);
+    for (int i = 0; i < started; i++)
+        pthread_join(host->workers[i].thread, NULL);
+}
+
+Host *Host_create(TablePool *pool, const int *cores, int num_cores, int max_engines) {
+    assert(num_cores > 0 && num_cores <= HOST_MAX_CORES && max_engines > 0);
+    Host *host = calloc(1, sizeof(Host));
+    assert(host);
+    host->pool = pool ? TablePool_retain(pool) : TablePool_create();
+    host->engines = aligned_alloc(_Alignof(HostEngine), max_engines * sizeof(HostEngine));
+    assert(host->engines);
+    memset(host->engines, 0, max_engines * sizeof(HostEngine));
+    host->max_engines = max_engines;
+    host->workers = calloc(num_cores, sizeof(HostWorker));
+    assert(host->workers);
+    host->num_workers = num_cores;
+    pthread_mutex_init(&host->mutex, NULL);
+    pthread_cond_init(&host->start, NULL);
+    pthread_cond_init(&host->done, NULL);
+    host->running = 1;
+
+    for (int i = 0; i < num_cores; i++) {
+        HostWorker *worker = &host->workers[i];
+        worker->host = host;
+        worker->index = i;
+        worker->core = cores ? cores[i] : i;
+        if (pthread_create(&worker->thread, NULL, work, worker) != 0) {
+            fprintf(stderr, "Host: cannot start worker %d\n", i);
+            stop_workers(host, i);
+            host->num_workers = 0;
+            Host_destroy(host);
+            return NULL;
+        }
+        // A CPU outside the process's set (or past the last one) leaves the thread unpinned.
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (worker->core >= 0 && worker->core < CPU_SETSIZE)
+            CPU_SET(worker->core, &set);
+        if (worker->core < 0 || worker->core >= CPU_SETSIZE ||
+            pthread_setaffinity_np(worker->thread, sizeof(set), &set) != 0)
+            worker->core = -1;
+    }
+    return host;
+}
+
+void Host_destroy(Host *host) {
+    if (!host)
+        return;
+    if (host->num_workers > 0)
+        stop_workers(host, host->num_workers);
+    for (int i = 0; i < host->max_engines; i++)
+        State_destroy(host->engines[i].state);
+    pthread_cond_destroy(&host->done);
+    pthread_cond_destroy(&host->start);
+    pthread_mutex_destroy(&host->mutex);
+    TablePool_release(host->pool);
+    free(host->workers);
+    free(host->engines);
+    free(host);
+}
+
+int Host_add(Host *host) {
+    int slot = -1;
+    for (int i = 0; i < host->max_engines && slot < 0; i++) {
+        if (!host->engines[i].state)
+            slot = i;
+    }
+    if (slot < 0)
+        return -1;
+    int least = 0;
+    for (int i = 1; i < host->num_workers; i++) {
+        if (host->workers[i].engines < host->workers[least].engines)
+            least = i;
+    }
+    HostEngine *engine = &host->engines[slot];
+    engine->state = State_create_shared(host->pool);
+    engine->worker = least;
+    memset(engine->out, 0, sizeof(engine->out));
+    host->workers[least].engines++;
+    return slot;
+}
+
+void Host_remove(Host *host, int engine) {
+    if (engine < 0 || engine >= host->max_engines || !host->engines[engine].state)
+        return;
+    State_destroy(host->engines[engine].state);
+    host->engines[engine].state = NULL;
+    host->workers[host->engines[engine].worker].engines--;
+}
+
+State *Host_state(Host *host, int engine) {
+    if (engine < 0 || engine >= host->max_engines)
+        return NULL;
+    return host->engines[engine].state;
+}
+
+const float *Host_output(const Host *host, int engine) {
+    assert(engine >= 0 && engine < host->max_engines);
+    return host->engines[engine].out;
+}
+
+int Host_engines(const Host *host) {
+    int count = 0;
+    for (int i = 0; i < host->num_workers; i++)
+        count += host->workers[i].engines;
+    return count;
+}
+
+void Host_render(Host *host, float *mix, int frames) {
+    assert(frames > 0 && frames <= BLOCK_SIZE);
+    pthread_mutex_lock(&host->mutex);
+    host->frames = frames;
+    host->finished = 0;
+    host->generation++;
+    pthread_cond_broadcast(&host->start);
+    while (host->finished < host->num_workers)
+        pthread_cond_wait(&host->done, &host->mutex);
+    pthread_mutex_unlock(&host->mutex);
+    if (!mix)
+        return;
+    memset(mix, 0, frames * sizeof(float));
+    for (int i = 0; i < host->max_engines; i++) {
+        if (!host->engines[i].state)
+            continue;
+        const float *out = host->engines[i].out;
+        for (int j = 0; j < frames; j++)
+            mix[j] += out[j];
+    }
+}
@@ -0,0 +1,89 @@
+#include "latency.h"
+
+void LatencyManager_init(LatencyManager *lm, double min, double max) {
+    lm->min = min;
+    lm->max = max < min ? min : max;
+    lm->steps = 1;
+    while (lm->steps < LATENCY_MAX_STEPS && min * (1 << lm->steps) <= lm->max)
+        lm->steps++;
+    lm->step = 0;
+    for (int i = 0; i < LATENCY_MAX_STEPS; i++)
+        lm->unsafe_voices[i] = INT_MAX;
+    lm->stable_windows = 0;
+    lm->window_start = -1.0;
+    lm->settling = 1;
+    lm->total_underflows = 0;
+    atomic_init(&lm->underflows, 0);
+    atomic_init(&lm->peak_load, 0.0f);
+}
+
+double LatencyManager_latency(const LatencyManager *lm) {
+    return lm->min * (1 << lm->step);
+}
+
+void LatencyManager_report_underflow(LatencyManager *lm) {
+    atomic_fetch_add(&lm->underflows, 1);
+}
+
+void LatencyManager_report_callback(LatencyManager *lm, double render_seconds,
+                                    double buffer_seconds) {
+    if (buffer_seconds <= 0.0)
+        return;
+    float load = (float)(render_seconds / buffer_seconds);
+    float peak = atomic_load(&lm->peak_load);
+    while (load > peak && !atomic_compare_exchange_weak(&lm->peak_load, &peak, load))
+        ;
+}
+
+// Move to step and start a fresh window; underflows from the reopen itself are ignored.
+static double change_step(LatencyManager *lm, int step, double now) {
+    lm->step = step;
+    lm->stable_windows = 0;
+    lm->window_start = now;
+    lm->settling = 1;
+    atomic_store(&lm->underflows, 0);
+    atomic_store(&lm->peak_load, 0.0f);
+    return LatencyManager_latency(lm);
+}
+
+double LatencyManager_evaluate(LatencyManager *lm, int voices, double now) {
+    if (lm->window_start < 0.0) {
+        lm->window_start = now;
+        return 0.0;
+    }
+    int underflows = atomic_load(&lm->underflows);
+    if (underflows > 0 && !lm->settling) {
+        atomic_fetch_sub(&lm->underflows, underflows);
+        lm->total_underflows += underflows;
+        // This buffer is too small for this many voices; never come back to it with as many.
+        if (voices < lm->unsafe_voices[lm->step])
+            lm->unsafe_voices[lm->step] = voices;
+        if (lm->step + 1 < lm->steps)
+            return change_step(lm, lm->step + 1, now);
+    }
+    if (now - lm->window_start < LATENCY_WINDOW)
+        return 0.0;
+
+    float load = atomic_exchange(&lm->peak_load, 0.0f);
+    lm->window_start = now;
+    if (lm->settling) {
+        lm->settling = 0;
+        atomic_store(&lm->underflows, 0);
+        return 0.0;
+    }
+    if (load > LATENCY_MAX_LOAD && lm->step + 1 < lm->steps)
+        return change_step(lm, lm->step + 1, now);
+    lm->stable_windows = load < LATENCY_SHRINK_LOAD ? lm->stable_windows + 1 : 0;
+    if (lm->stable_windows >= LATENCY_STABLE_WINDOWS && lm->step > 0 &&
+        voices < lm->unsafe_voices[lm->step - 1])
+        return change_step(lm, lm->step - 1, now);
+    return 0.0;
+}
+
+void LatencyManager_reject(LatencyManager *lm, int step, double now) {
+    if (lm->step > step)
+        lm->steps = lm->step;
+    else if (lm->step < step)
+        lm->unsafe_voices[lm->step] = 0;
+    change_step(lm, step, now);
+}
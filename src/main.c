@@ -1,13 +1,22 @@
 #include "config.h"
+#include "analyzer.h"
+#include "audio.h"
+#include "control.h"
 #include "state.h"
 #include "filter.h"
 #include "graphics.h"
+#include "dsp.h"
+#include "recorder.h"
+#include "reload.h"
 #include <math.h>
 #include <pthread.h>
 #include <raylib.h>
-#include <soundio/soundio.h>
+#include <signal.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 static pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
 
@@ -16,46 +25,66 @@ static float previewBuffer[PREVIEW_SIZE] = {0};
 static int previewIndex = 0;
 static pthread_mutex_t preview_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-static void write_callback(struct SoundIoOutStream *outstream, int frame_count_min,
-                           int frame_count_max) {
-    (void)frame_count_min;
-    State *state = (State *)outstream->userdata;
-    int frames_left = frame_count_max;
-    while (frames_left > 0) {
-        int frame_count = frames_left;
-        struct SoundIoChannelArea *areas;
-        int err = soundio_outstream_begin_write(outstream, &areas, &frame_count);
-        if (err) {
-            fprintf(stderr, "begin write error: %s\n", soundio_strerror(err));
-            exit(1);
-        }
-        if (frame_count == 0)
-            break;
-        for (int frame = 0; frame < frame_count; frame++) {
-            float sample = 0.0f;
-            pthread_mutex_lock(&state_mutex);
-            sample = State_mix_sample(state);
-            sample = Lowpass_process(&state->lpf, sample);
-            pthread_mutex_unlock(&state_mutex);
-            // Write sample to the preview buffer (using trylock to minimize blocking)
-            if (pthread_mutex_trylock(&preview_mutex) == 0) {
-                previewBuffer[previewIndex] = sample;
-                previewIndex = (previewIndex + 1) % PREVIEW_SIZE;
-                pthread_mutex_unlock(&preview_mutex);
-            }
-            // Write the same sample to all channels.
-            for (int ch = 0; ch < outstream->layout.channel_count; ch++) {
-                char *ptr = areas[ch].ptr + areas[ch].step * frame;
-                *((float *)ptr) = sample;
-            }
-        }
-        err = soundio_outstream_end_write(outstream);
-        if (err) {
-            fprintf(stderr, "end write error: %s\n", soundio_strerror(err));
-            exit(1);
+// Frames of pure silence written since the engine last rendered anything; lets the UI stop
+// redrawing once the preview has gone flat.
+static atomic_long silent_frames = 0;
+
+// Master output recorder; its ring holds about 20 s in case the disk stalls.
+#define RECORDER_CAPACITY (1 << 20)
+static Recorder *recorder = NULL;
+
+// Spectrum of the same fold-down, analysed off the audio thread while the view is shown.
+static Analyzer *analyzer = NULL;
+
+// Commands from the OSC endpoint, applied by the audio thread at the top of each block.
+static CommandQueue commands;
+
+// Cleared by SIGINT/SIGTERM when running without a window.
+static volatile sig_atomic_t headless_running = 1;
+
+// Render one block of stereo output; the audio backend calls this from its own thread.
+static void render(void *userdata, float *left, float *right, int block) {
+    State *state = userdata;
+    Dsp_flush_denormals();
+    float samples[BLOCK_SIZE];
+    pthread_mutex_lock(&state_mutex);
+    CommandQueue_apply(&commands, state);
+    // With no voices the output is just the filter's and the effects' tails; once those have
+    // decayed, skip the engine and emit zeros.
+    int idle = State_active_voices(state) == 0 && Lowpass_settle(&state->lpf, SILENCE_THRESHOLD);
+    if (idle) {
+        memset(samples, 0, block * sizeof(float));
+        PatchSlot_exit(&state->patches); // holds no patch, let retired ones go
+    } else {
+        State_render(state, samples, block);
+        Lowpass_process_block(&state->lpf, samples, block);
+    }
+    int silent = idle && Effects_settled(state->effects);
+    if (!silent)
+        Effects_process(state->effects, samples, left, right, block);
+    pthread_mutex_unlock(&state_mutex);
+    if (silent) {
+        memset(left, 0, block * sizeof(float));
+        memset(right, 0, block * sizeof(float));
+    }
+    // Record both channels before folding down and before dithering for the device.
+    Recorder_write(recorder, left, right, block);
+    // The preview and the analyzer take the mono fold-down.
+    for (int i = 0; i < block; i++)
+        samples[i] = 0.5f * (left[i] + right[i]);
+    if (silent)
+        atomic_fetch_add(&silent_frames, block);
+    else
+        atomic_store(&silent_frames, 0);
+    // Write samples to the preview buffer (using trylock to minimize blocking)
+    if (pthread_mutex_trylock(&preview_mutex) == 0) {
+        for (int i = 0; i < block; i++) {
+            previewBuffer[previewIndex] = samples[i];
+            previewIndex = (previewIndex + 1) % PREVIEW_SIZE;
         }
-        frames_left -= frame_count;
+        pthread_mutex_unlock(&preview_mutex);
     }
+    Analyzer_write(analyzer, samples, block);
 }
 
 // --- Key Mapping for one octave ---
@@ -106,7 +135,100 @@ const NoteMapping black_keys[NUM_BLACK_KEYS] = {
 // Active voice mapping for each note key (-1 indicates no active voice).
 int active_voice[NUM_NOTE_KEYS];
 
-int main(void) {
+// Harmonics shown and editable when the SIN slot is in spectral mode.
+#define EDIT_HARMONICS 16
+
+// Number key pairs lower/raise each wavetable level: 1/2 SIN, 3/4 SAW, 5/6 SQR, 7/8 TRI.
+#define NUM_LEVEL_KEYS 4
+const int level_keys[NUM_LEVEL_KEYS][2] = {
+    {KEY_ONE, KEY_TWO}, {KEY_THREE, KEY_FOUR}, {KEY_FIVE, KEY_SIX}, {KEY_SEVEN, KEY_EIGHT}};
+const char *wt_labels[NUM_LEVEL_KEYS] = {"SIN", "SAW", "SQR", "TRI"};
+
+// Cursor speed in shape units per second when moved with the arrow keys.
+#define CURSOR_SPEED 1.0f
+
+// F1..F5 recall presets; presets are built once at startup and recalled as clones.
+#define MAX_PRESETS 5
+const int preset_keys[MAX_PRESETS] = {KEY_F1, KEY_F2, KEY_F3, KEY_F4, KEY_F5};
+
+// Copy-on-write edit of the playing patch; never blocks the audio thread.
+static void edit_patch(PatchSlot *slot, int level_slot, float level_delta, float cutoff_scale,
+                       float q_delta) {
+    Patch *patch = Patch_clone(PatchSlot_current(slot));
+    if (level_slot >= 0)
+        Patch_set_level(patch, level_slot, patch->levels[level_slot] + level_delta);
+    else
+        Patch_set_filter(patch, clamp_SR(patch->cutoff * cutoff_scale),
+                         clamp_unit(patch->q + q_delta) + 0.01f);
+    PatchSlot_publish(slot, patch);
+}
+
+static void stop_headless(int sig) {
+    (void)sig;
+    headless_running = 0;
+}
+
+// No window: the engine is driven over OSC until interrupted.
+static void run_headless(AudioOutput *audio, State *state) {
+    signal(SIGINT, stop_headless);
+    signal(SIGTERM, stop_headless);
+    while (headless_running) {
+        struct timespec pause = {0, 10 * 1000 * 1000};
+        nanosleep(&pause, NULL);
+        pthread_mutex_lock(&state_mutex);
+        int voices = State_active_voices(state);
+        pthread_mutex_unlock(&state_mutex);
+        if (AudioOutput_tune(audio, voices) < 0)
+            break; // no output left to drive
+        PatchSlot_reclaim(&state->patches);
+    }
+    // What a soak test on the null clock looks for.
+    printf("%lu callbacks, %lu xruns, %.1f ms buffer, wake-ups up to %.3f ms late\n",
+           atomic_load(&audio->callbacks), atomic_load(&audio->xruns),
+           AudioOutput_latency(audio) * 1000.0, atomic_load(&audio->max_late_ms));
+}
+
+static void usage(const char *program) {
+    fprintf(stderr,
+            "usage: %s [--headless] [--osc-port PORT | --no-osc] [--backend soundio|jack|null] "
+            "[--period MS] [--mixer]\n",
+            program);
+}
+
+int main(int argc, char **argv) {
+    int headless = 0;
+    int start_mixer = 0; // attach the geometric mixer at startup, e.g. for /wave/cursor headless
+    int osc_port = CONTROL_DEFAULT_PORT; // -1 leaves the control server off
+    // The null clock tries for SCHED_FIFO so soak tests see the scheduling a device would get.
+    AudioConfig audio_config = {.type = AUDIO_BACKEND_SOUNDIO, .realtime = 1};
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            headless = 1;
+        } else if (strcmp(argv[i], "--osc-port") == 0 && i + 1 < argc) {
+            osc_port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--no-osc") == 0) {
+            osc_port = -1;
+        } else if (strcmp(argv[i], "--backend") == 0 && i + 1 < argc &&
+                   Audio_backend_parse(argv[i + 1]) >= 0) {
+            audio_config.type = (AudioBackendType)Audio_backend_parse(argv[++i]);
+        } else if (strcmp(argv[i], "--period") == 0 && i + 1 < argc) {
+            audio_config.period = atof(argv[++i]) / 1000.0;
+        } else if (strcmp(argv[i], "--mixer") == 0) {
+            start_mixer = 1;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (headless && osc_port < 0) {
+        usage(argv[0]); // headless, OSC is the only way in
+        return 1;
+    }
+
+    // Pick DSP kernels for this CPU before the audio thread starts.
+    Dsp_init();
+    printf("Using DSP kernels: %s\n", Dsp_get()->name);
+
     // Initialize synth state.
     State *state = State_create();
     for (int i = 0; i < NUM_NOTE_KEYS; i++) {
@@ -115,70 +237,63 @@ int main(void) {
     // Base frequency for C3.
     const double base_freq = 130.81;
     const double semitone_ratio = pow(2.0, 1.0 / 12.0);
+    SpectralTable *spectral = NULL; // spectral editor for the SIN slot, NULL when off
+    Mixer *mixer = NULL;            // geometric mixer, NULL when mixing with wt_levels
+    if (start_mixer) {
+        // The audio thread is not running yet, so no lock is needed.
+        mixer = Mixer_create(MixerShape_polygon(NUM_WAVETABLES), TABLE_SIZE);
+        State_set_mixer(state, mixer);
+    }
+    int selected_harmonic = 1;
+    Patch *presets[MAX_PRESETS];
+    int num_presets = Patch_preset_count() < MAX_PRESETS ? Patch_preset_count() : MAX_PRESETS;
+    for (int i = 0; i < num_presets; i++)
+        presets[i] = Patch_preset(i);
+    Patch *compare = NULL; // the other side of the A/B comparison, NULL for live settings
 
-    // Initialize SoundIo.
+    recorder = Recorder_create(RECORDER_CAPACITY);
+    analyzer = Analyzer_create();
+    SpectrumView *spectrum = NULL; // built with the first spectrum shown, then kept
 
-    struct SoundIo *soundio = soundio_create();
-    if (!soundio) {
-        fprintf(stderr, "Out of memory.\n");
-        return 1;
-    }
-    int err = soundio_connect(soundio);
-    if (err) {
-        fprintf(stderr, "Error connecting: %s\n", soundio_strerror(err));
+    // Pick up new versions of the trumpet table as they are written, without a restart.
+    Reloader *reloader = Reloader_create(state, ".");
+    Reloader_watch(reloader, WAVEFORM_TRIANGLE, "Trumpet.bin");
+    if (Reloader_start(reloader) != 0)
+        fprintf(stderr, "Wavetable hot reload unavailable\n");
+
+    // Start audio; the stream begins at a small buffer and grows only if it underflows.
+    CommandQueue_init(&commands);
+    AudioOutput audio;
+    if (AudioOutput_open(&audio, &audio_config, render, state) != 0)
         return 1;
-    }
-    soundio_flush_events(soundio);
-    int default_out_device_index = soundio_default_output_device_index(soundio);
-    if (default_out_device_index < 0) {
-        fprintf(stderr, "No output device found.\n");
+    ControlServer *control = osc_port >= 0 ? ControlServer_start(&commands, osc_port) : NULL;
+    if (control)
+        printf("OSC control on 127.0.0.1:%d\n", ControlServer_port(control));
+    else if (headless) {
+        AudioOutput_close(&audio);
         return 1;
     }
-    struct SoundIoDevice *device = soundio_get_output_device(soundio, default_out_device_index);
-    if (!device) {
-        fprintf(stderr, "Unable to get output device.\n");
-        return 1;
-    }
-    printf("Using output device: %s\n", device->name);
-
-    // Create and configure output stream.
-    struct SoundIoOutStream *outstream = soundio_outstream_create(device);
-    outstream->format = SoundIoFormatFloat32NE;
-    outstream->sample_rate = SAMPLE_RATE;
-    if (device->layout_count > 0) {
-        int found = 0;
-        for (int i = 0; i < device->layout_count; i++) {
-            if (device->layouts[i].channel_count == 2) {
-                outstream->layout = device->layouts[i];
-                found = 1;
-                break;
-            }
-        }
-        if (!found)
-            outstream->layout = device->layouts[0];
+
+    if (headless) {
+        run_headless(&audio, state);
     } else {
-        outstream->layout = *soundio_channel_layout_get_default(2);
-    }
-    outstream->userdata = state;
-    outstream->write_callback = write_callback;
-    err = soundio_outstream_open(outstream);
-    if (err) {
-        fprintf(stderr, "Error opening stream: %s\n", soundio_strerror(err));
-        return 1;
-    }
-    if (outstream->layout_error)
-        fprintf(stderr, "Channel layout error: %s\n", soundio_strerror(outstream->layout_error));
-    err = soundio_outstream_start(outstream);
-    if (err) {
-        fprintf(stderr, "Error starting stream: %s\n", soundio_strerror(err));
-        return 1;
+        InitWindow(640, 480, "wave");
+        SetTargetFPS(60);
     }
 
-    // Initialize Raylib window.
-    InitWindow(640, 480, "wave");
-    SetTargetFPS(60);
+    while (!headless && !WindowShouldClose()) {
+        // Poll at full rate while sound is playing or a held key drives the UI; otherwise
+        // sleep in EndDrawing until the next input event. OSC messages are not window events
+        // and could start sound nothing would wake us for, so only --no-osc lets the UI sleep.
+        int held = IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_RIGHT) || IsKeyDown(KEY_UP) ||
+                   IsKeyDown(KEY_DOWN);
+        if (!control && atomic_load(&silent_frames) >= PREVIEW_SIZE && !held &&
+            !Recorder_is_recording(recorder))
+            EnableEventWaiting();
+        else
+            DisableEventWaiting();
 
-    while (!WindowShouldClose()) {
+        const Patch *patch = PatchSlot_current(&state->patches);
         pthread_mutex_lock(&state_mutex);
         {
             // Process white keys.
@@ -212,77 +327,229 @@ int main(void) {
                     }
                 }
             }
-            // Process wavetable level adjustments.
-            if (IsKeyPressed(KEY_ONE))
-                state->wt_levels[0] -= 0.1f;
-            if (IsKeyPressed(KEY_TWO))
-                state->wt_levels[0] += 0.1f;
-            if (IsKeyPressed(KEY_THREE))
-                state->wt_levels[1] -= 0.1f;
-            if (IsKeyPressed(KEY_FOUR))
-                state->wt_levels[1] += 0.1f;
-            if (IsKeyPressed(KEY_FIVE))
-                state->wt_levels[2] -= 0.1f;
-            if (IsKeyPressed(KEY_SIX))
-                state->wt_levels[2] += 0.1f;
-            if (IsKeyPressed(KEY_SEVEN))
-                state->wt_levels[3] -= 0.1f;
-            if (IsKeyPressed(KEY_EIGHT))
-                state->wt_levels[3] += 0.1f;
-            if (IsKeyPressed(KEY_MINUS)) {
+            // Process wavetable level adjustments (a playing patch is edited below instead).
+            for (int i = 0; i < NUM_WAVETABLES && i < NUM_LEVEL_KEYS && !patch; i++) {
+                if (IsKeyPressed(level_keys[i][0]))
+                    state->wt_levels[i] -= 0.1f;
+                if (IsKeyPressed(level_keys[i][1]))
+                    state->wt_levels[i] += 0.1f;
+            }
+            // Arrow keys move the geometric mixer's cursor.
+            if (mixer) {
+                float step = CURSOR_SPEED * GetFrameTime();
+                float cursor[MIXER_MAX_DIMS];
+                memcpy(cursor, mixer->cursor, sizeof(cursor));
+                cursor[0] += step * (IsKeyDown(KEY_RIGHT) - IsKeyDown(KEY_LEFT));
+                cursor[1] += step * (IsKeyDown(KEY_UP) - IsKeyDown(KEY_DOWN));
+                Mixer_set_cursor(mixer, cursor);
+            }
+            if (IsKeyPressed(KEY_MINUS) && !patch) {
                 printf("-: %f\n", state->lpf.cutoff);
                 Lowpass_set_cutoff(&state->lpf, clamp_SR(state->lpf.cutoff * 0.9));
             }
-            if (IsKeyPressed(KEY_EQUAL)) {
+            if (IsKeyPressed(KEY_EQUAL) && !patch) {
                 printf("=: %f\n", state->lpf.cutoff);
                 Lowpass_set_cutoff(&state->lpf, clamp_SR(state->lpf.cutoff * 1.1));
             }
-            if (IsKeyPressed(KEY_LEFT_BRACKET)) {
+            if (IsKeyPressed(KEY_LEFT_BRACKET) && !patch) {
                 printf("[: %f\n", state->lpf.q);
                 Lowpass_set_q(&state->lpf, clamp_unit(state->lpf.q - 0.1)+ 0.01);
             }
-            if (IsKeyPressed(KEY_RIGHT_BRACKET)) {
+            if (IsKeyPressed(KEY_RIGHT_BRACKET) && !patch) {
                 printf("]: %f\n", state->lpf.q);
                 Lowpass_set_q(&state->lpf, clamp_unit(state->lpf.q + 0.1) + 0.01);
             }
+            // K and L step the delay and reverb sends through off, 0.25 and 0.5.
+            Effects *fx = state->effects;
+            if (IsKeyPressed(KEY_K)) {
+                float send = fx->delay_send >= 0.5f ? 0.0f : fx->delay_send + 0.25f;
+                Effects_set_delay(fx, send, (float)(fx->echo_target / SAMPLE_RATE),
+                                  fx->echo_feedback);
+            }
+            if (IsKeyPressed(KEY_L)) {
+                float send = fx->reverb_send >= 0.5f ? 0.0f : fx->reverb_send + 0.25f;
+                Effects_set_reverb(fx, send, fx->decay, fx->damping);
+            }
             // Clamp levels to [0.0, 1.0]
-            state->wt_levels[0] = fmaxf(0.0f, fminf(state->wt_levels[0], 1.0f));
-            state->wt_levels[1] = fmaxf(0.0f, fminf(state->wt_levels[1], 1.0f));
-            state->wt_levels[2] = fmaxf(0.0f, fminf(state->wt_levels[2], 1.0f));
-            state->wt_levels[3] = fmaxf(0.0f, fminf(state->wt_levels[3], 1.0f));
+            for (int i = 0; i < NUM_WAVETABLES; i++)
+                state->wt_levels[i] = fmaxf(0.0f, fminf(state->wt_levels[i], 1.0f));
         }
+        int voices = State_active_voices(state);
         pthread_mutex_unlock(&state_mutex);
+        // Reopening the stream joins the audio thread, so this runs outside state_mutex.
+        AudioOutput_tune(&audio, voices);
+
+        // --- Patches ---
+        // F1..F5 recall a preset, 0 returns to the live settings and P swaps with the previous
+        // patch for A/B comparison. Patches are published with an atomic swap, not state_mutex.
+        int recall = -1;
+        for (int i = 0; i < num_presets; i++) {
+            if (IsKeyPressed(preset_keys[i]))
+                recall = i;
+        }
+        if (recall >= 0 || (IsKeyPressed(KEY_ZERO) && patch) || IsKeyPressed(KEY_P)) {
+            Patch *next = recall >= 0 ? Patch_clone(presets[recall]) : NULL;
+            if (IsKeyPressed(KEY_P)) {
+                next = compare;
+                compare = NULL;
+            }
+            Patch_destroy(compare);
+            compare = patch ? Patch_clone(patch) : NULL;
+            PatchSlot_publish(&state->patches, next);
+            patch = next;
+        }
+        if (patch) {
+            for (int i = 0; i < NUM_WAVETABLES && i < NUM_LEVEL_KEYS; i++) {
+                if (IsKeyPressed(level_keys[i][0]))
+                    edit_patch(&state->patches, i, -0.1f, 1.0f, 0.0f);
+                if (IsKeyPressed(level_keys[i][1]))
+                    edit_patch(&state->patches, i, 0.1f, 1.0f, 0.0f);
+            }
+            if (IsKeyPressed(KEY_MINUS))
+                edit_patch(&state->patches, -1, 0.0f, 0.9f, 0.0f);
+            if (IsKeyPressed(KEY_EQUAL))
+                edit_patch(&state->patches, -1, 0.0f, 1.1f, 0.0f);
+            if (IsKeyPressed(KEY_LEFT_BRACKET))
+                edit_patch(&state->patches, -1, 0.0f, 1.0f, -0.1f);
+            if (IsKeyPressed(KEY_RIGHT_BRACKET))
+                edit_patch(&state->patches, -1, 0.0f, 1.0f, 0.1f);
+            patch = PatchSlot_current(&state->patches);
+        }
+        // I steps the interpolation quality of whatever is playing: the patch by copy-on-write,
+        // the live settings under state_mutex.
+        if (IsKeyPressed(KEY_I)) {
+            if (patch) {
+                Patch *edit = Patch_clone(patch);
+                Patch_set_interp(edit, (patch->interp + 1) % DSP_INTERP_COUNT);
+                PatchSlot_publish(&state->patches, edit);
+                patch = edit;
+            } else {
+                pthread_mutex_lock(&state_mutex);
+                state->interp = (state->interp + 1) % DSP_INTERP_COUNT;
+                pthread_mutex_unlock(&state_mutex);
+            }
+        }
+        PatchSlot_reclaim(&state->patches);
+
+        // --- Spectral editing of the SIN slot ---
+        // Z toggles it, X/C select a harmonic, V/B lower/raise its magnitude. Tables are built
+        // and swapped in by the spectral worker, never under state_mutex.
+        if (IsKeyPressed(KEY_Z)) {
+            if (!spectral) {
+                spectral = SpectralTable_create(TABLE_SIZE, SPECTRAL_MAX_MIPS);
+                SpectralTable_analyze(spectral, &state->wts[WAVEFORM_SINE]);
+                SpectralTable_flush(spectral);
+                pthread_mutex_lock(&state_mutex);
+                State_set_spectral(state, WAVEFORM_SINE, spectral);
+                pthread_mutex_unlock(&state_mutex);
+            } else {
+                pthread_mutex_lock(&state_mutex);
+                State_set_spectral(state, WAVEFORM_SINE, NULL);
+                pthread_mutex_unlock(&state_mutex);
+                SpectralTable_destroy(spectral);
+                spectral = NULL;
+            }
+        }
+        // --- Recording ---
+        // R starts a new WAV in the working directory or finishes the current one.
+        if (IsKeyPressed(KEY_R)) {
+            if (Recorder_is_recording(recorder)) {
+                Recorder_stop(recorder);
+                printf("Recorded %.1f s (%lu samples dropped)\n", Recorder_seconds(recorder),
+                       Recorder_overruns(recorder));
+            } else {
+                char filename[64];
+                time_t now = time(NULL);
+                strftime(filename, sizeof(filename), "wave-%Y%m%d-%H%M%S.wav", localtime(&now));
+                if (Recorder_start(recorder, filename, RECORDER_WAV) == 0)
+                    printf("Recording to %s\n", filename);
+                else
+                    fprintf(stderr, "Cannot record to %s\n", filename);
+            }
+        }
+        // --- Spectrum ---
+        // Tab swaps the oscilloscope for the spectrum and spectrogram; the analyzer only runs
+        // while they are shown.
+        if (IsKeyPressed(KEY_TAB)) {
+            if (Analyzer_running(analyzer))
+                Analyzer_stop(analyzer);
+            else if (Analyzer_start(analyzer) != 0)
+                fprintf(stderr, "Cannot start the spectrum analyzer\n");
+        }
+        // --- Geometric mixer ---
+        // M switches between wt_levels and a polygon with one face per wavetable.
+        if (IsKeyPressed(KEY_M)) {
+            if (!mixer) {
+                mixer = Mixer_create(MixerShape_polygon(NUM_WAVETABLES), TABLE_SIZE);
+                pthread_mutex_lock(&state_mutex);
+                State_set_mixer(state, mixer);
+                pthread_mutex_unlock(&state_mutex);
+            } else {
+                pthread_mutex_lock(&state_mutex);
+                State_set_mixer(state, NULL);
+                pthread_mutex_unlock(&state_mutex);
+                Mixer_destroy(mixer);
+                mixer = NULL;
+            }
+        }
+
+        float harmonics[EDIT_HARMONICS];
+        if (spectral) {
+            if (IsKeyPressed(KEY_X) && selected_harmonic > 1)
+                selected_harmonic--;
+            if (IsKeyPressed(KEY_C) && selected_harmonic < EDIT_HARMONICS)
+                selected_harmonic++;
+            if (IsKeyPressed(KEY_V) || IsKeyPressed(KEY_B)) {
+                float magnitude = SpectralTable_get_magnitude(spectral, selected_harmonic);
+                magnitude = clamp_unit(magnitude + (IsKeyPressed(KEY_B) ? 0.1f : -0.1f));
+                SpectralTable_set_harmonic(spectral, selected_harmonic, magnitude,
+                                           SpectralTable_get_phase(spectral, selected_harmonic));
+            }
+            for (int h = 0; h < EDIT_HARMONICS; h++)
+                harmonics[h] = SpectralTable_get_magnitude(spectral, h + 1);
+        }
 
         BeginDrawing();
         ClearBackground(RAYWHITE);
 
-        // --- Draw oscilloscope preview ---
+        // --- Draw oscilloscope preview, or the spectrum when Tab has it on ---
         const int preview_x = 10;
         const int preview_y = 10;
         const int preview_width = GetScreenWidth() - 20;
         const int preview_height = 300;
-        // Draw preview background and border.
-        DrawRectangle(preview_x, preview_y, preview_width, preview_height, LIGHTGRAY);
-        DrawRectangleLines(preview_x, preview_y, preview_width, preview_height, BLACK);
-        // Copy previewBuffer into a local array.
-        float localPreview[PREVIEW_SIZE];
-        pthread_mutex_lock(&preview_mutex);
-        int start = previewIndex; // oldest sample is here
-        for (int i = 0; i < PREVIEW_SIZE; i++) {
-            localPreview[i] = previewBuffer[(start + i) % PREVIEW_SIZE];
-        }
-        pthread_mutex_unlock(&preview_mutex);
-        // Create an array of points for drawing the waveform.
-        Vector2 points[PREVIEW_SIZE];
-        for (int i = 0; i < PREVIEW_SIZE; i++) {
-            float x = preview_x + ((float)i / (PREVIEW_SIZE - 1)) * preview_width;
-            // Scale factor: assume maximum amplitude is roughly 5.0 (the gain factor)
-            float scale = preview_height / 10.0f;
-            float y = preview_y + preview_height / 2 - localPreview[i] * scale;
-            points[i] = (Vector2){x, y};
-        }
-        for (int i = 0; i < PREVIEW_SIZE - 1; i++) {
-            DrawLineEx(points[i], points[i + 1], 3.0f, RED);
+        if (Analyzer_running(analyzer)) {
+            if (!spectrum)
+                spectrum = SpectrumView_create(preview_width, preview_height);
+            // One new column per frame at most, so the spectrogram scrolls at the frame rate.
+            float bands[ANALYZER_BANDS], peaks[ANALYZER_BANDS];
+            if (Analyzer_read(analyzer, bands, peaks) > 0)
+                SpectrumView_push(spectrum, bands);
+            DrawSpectrum(preview_x, preview_y, spectrum, bands, peaks,
+                         Analyzer_last_analysis_ms(analyzer));
+        } else {
+            // Draw preview background and border.
+            DrawRectangle(preview_x, preview_y, preview_width, preview_height, LIGHTGRAY);
+            DrawRectangleLines(preview_x, preview_y, preview_width, preview_height, BLACK);
+            // Copy previewBuffer into a local array.
+            float localPreview[PREVIEW_SIZE];
+            pthread_mutex_lock(&preview_mutex);
+            int start = previewIndex; // oldest sample is here
+            for (int i = 0; i < PREVIEW_SIZE; i++) {
+                localPreview[i] = previewBuffer[(start + i) % PREVIEW_SIZE];
+            }
+            pthread_mutex_unlock(&preview_mutex);
+            // Create an array of points for drawing the waveform.
+            Vector2 points[PREVIEW_SIZE];
+            for (int i = 0; i < PREVIEW_SIZE; i++) {
+                float x = preview_x + ((float)i / (PREVIEW_SIZE - 1)) * preview_width;
+                // Scale factor: assume maximum amplitude is roughly 5.0 (the gain factor)
+                float scale = preview_height / 10.0f;
+                float y = preview_y + preview_height / 2 - localPreview[i] * scale;
+                points[i] = (Vector2){x, y};
+            }
+            for (int i = 0; i < PREVIEW_SIZE - 1; i++) {
+                DrawLineEx(points[i], points[i + 1], 3.0f, RED);
+            }
         }
 
         // --- Draw wavetable level bars and labels ---
@@ -292,25 +559,67 @@ int main(void) {
         int bar_x = 10;
         int bar_y = GetScreenHeight() - bar_height - 20;
         
-        DrawSlider(bar_x, bar_y, bar_width, bar_height, state->wt_levels[0], "SIN");
-        bar_x += bar_width + bar_spacing;
-        DrawSlider(bar_x, bar_y, bar_width, bar_height, state->wt_levels[1], "SAW");
+        for (int i = 0; i < NUM_WAVETABLES && i < NUM_LEVEL_KEYS; i++) {
+            // With the mixer on, the sliders show each face's gain instead.
+            float level = mixer   ? mixer->gains[i]
+                          : patch ? patch->levels[i]
+                                  : state->wt_levels[i];
+            DrawSlider(bar_x, bar_y, bar_width, bar_height, level, wt_labels[i]);
+            bar_x += bar_width + bar_spacing;
+        }
+        float cutoff = patch ? patch->cutoff : state->lpf.cutoff;
+        float q = patch ? patch->q : state->lpf.q;
+        DrawSlider(bar_x, bar_y, bar_width, bar_height, scale_unit(cutoff, 20.0f, 20000.0f),
+                   "FREQ");
         bar_x += bar_width + bar_spacing;
-        DrawSlider(bar_x, bar_y, bar_width, bar_height, state->wt_levels[2], "SQR");
+        DrawSlider(bar_x, bar_y, bar_width, bar_height, scale_unit(q, 0.0f, 1.0f), "Q");
         bar_x += bar_width + bar_spacing;
-        DrawSlider(bar_x, bar_y, bar_width, bar_height, state->wt_levels[3], "TRI");
+        DrawSlider(bar_x, bar_y, bar_width, bar_height, state->effects->delay_send, "DLY");
         bar_x += bar_width + bar_spacing;
-        DrawSlider(bar_x, bar_y, bar_width, bar_height, scale_unit(state->lpf.cutoff, 20.0f, 20000.0f), "FREQ");
+        DrawSlider(bar_x, bar_y, bar_width, bar_height, state->effects->reverb_send, "REV");
         bar_x += bar_width + bar_spacing;
-        DrawSlider(bar_x, bar_y, bar_width, bar_height, scale_unit(state->lpf.q, 0.0f, 1.0f), "Q");
+        DrawText(TextFormat("latency %.1f ms  underflows %d", AudioOutput_latency(&audio) * 1000.0,
+                            audio.latency.total_underflows),
+                 preview_x, preview_y + preview_height + 5, 20, DARKGRAY);
+        if (Recorder_is_recording(recorder)) {
+            DrawText(TextFormat("REC %.1f s  dropped %lu", Recorder_seconds(recorder),
+                                Recorder_overruns(recorder)),
+                     preview_x + preview_width / 2, preview_y + preview_height + 5, 20, RED);
+        }
+        DrawText(TextFormat("patch: %s%s  interp: %s (I)", patch ? patch->name : "live",
+                            compare || patch ? "  (P: A/B)" : "",
+                            Dsp_interp_name(patch ? patch->interp : state->interp)),
+                 preview_x, preview_y + preview_height + 30, 20, DARKGRAY);
+        if (control) {
+            DrawText(TextFormat("osc %.2f ms (max %.2f)", atomic_load(&commands.last_latency_ms),
+                                atomic_load(&commands.max_latency_ms)),
+                     preview_x + preview_width / 2, preview_y + preview_height + 30, 20, DARKGRAY);
+        }
+        if (mixer) {
+            const int mixer_size = 120;
+            DrawMixer(preview_x + preview_width - mixer_size - 10, preview_y + 10, mixer_size,
+                      mixer->shape, mixer->cursor);
+        }
+        if (spectral) {
+            DrawHarmonics(bar_x, bar_y, GetScreenWidth() - bar_x - 10, bar_height, harmonics,
+                          EDIT_HARMONICS, selected_harmonic - 1,
+                          SpectralTable_last_rebuild_ms(spectral));
+        }
 
         EndDrawing();
     }
 
-    CloseWindow();
-    soundio_outstream_destroy(outstream);
-    soundio_device_unref(device);
-    soundio_destroy(soundio);
+    SpectrumView_destroy(spectrum);
+    if (!headless)
+        CloseWindow();
+    ControlServer_stop(control);
+    AudioOutput_close(&audio);
+    Recorder_destroy(recorder);
+    Analyzer_destroy(analyzer);
+    Reloader_destroy(reloader);
+    Patch_destroy(compare);
+    for (int i = 0; i < num_presets; i++)
+        Patch_destroy(presets[i]);
     State_destroy(state);
     return 0;
 }
@@ -0,0 +1,199 @@
+#include "mixer.h"
+#include "config.h"
+#include "dsp.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MIXER_SMOOTHING_MS 20.0f
+// Gains closer than this to their target are snapped and stop triggering rebuilds.
+#define MIXER_EPSILON 1e-4f
+
+static MixerShape *shape_alloc(int dims, int faces) {
+    assert(dims > 0 && dims <= MIXER_MAX_DIMS);
+    assert(faces > 0 && faces <= MIXER_MAX_FACES);
+    MixerShape *shape = malloc(sizeof(MixerShape));
+    assert(shape);
+    shape->dims = dims;
+    shape->faces = faces;
+    shape->normals = calloc((size_t)dims * faces, sizeof(float));
+    shape->offsets = malloc(faces * sizeof(float));
+    shape->spans = malloc(faces * sizeof(float));
+    assert(shape->normals && shape->offsets && shape->spans);
+    return shape;
+}
+
+MixerShape *MixerShape_polygon(int faces) {
+    assert(faces >= 3);
+    MixerShape *shape = shape_alloc(2, faces);
+    // With inradius 1 the vertices sit at 1 / cos(pi / n); an odd polygon has a vertex
+    // opposite each edge, an even one a parallel edge.
+    float circumradius = 1.0f / cosf((float)M_PI / faces);
+    float span = faces % 2 ? 1.0f + circumradius : 2.0f;
+    for (int f = 0; f < faces; f++) {
+        float angle = 2.0f * (float)M_PI * f / faces;
+        shape->normals[0 * faces + f] = cosf(angle);
+        shape->normals[1 * faces + f] = sinf(angle);
+        shape->offsets[f] = 1.0f;
+        shape->spans[f] = span;
+    }
+    return shape;
+}
+
+MixerShape *MixerShape_hypercube(int dims) {
+    MixerShape *shape = shape_alloc(dims, 2 * dims);
+    int faces = shape->faces;
+    for (int d = 0; d < dims; d++) {
+        shape->normals[d * faces + 2 * d] = 1.0f;
+        shape->normals[d * faces + 2 * d + 1] = -1.0f;
+    }
+    for (int f = 0; f < faces; f++) {
+        shape->offsets[f] = 1.0f;
+        shape->spans[f] = 2.0f;
+    }
+    return shape;
+}
+
+void MixerShape_destroy(MixerShape *shape) {
+    if (!shape)
+        return;
+    free(shape->normals);
+    free(shape->offsets);
+    free(shape->spans);
+    free(shape);
+}
+
+void Mixer_compute_gains(const MixerShape *shape, const float *position, float *gains) {
+    const DspKernels *dsp = Dsp_get();
+    int faces = shape->faces;
+    // distance_f = offset_f - normal_f . x, accumulated one dimension at a time across faces.
+    memcpy(gains, shape->offsets, faces * sizeof(float));
+    for (int d = 0; d < shape->dims; d++)
+        dsp->mix_add(gains, shape->normals + d * faces, -position[d], faces);
+    float sum = 0.0f;
+    for (int f = 0; f < faces; f++) {
+        float g = 1.0f - gains[f] / shape->spans[f];
+        g = g < 0.0f ? 0.0f : (g > 1.0f ? 1.0f : g);
+        gains[f] = g;
+        sum += g;
+    }
+    for (int f = 0; f < faces; f++)
+        gains[f] = sum > 0.0f ? gains[f] / sum : 1.0f / faces;
+}
+
+Mixer *Mixer_create(MixerShape *shape, size_t length) {
+    assert(shape && length > 0);
+    Mixer *mixer = malloc(sizeof(Mixer));
+    assert(mixer);
+    mixer->shape = shape;
+    mixer->length = length;
+    memset(mixer->cursor, 0, sizeof(mixer->cursor));
+    mixer->target = malloc(shape->faces * sizeof(float));
+    mixer->gains = malloc(shape->faces * sizeof(float));
+    mixer->premix = calloc(length, sizeof(float));
+    mixer->previous = calloc(length, sizeof(float));
+    mixer->faces = calloc(shape->faces, sizeof(float *));
+    mixer->sources = calloc(shape->faces, sizeof(float *));
+    assert(mixer->target && mixer->gains && mixer->premix && mixer->previous && mixer->faces &&
+           mixer->sources);
+    Mixer_compute_gains(shape, mixer->cursor, mixer->target);
+    memcpy(mixer->gains, mixer->target, shape->faces * sizeof(float));
+    mixer->fade = MIXER_FADE_FRAMES;
+    mixer->built = 0;
+    return mixer;
+}
+
+void Mixer_destroy(Mixer *mixer) {
+    if (!mixer)
+        return;
+    for (int f = 0; f < mixer->shape->faces; f++)
+        free(mixer->faces[f]);
+    free(mixer->faces);
+    free(mixer->sources);
+    MixerShape_destroy(mixer->shape);
+    free(mixer->target);
+    free(mixer->gains);
+    free(mixer->premix);
+    free(mixer->previous);
+    free(mixer);
+}
+
+void Mixer_set_face(Mixer *mixer, int face, const float *table) {
+    if (face < 0 || face >= mixer->shape->faces)
+        return;
+    if (!table) {
+        free(mixer->faces[face]);
+        mixer->faces[face] = NULL;
+    } else {
+        if (!mixer->faces[face]) {
+            mixer->faces[face] = malloc(mixer->length * sizeof(float));
+            assert(mixer->faces[face]);
+        }
+        memcpy(mixer->faces[face], table, mixer->length * sizeof(float));
+    }
+    mixer->built = 0;
+}
+
+void Mixer_set_cursor(Mixer *mixer, const float *position) {
+    const MixerShape *shape = mixer->shape;
+    float *x = mixer->cursor;
+    memcpy(x, position, shape->dims * sizeof(float));
+    // Pull the cursor back inside across any face it has crossed.
+    for (int pass = 0; pass < 4; pass++) {
+        for (int f = 0; f < shape->faces; f++) {
+            float dot = 0.0f;
+            for (int d = 0; d < shape->dims; d++)
+                dot += shape->normals[d * shape->faces + f] * x[d];
+            float over = dot - shape->offsets[f];
+            if (over > 0.0f) {
+                for (int d = 0; d < shape->dims; d++)
+                    x[d] -= over * shape->normals[d * shape->faces + f];
+            }
+        }
+    }
+    Mixer_compute_gains(shape, x, mixer->target);
+}
+
+const float *Mixer_update(Mixer *mixer, const float *const *tables, int frames, int force) {
+    int faces = mixer->shape->faces;
+    float coeff = 1.0f - expf(-frames / (MIXER_SMOOTHING_MS * 0.001f * SAMPLE_RATE));
+    int moved = 0;
+    for (int f = 0; f < faces; f++) {
+        float diff = mixer->target[f] - mixer->gains[f];
+        if (diff == 0.0f)
+            continue;
+        mixer->gains[f] = fabsf(diff) < MIXER_EPSILON ? mixer->target[f]
+                                                      : mixer->gains[f] + coeff * diff;
+        moved = 1;
+    }
+    int swapped = 0;
+    for (int f = 0; f < faces; f++) {
+        const float *table = mixer->faces[f] ? mixer->faces[f] : tables[f];
+        if (table != mixer->sources[f]) {
+            mixer->sources[f] = table;
+            swapped = 1;
+        }
+    }
+    if (mixer->fade < MIXER_FADE_FRAMES)
+        mixer->fade = mixer->fade + frames < MIXER_FADE_FRAMES ? mixer->fade + frames
+                                                               : MIXER_FADE_FRAMES;
+    if (swapped && mixer->built) {
+        // Keep the premix that was playing and fade from it; a change mid-fade starts over.
+        float *old = mixer->previous;
+        mixer->previous = mixer->premix;
+        mixer->premix = old;
+        mixer->fade = 0;
+    }
+    if (moved || swapped || force || !mixer->built) {
+        const DspKernels *dsp = Dsp_get();
+        memset(mixer->premix, 0, mixer->length * sizeof(float));
+        for (int f = 0; f < faces; f++) {
+            if (mixer->gains[f] != 0.0f && mixer->sources[f])
+                dsp->mix_add(mixer->premix, mixer->sources[f], mixer->gains[f],
+                             (int)mixer->length);
+        }
+        mixer->built = 1;
+    }
+    return mixer->premix;
+}
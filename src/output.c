@@ -0,0 +1,217 @@
+#include "output.h"
+#include "dsp.h"
+#include <string.h>
+
+static const enum SoundIoFormat preferred[] = {
+    SoundIoFormatFloat32NE, SoundIoFormatS32NE, SoundIoFormatS24NE,
+    SoundIoFormatS16NE,     SoundIoFormatFloat64NE,
+};
+
+enum SoundIoFormat Output_pick_format(struct SoundIoDevice *device) {
+    for (size_t i = 0; i < sizeof(preferred) / sizeof(preferred[0]); i++) {
+        if (soundio_device_supports_format(device, preferred[i]))
+            return preferred[i];
+    }
+    return SoundIoFormatInvalid;
+}
+
+int OutputFormat_init(OutputFormat *of, enum SoundIoFormat format) {
+    memset(of, 0, sizeof(*of));
+    of->format = format;
+    of->noise_state = 0x9e3779b9u;
+    switch (format) {
+    case SoundIoFormatFloat32NE:
+        of->bytes_per_sample = 4;
+        break;
+    case SoundIoFormatFloat64NE:
+        of->bytes_per_sample = 8;
+        break;
+    case SoundIoFormatS16NE:
+        of->bytes_per_sample = 2;
+        of->scale = 32767.0f;
+        of->dither = 1;
+        break;
+    case SoundIoFormatS24NE:
+        of->bytes_per_sample = 4;
+        of->scale = DSP_S24_SCALE;
+        of->dither = 1;
+        break;
+    case SoundIoFormatS32NE:
+        // Below the float mantissa's resolution there is nothing to dither.
+        of->bytes_per_sample = 4;
+        of->scale = DSP_S32_SCALE;
+        break;
+    default:
+        return -1;
+    }
+    return 0;
+}
+
+// Triangular noise in (-1, 1): the difference of two uniform 16-bit halves of one xorshift32.
+static void fill_tpdf(OutputFormat *of, int n) {
+    uint32_t x = of->noise_state;
+    for (int i = 0; i < n; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        of->noise[i] = ((int)(x & 0xffff) - (int)(x >> 16)) * (1.0f / 65536.0f);
+    }
+    of->noise_state = x;
+}
+
+// Convert samples into the device format; returns where the converted block is.
+static const void *convert(OutputFormat *of, float *samples, void *dst, int n) {
+    const DspKernels *dsp = Dsp_get();
+    if (of->dither) {
+        fill_tpdf(of, n);
+        dsp->mix_add(samples, of->noise, 1.0f / of->scale, n);
+    }
+    switch (of->format) {
+    case SoundIoFormatS16NE:
+        dsp->convert_s16(samples, dst, n);
+        return dst;
+    case SoundIoFormatS24NE:
+    case SoundIoFormatS32NE:
+        dsp->convert_s32(samples, dst, of->scale, n);
+        return dst;
+    case SoundIoFormatFloat64NE:
+        dsp->convert_f64(samples, dst, n);
+        return dst;
+    default:
+        // Float32 needs no conversion; only copy when writing straight to the device.
+        if (dst == of->scratch[0] || dst == of->scratch[1] || dst == of->scratch[2])
+            return samples;
+        memcpy(dst, samples, n * sizeof(float));
+        return dst;
+    }
+}
+
+static int interleaved(const struct SoundIoChannelArea *areas, int channels, int bytes) {
+    for (int ch = 0; ch < channels; ch++) {
+        if (areas[ch].step != channels * bytes || areas[ch].ptr != areas[0].ptr + ch * bytes)
+            return 0;
+    }
+    return 1;
+}
+
+// Copy one converted channel into the device buffer, whatever its layout. Aligned 32-bit
+// samples, the common case, skip the per-sample memcpy.
+static void write_channel(const struct SoundIoChannelArea *area, int frame, const void *src,
+                          int bytes, int n) {
+    char *ptr = area->ptr + (size_t)area->step * frame;
+    size_t step = (size_t)area->step;
+    if (bytes == 4 && step % 4 == 0 && (uintptr_t)ptr % 4 == 0) {
+        const uint32_t *s = src;
+        uint32_t *d = (uint32_t *)ptr;
+        for (int i = 0; i < n; i++)
+            d[i * (step / 4)] = s[i];
+        return;
+    }
+    for (int i = 0; i < n; i++)
+        memcpy(ptr + step * i, (const char *)src + (size_t)i * bytes, bytes);
+}
+
+// Copy each sample to every channel of an interleaved buffer; fixed-width types so the loops
+// vectorise.
+#define DEFINE_FAN_OUT(name, type)                                                           \
+    static void name(const void *src, void *dst, int channels, int n) {                      \
+        const type *s = src;                                                                 \
+        type *d = dst;                                                                       \
+        if (channels == 2) {                                                                 \
+            for (int i = 0; i < n; i++) {                                                    \
+                d[2 * i] = s[i];                                                             \
+                d[2 * i + 1] = s[i];                                                         \
+            }                                                                                \
+            return;                                                                          \
+        }                                                                                    \
+        for (int i = 0; i < n; i++) {                                                        \
+            for (int ch = 0; ch < channels; ch++)                                            \
+                d[i * channels + ch] = s[i];                                                 \
+        }                                                                                    \
+    }
+
+DEFINE_FAN_OUT(fan_out_16, uint16_t)
+DEFINE_FAN_OUT(fan_out_32, uint32_t)
+DEFINE_FAN_OUT(fan_out_64, uint64_t)
+
+// Interleave a stereo pair, with mid in every channel past the pair.
+#define DEFINE_ZIP(name, type)                                                               \
+    static void name(const void *left, const void *right, const void *mid, void *dst,        \
+                     int channels, int n) {                                                  \
+        const type *l = left, *r = right, *m = mid;                                          \
+        type *d = dst;                                                                       \
+        if (channels == 2) {                                                                 \
+            for (int i = 0; i < n; i++) {                                                    \
+                d[2 * i] = l[i];                                                             \
+                d[2 * i + 1] = r[i];                                                         \
+            }                                                                                \
+            return;                                                                          \
+        }                                                                                    \
+        for (int i = 0; i < n; i++) {                                                        \
+            d[i * channels] = l[i];                                                          \
+            d[i * channels + 1] = r[i];                                                      \
+            for (int ch = 2; ch < channels; ch++)                                            \
+                d[i * channels + ch] = m[i];                                                 \
+        }                                                                                    \
+    }
+
+DEFINE_ZIP(zip_16, uint16_t)
+DEFINE_ZIP(zip_32, uint32_t)
+DEFINE_ZIP(zip_64, uint64_t)
+
+void OutputFormat_write(OutputFormat *of, const struct SoundIoChannelArea *areas, int channels,
+                        int frame, float *samples, int n) {
+    int bytes = of->bytes_per_sample;
+    if (interleaved(areas, channels, bytes)) {
+        char *out = areas[0].ptr + (size_t)frame * channels * bytes;
+        if (channels == 1) {
+            // Mono: convert straight into the device buffer.
+            convert(of, samples, out, n);
+            return;
+        }
+        const void *src = convert(of, samples, of->scratch[0], n);
+        if (bytes == 2)
+            fan_out_16(src, out, channels, n);
+        else if (bytes == 4)
+            fan_out_32(src, out, channels, n);
+        else
+            fan_out_64(src, out, channels, n);
+        return;
+    }
+    // Planar or padded layouts: strided copies per channel.
+    const char *src = convert(of, samples, of->scratch[0], n);
+    for (int ch = 0; ch < channels; ch++)
+        write_channel(&areas[ch], frame, src, bytes, n);
+}
+
+void OutputFormat_write_stereo(OutputFormat *of, const struct SoundIoChannelArea *areas,
+                               int channels, int frame, float *left, float *right, int n) {
+    if (channels == 1) {
+        for (int i = 0; i < n; i++)
+            left[i] = 0.5f * (left[i] + right[i]);
+        OutputFormat_write(of, areas, channels, frame, left, n);
+        return;
+    }
+    int bytes = of->bytes_per_sample;
+    // Taken before conversion dithers left and right in place.
+    for (int i = 0; channels > 2 && i < n; i++)
+        of->mid[i] = 0.5f * (left[i] + right[i]);
+    // Each side gets its own dither; the channels past the pair share the converted mid.
+    float *sides[3] = {left, right, of->mid};
+    const void *src[3] = {NULL, NULL, NULL};
+    for (int side = 0; side < 3 && side < channels; side++)
+        src[side] = convert(of, sides[side], of->scratch[side], n);
+    if (interleaved(areas, channels, bytes)) {
+        // Both sides in one pass over the device buffer.
+        char *out = areas[0].ptr + (size_t)frame * channels * bytes;
+        if (bytes == 2)
+            zip_16(src[0], src[1], src[2], out, channels, n);
+        else if (bytes == 4)
+            zip_32(src[0], src[1], src[2], out, channels, n);
+        else
+            zip_64(src[0], src[1], src[2], out, channels, n);
+        return;
+    }
+    for (int ch = 0; ch < channels; ch++)
+        write_channel(&areas[ch], frame, src[ch < 2 ? ch : 2], bytes, n);
+}
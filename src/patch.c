@@ -0,0 +1,214 @@
+#include "patch.h"
+#include "config.h"
+#include "state.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void fill_table(Wavetable *wt, Waveform type) {
+    Wavetable *source = Wavetable_create(type, TABLE_SIZE);
+    *wt = *source;
+    free(source); // keep the data, drop the struct
+}
+
+Patch *Patch_create(const char *name) {
+    Patch *patch = calloc(1, sizeof(Patch));
+    assert(patch);
+    snprintf(patch->name, sizeof(patch->name), "%s", name);
+    patch->tables = malloc(NUM_WAVETABLES * sizeof(Wavetable));
+    patch->levels = malloc(NUM_WAVETABLES * sizeof(float));
+    assert(patch->tables && patch->levels);
+    const Waveform defaults[] = {WAVEFORM_SINE, WAVEFORM_SAW, WAVEFORM_SQUARE, WAVEFORM_TRIANGLE};
+    for (int slot = 0; slot < NUM_WAVETABLES; slot++) {
+        fill_table(&patch->tables[slot], defaults[slot % 4]);
+        patch->levels[slot] = 1.0f;
+    }
+    Patch_set_filter(patch, 20000.0f, 1.0f);
+    return patch;
+}
+
+Patch *Patch_clone(const Patch *patch) {
+    Patch *copy = malloc(sizeof(Patch));
+    assert(copy);
+    *copy = *patch;
+    copy->tables = malloc(NUM_WAVETABLES * sizeof(Wavetable));
+    copy->levels = malloc(NUM_WAVETABLES * sizeof(float));
+    assert(copy->tables && copy->levels);
+    memcpy(copy->levels, patch->levels, NUM_WAVETABLES * sizeof(float));
+    for (int slot = 0; slot < NUM_WAVETABLES; slot++) {
+        const Wavetable *wt = &patch->tables[slot];
+        copy->tables[slot] = *wt;
+        copy->tables[slot].data = malloc(wt->length * sizeof(float));
+        assert(copy->tables[slot].data);
+        memcpy(copy->tables[slot].data, wt->data, wt->length * sizeof(float));
+    }
+    copy->serial = 0;
+    copy->retired_at = 0;
+    copy->next_retired = NULL;
+    return copy;
+}
+
+void Patch_destroy(Patch *patch) {
+    if (!patch)
+        return;
+    for (int slot = 0; slot < NUM_WAVETABLES; slot++)
+        free(patch->tables[slot].data);
+    free(patch->tables);
+    free(patch->levels);
+    free(patch);
+}
+
+void Patch_set_waveform(Patch *patch, int slot, Waveform type) {
+    if (slot < 0 || slot >= NUM_WAVETABLES)
+        return;
+    free(patch->tables[slot].data);
+    fill_table(&patch->tables[slot], type);
+}
+
+int Patch_load_table(Patch *patch, int slot, const char *filename) {
+    if (slot < 0 || slot >= NUM_WAVETABLES)
+        return -1;
+    Wavetable loaded = {NULL, 0, WAVEFORM_CUSTOM};
+    if (Wavetable_load(&loaded, filename) != 0)
+        return -1;
+    if (loaded.length == 0) {
+        free(loaded.data);
+        return -1;
+    }
+    free(patch->tables[slot].data);
+    patch->tables[slot] = loaded;
+    return 0;
+}
+
+void Patch_set_level(Patch *patch, int slot, float level) {
+    if (slot < 0 || slot >= NUM_WAVETABLES)
+        return;
+    patch->levels[slot] = fmaxf(0.0f, fminf(level, 1.0f));
+}
+
+void Patch_set_filter(Patch *patch, float cutoff, float q) {
+    patch->cutoff = cutoff;
+    patch->q = q;
+    Biquad_design_lowpass(&patch->filter, cutoff, q);
+}
+
+void Patch_set_interp(Patch *patch, DspInterp interp) {
+    patch->interp = interp;
+}
+
+// Organ-like drawbar spectrum: harmonic number and amplitude.
+static const struct {
+    int harmonic;
+    float amplitude;
+} drawbars[] = {{1, 1.0f}, {2, 0.8f}, {3, 0.6f}, {4, 0.5f}, {6, 0.3f}, {8, 0.25f}};
+
+static void fill_drawbars(Wavetable *wt) {
+    int count = sizeof(drawbars) / sizeof(drawbars[0]);
+    float peak = 0.0f;
+    for (size_t i = 0; i < wt->length; i++) {
+        double sum = 0.0;
+        for (int d = 0; d < count; d++)
+            sum += drawbars[d].amplitude * sin(2.0 * M_PI * drawbars[d].harmonic * i / wt->length);
+        wt->data[i] = (float)sum;
+        peak = fmaxf(peak, fabsf(wt->data[i]));
+    }
+    for (size_t i = 0; i < wt->length; i++)
+        wt->data[i] /= peak;
+    wt->type = WAVEFORM_CUSTOM;
+}
+
+int Patch_preset_count(void) {
+    return 5;
+}
+
+Patch *Patch_preset(int index) {
+    static const char *names[] = {"Init", "Soft", "Bright", "Organ", "Trumpet"};
+    Patch *patch = Patch_create(names[index]);
+    // Levels for slots 0..3 (sine, saw, square, fourth slot); further slots stay at 1.
+    static const float levels[][4] = {
+        {1.0f, 1.0f, 1.0f, 1.0f}, {1.0f, 0.0f, 0.0f, 0.6f}, {0.2f, 1.0f, 0.6f, 0.0f},
+        {1.0f, 0.0f, 0.0f, 0.0f}, {0.3f, 0.0f, 0.0f, 1.0f},
+    };
+    for (int slot = 0; slot < NUM_WAVETABLES && slot < 4; slot++)
+        Patch_set_level(patch, slot, levels[index][slot]);
+    switch (index) {
+    case 1:
+        Patch_set_filter(patch, 1200.0f, 0.7f);
+        break;
+    case 2:
+        Patch_set_filter(patch, 8000.0f, 0.9f);
+        break;
+    case 3:
+        fill_drawbars(&patch->tables[WAVEFORM_SINE]);
+        Patch_set_filter(patch, 6000.0f, 0.7f);
+        break;
+    case 4:
+        // Falls back to the triangle when the table is not in the working directory.
+        Patch_load_table(patch, WAVEFORM_TRIANGLE, "Trumpet.bin");
+        Patch_set_filter(patch, 5000.0f, 0.8f);
+        break;
+    }
+    return patch;
+}
+
+// --- PatchSlot ---
+
+void PatchSlot_init(PatchSlot *slot) {
+    atomic_init(&slot->current, NULL);
+    atomic_init(&slot->quiescent, 0);
+    slot->next_serial = 0;
+    slot->retired = NULL;
+}
+
+void PatchSlot_destroy(PatchSlot *slot) {
+    Patch_destroy(atomic_exchange(&slot->current, NULL));
+    while (slot->retired) {
+        Patch *next = slot->retired->next_retired;
+        Patch_destroy(slot->retired);
+        slot->retired = next;
+    }
+}
+
+void PatchSlot_publish(PatchSlot *slot, Patch *patch) {
+    if (patch)
+        patch->serial = ++slot->next_serial;
+    Patch *old = atomic_exchange(&slot->current, patch);
+    if (!old)
+        return;
+    // A block that saw the old patch has not finished yet if it is not counted here, so the
+    // old patch is safe to free once the count moves past this value.
+    old->retired_at = atomic_load(&slot->quiescent);
+    old->next_retired = slot->retired;
+    slot->retired = old;
+}
+
+const Patch *PatchSlot_current(PatchSlot *slot) {
+    return atomic_load_explicit(&slot->current, memory_order_relaxed);
+}
+
+int PatchSlot_reclaim(PatchSlot *slot) {
+    unsigned long quiescent = atomic_load(&slot->quiescent);
+    int freed = 0;
+    Patch **link = &slot->retired;
+    while (*link) {
+        Patch *patch = *link;
+        if (quiescent > patch->retired_at) {
+            *link = patch->next_retired;
+            Patch_destroy(patch);
+            freed++;
+        } else {
+            link = &patch->next_retired;
+        }
+    }
+    return freed;
+}
+
+const Patch *PatchSlot_enter(PatchSlot *slot) {
+    return atomic_load(&slot->current);
+}
+
+void PatchSlot_exit(PatchSlot *slot) {
+    atomic_fetch_add(&slot->quiescent, 1);
+}
@@ -0,0 +1,225 @@
+#include "recorder.h"
+#include "config.h"
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RECORDER_CHUNK 16384                   // samples per write (64 KiB)
+#define RECORDER_PREALLOC (16u * 1024 * 1024) // bytes reserved on disk at a time
+#define RECORDER_POLL_NS (10 * 1000 * 1000)
+#define WAV_HEADER_SIZE 44
+// Left and right, interleaved in the ring and the file.
+#define RECORDER_CHANNELS 2
+
+static void put_u16(unsigned char *p, uint16_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+}
+
+static void put_u32(unsigned char *p, uint32_t v) {
+    for (int b = 0; b < 4; b++)
+        p[b] = (unsigned char)(v >> (8 * b));
+}
+
+static size_t header_size(RecorderFormat format) {
+    return format == RECORDER_WAV ? WAV_HEADER_SIZE : 0;
+}
+
+// RIFF sizes are 32-bit; past 4 GiB (about six hours) they saturate, which most readers treat
+// as "read to the end of the file".
+static void wav_header(unsigned char *h, uint64_t data_bytes) {
+    uint32_t data = data_bytes > 0xffffffffu - 36 ? 0xffffffffu - 36 : (uint32_t)data_bytes;
+    memcpy(h, "RIFF", 4);
+    put_u32(h + 4, 36 + data);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    put_u32(h + 16, 16);
+    put_u16(h + 20, 3); // IEEE float
+    put_u16(h + 22, RECORDER_CHANNELS);
+    put_u32(h + 24, SAMPLE_RATE);
+    put_u32(h + 28, SAMPLE_RATE * RECORDER_CHANNELS * sizeof(float));
+    put_u16(h + 32, RECORDER_CHANNELS * sizeof(float)); // block align: one frame
+    put_u16(h + 34, 32);
+    memcpy(h + 36, "data", 4);
+    put_u32(h + 40, data);
+}
+
+static int write_all(int fd, const void *buf, size_t bytes, off_t offset) {
+    const char *p = buf;
+    while (bytes > 0) {
+        ssize_t written = pwrite(fd, p, bytes, offset);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return -1;
+        p += written;
+        offset += written;
+        bytes -= (size_t)written;
+    }
+    return 0;
+}
+
+// Move up to count buffered samples (whole frames) to the file.
+static void drain(Recorder *rec, size_t count) {
+    size_t r = atomic_load_explicit(&rec->read_pos, memory_order_relaxed);
+    size_t start = r & (rec->capacity - 1);
+    size_t first = count < rec->capacity - start ? count : rec->capacity - start;
+    memcpy(rec->chunk, rec->ring + start, first * sizeof(float));
+    memcpy(rec->chunk + first, rec->ring, (count - first) * sizeof(float));
+    atomic_store_explicit(&rec->read_pos, r + count, memory_order_release);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (size_t i = 0; i < count; i++) {
+        uint32_t u;
+        memcpy(&u, &rec->chunk[i], sizeof(u));
+        u = __builtin_bswap32(u);
+        memcpy(&rec->chunk[i], &u, sizeof(u));
+    }
+#endif
+    unsigned long frames = atomic_load(&rec->frames);
+    off_t offset = (off_t)(header_size(rec->format) + frames * RECORDER_CHANNELS * sizeof(float));
+    size_t bytes = count * sizeof(float);
+    // Reserve space ahead so the filesystem is not extending the file on every write.
+    if ((size_t)offset + bytes > rec->allocated) {
+        if (posix_fallocate(rec->fd, (off_t)rec->allocated, RECORDER_PREALLOC) == 0)
+            rec->allocated += RECORDER_PREALLOC;
+    }
+    if (write_all(rec->fd, rec->chunk, bytes, offset) != 0) {
+        atomic_fetch_add(&rec->overruns, count / RECORDER_CHANNELS); // disk full or gone
+        return;
+    }
+    atomic_fetch_add(&rec->frames, count / RECORDER_CHANNELS);
+}
+
+static void *writer(void *arg) {
+    Recorder *rec = arg;
+    for (;;) {
+        int stopping = atomic_load(&rec->stopping);
+        size_t available = atomic_load_explicit(&rec->write_pos, memory_order_acquire) -
+                           atomic_load_explicit(&rec->read_pos, memory_order_relaxed);
+        if (available >= RECORDER_CHUNK || (stopping && available > 0)) {
+            drain(rec, available < RECORDER_CHUNK ? available : RECORDER_CHUNK);
+            continue;
+        }
+        if (stopping)
+            break;
+        struct timespec pause = {0, RECORDER_POLL_NS};
+        nanosleep(&pause, NULL);
+    }
+    return NULL;
+}
+
+Recorder *Recorder_create(size_t capacity) {
+    size_t size = RECORDER_CHUNK;
+    while (size < capacity)
+        size <<= 1;
+    Recorder *rec = calloc(1, sizeof(Recorder));
+    assert(rec);
+    rec->capacity = size;
+    rec->ring = malloc(size * sizeof(float));
+    rec->chunk = malloc(RECORDER_CHUNK * sizeof(float));
+    assert(rec->ring && rec->chunk);
+    atomic_init(&rec->write_pos, 0);
+    atomic_init(&rec->read_pos, 0);
+    atomic_init(&rec->recording, 0);
+    atomic_init(&rec->overruns, 0);
+    atomic_init(&rec->frames, 0);
+    atomic_init(&rec->stopping, 0);
+    rec->fd = -1;
+    return rec;
+}
+
+void Recorder_destroy(Recorder *rec) {
+    if (!rec)
+        return;
+    Recorder_stop(rec);
+    free(rec->chunk);
+    free(rec->ring);
+    free(rec);
+}
+
+int Recorder_start(Recorder *rec, const char *filename, RecorderFormat format) {
+    if (rec->fd >= 0)
+        return -1;
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return -1;
+    rec->fd = fd;
+    rec->format = format;
+    rec->allocated = 0;
+    if (format == RECORDER_WAV) {
+        unsigned char header[WAV_HEADER_SIZE];
+        wav_header(header, 0);
+        if (write_all(fd, header, sizeof(header), 0) != 0) {
+            close(fd);
+            rec->fd = -1;
+            return -1;
+        }
+    }
+    // Anything the callback pushed after the last stop belongs to no recording.
+    atomic_store(&rec->read_pos, atomic_load(&rec->write_pos));
+    atomic_store(&rec->frames, 0);
+    atomic_store(&rec->overruns, 0);
+    atomic_store(&rec->stopping, 0);
+    if (pthread_create(&rec->thread, NULL, writer, rec) != 0) {
+        close(fd);
+        rec->fd = -1;
+        return -1;
+    }
+    atomic_store(&rec->recording, 1);
+    return 0;
+}
+
+void Recorder_stop(Recorder *rec) {
+    if (rec->fd < 0)
+        return;
+    atomic_store(&rec->recording, 0);
+    atomic_store(&rec->stopping, 1);
+    pthread_join(rec->thread, NULL);
+    uint64_t data_bytes = (uint64_t)atomic_load(&rec->frames) * RECORDER_CHANNELS * sizeof(float);
+    if (rec->format == RECORDER_WAV) {
+        unsigned char header[WAV_HEADER_SIZE];
+        wav_header(header, data_bytes);
+        write_all(rec->fd, header, sizeof(header), 0);
+    }
+    // Give back the unused preallocation.
+    if (ftruncate(rec->fd, (off_t)(header_size(rec->format) + data_bytes)) != 0)
+        fprintf(stderr, "Recorder: could not trim file: %s\n", strerror(errno));
+    close(rec->fd);
+    rec->fd = -1;
+}
+
+int Recorder_is_recording(Recorder *rec) {
+    return atomic_load(&rec->recording);
+}
+
+double Recorder_seconds(Recorder *rec) {
+    return (double)atomic_load(&rec->frames) / SAMPLE_RATE;
+}
+
+unsigned long Recorder_overruns(Recorder *rec) {
+    return atomic_load(&rec->overruns);
+}
+
+void Recorder_write(Recorder *rec, const float *left, const float *right, int n) {
+    if (!atomic_load_explicit(&rec->recording, memory_order_acquire))
+        return;
+    size_t w = atomic_load_explicit(&rec->write_pos, memory_order_relaxed);
+    size_t r = atomic_load_explicit(&rec->read_pos, memory_order_acquire);
+    size_t space = (rec->capacity - (w - r)) / RECORDER_CHANNELS;
+    size_t count = (size_t)n < space ? (size_t)n : space;
+    if (count < (size_t)n)
+        atomic_fetch_add_explicit(&rec->overruns, n - count, memory_order_relaxed);
+    // The capacity is even, so a frame never straddles the wrap.
+    size_t mask = rec->capacity - 1;
+    for (size_t i = 0; i < count; i++) {
+        float *frame = rec->ring + ((w + RECORDER_CHANNELS * i) & mask);
+        frame[0] = left[i];
+        frame[1] = right[i];
+    }
+    atomic_store_explicit(&rec->write_pos, w + RECORDER_CHANNELS * count, memory_order_release);
+}
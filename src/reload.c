@@ -0,0 +1,161 @@
+#include "reload.h"
+#include "extract.h"
+#include <assert.h>
+#include <errno.h>
+#include <math.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// How often the thread wakes with nothing to do, to free tables the audio thread retired.
+#define RELOAD_COLLECT_MS 100
+
+Reloader *Reloader_create(State *state, const char *dir) {
+    Reloader *reloader = calloc(1, sizeof(Reloader));
+    assert(reloader);
+    reloader->state = state;
+    snprintf(reloader->dir, sizeof(reloader->dir), "%s", dir);
+    reloader->fd = -1;
+    reloader->wake[0] = reloader->wake[1] = -1;
+    atomic_init(&reloader->reloads, 0);
+    atomic_init(&reloader->rejected, 0);
+    return reloader;
+}
+
+void Reloader_destroy(Reloader *reloader) {
+    if (!reloader)
+        return;
+    if (reloader->running) {
+        char byte = 0;
+        if (write(reloader->wake[1], &byte, 1) != 1)
+            fprintf(stderr, "Reloader: cannot wake thread: %s\n", strerror(errno));
+        pthread_join(reloader->thread, NULL);
+    }
+    if (reloader->fd >= 0)
+        close(reloader->fd);
+    for (int i = 0; i < 2; i++) {
+        if (reloader->wake[i] >= 0)
+            close(reloader->wake[i]);
+    }
+    free(reloader);
+}
+
+int Reloader_watch(Reloader *reloader, int slot, const char *filename) {
+    if (reloader->running || reloader->num_watches >= RELOAD_MAX_WATCHES || slot < 0 ||
+        slot >= NUM_WAVETABLES || strlen(filename) >= sizeof(reloader->watches[0].filename))
+        return -1;
+    reloader->watches[reloader->num_watches].slot = slot;
+    snprintf(reloader->watches[reloader->num_watches].filename,
+             sizeof(reloader->watches[0].filename), "%s", filename);
+    reloader->num_watches++;
+    return 0;
+}
+
+static const char *watched_file(Reloader *reloader, int slot) {
+    for (int i = 0; i < reloader->num_watches; i++) {
+        if (reloader->watches[i].slot == slot)
+            return reloader->watches[i].filename;
+    }
+    return NULL;
+}
+
+int Reloader_load(Reloader *reloader, int slot) {
+    const char *filename = watched_file(reloader, slot);
+    if (!filename)
+        return -1;
+    char path[sizeof(reloader->dir) + sizeof(reloader->watches[0].filename) + 1];
+    snprintf(path, sizeof(path), "%s/%s", reloader->dir, filename);
+    Wavetable loaded = {NULL, 0, WAVEFORM_CUSTOM};
+    // A half-written file shows up as a short read; the next close event brings the rest.
+    int err = Wavetable_load_max(&loaded, path, RELOAD_MAX_LENGTH);
+    if (!err && loaded.length < 4) {
+        free(loaded.data);
+        err = -1;
+    }
+    for (size_t i = 0; !err && i < loaded.length; i++) {
+        if (!isfinite(loaded.data[i])) {
+            free(loaded.data);
+            err = -1;
+        }
+    }
+    if (err) {
+        fprintf(stderr, "Reloader: rejected %s\n", path);
+        atomic_fetch_add(&reloader->rejected, 1);
+        return -1;
+    }
+    // The slot's length is fixed when the State is created, so the fade never mixes lengths.
+    size_t length = reloader->state->wts[slot].length;
+    float *table = loaded.data;
+    if (loaded.length != length) {
+        table = malloc(length * sizeof(float));
+        assert(table);
+        Extract_resample_fft(loaded.data, loaded.length, table, length);
+    }
+    SpectralFrame *frame = SpectralFrame_build(table, length, SPECTRAL_MAX_MIPS);
+    if (table != loaded.data)
+        free(table);
+    free(loaded.data);
+    State_offer_table(reloader->state, slot, frame);
+    atomic_fetch_add(&reloader->reloads, 1);
+    printf("Reloaded %s into slot %d\n", path, slot);
+    return 0;
+}
+
+static void handle_events(Reloader *reloader) {
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t len = read(reloader->fd, buf, sizeof(buf));
+    for (char *p = buf; len > 0 && p < buf + len;) {
+        const struct inotify_event *event = (const struct inotify_event *)p;
+        for (int i = 0; event->len > 0 && i < reloader->num_watches; i++) {
+            if (strcmp(event->name, reloader->watches[i].filename) == 0)
+                Reloader_load(reloader, reloader->watches[i].slot);
+        }
+        p += sizeof(struct inotify_event) + event->len;
+    }
+}
+
+static void *watcher(void *arg) {
+    Reloader *reloader = arg;
+    struct pollfd fds[2] = {{reloader->fd, POLLIN, 0}, {reloader->wake[0], POLLIN, 0}};
+    for (;;) {
+        int ready = poll(fds, 2, RELOAD_COLLECT_MS);
+        if (ready < 0 && errno != EINTR)
+            break;
+        if (fds[1].revents)
+            break;
+        if (ready > 0 && (fds[0].revents & POLLIN))
+            handle_events(reloader);
+        State_collect_tables(reloader->state);
+    }
+    return NULL;
+}
+
+int Reloader_start(Reloader *reloader) {
+    if (reloader->running)
+        return 0;
+    reloader->fd = inotify_init1(IN_CLOEXEC);
+    if (reloader->fd < 0)
+        return -1;
+    // Editors and scripts either rewrite the file in place or rename a temporary over it.
+    if (inotify_add_watch(reloader->fd, reloader->dir, IN_CLOSE_WRITE | IN_MOVED_TO) < 0 ||
+        pipe(reloader->wake) != 0) {
+        fprintf(stderr, "Reloader: cannot watch %s: %s\n", reloader->dir, strerror(errno));
+        return -1;
+    }
+    if (pthread_create(&reloader->thread, NULL, watcher, reloader) != 0)
+        return -1;
+    reloader->running = 1;
+    return 0;
+}
+
+unsigned long Reloader_reloads(Reloader *reloader) {
+    return atomic_load(&reloader->reloads);
+}
+
+unsigned long Reloader_rejected(Reloader *reloader) {
+    return atomic_load(&reloader->rejected);
+}
@@ -0,0 +1,347 @@
+#include "spectral.h"
+#include "config.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Below this many changed harmonics, adding per-harmonic deltas beats full inverse FFTs.
+#define SPECTRAL_INCREMENTAL_MAX 16
+// Full rebuild after this many incremental updates so float error cannot accumulate.
+#define SPECTRAL_REFRESH_INTERVAL 256
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Frame the worker may overwrite: neither published nor pinned by the audio thread.
+static SpectralFrame *spare_frame(SpectralTable *st) {
+    SpectralFrame *published = atomic_load(&st->published);
+    SpectralFrame *in_use = atomic_load(&st->in_use);
+    for (int i = 0; i < 3; i++) {
+        if (&st->frames[i] != published && &st->frames[i] != in_use)
+            return &st->frames[i];
+    }
+    assert(0 && "no spare spectral frame");
+    return NULL;
+}
+
+static void rebuild_full(SpectralTable *st, SpectralFrame *frame) {
+    size_t n = st->length;
+    for (int level = 0; level < frame->num_mips; level++) {
+        memset(st->spectrum, 0, n * sizeof(FftComplex));
+        for (int h = 1; h <= frame->max_harmonic[level]; h++) {
+            // m * sin(theta + p) puts N * m / 2 * (sin p - i cos p) in bin h.
+            float m = st->built_magnitudes[h] * n * 0.5f;
+            float p = st->built_phases[h];
+            st->spectrum[h] = (FftComplex){m * sinf(p), -m * cosf(p)};
+            st->spectrum[n - h] = (FftComplex){m * sinf(p), m * cosf(p)};
+        }
+        Fft_inverse(st->fft, st->spectrum);
+        for (size_t i = 0; i < n; i++)
+            frame->mips[level][i] = st->spectrum[i].re;
+    }
+}
+
+static void rebuild_incremental(SpectralTable *st, SpectralFrame *frame, int count) {
+    size_t n = st->length;
+    for (int e = 0; e < count; e++) {
+        const SpectralEdit *edit = &st->edits[e];
+        int h = edit->harmonic;
+        float old_m = st->built_magnitudes[h], old_p = st->built_phases[h];
+        // sin(theta + p) = sin(theta) cos(p) + cos(theta) sin(p); theta comes from the tables.
+        float ds = edit->magnitude * cosf(edit->phase) - old_m * cosf(old_p);
+        float dc = edit->magnitude * sinf(edit->phase) - old_m * sinf(old_p);
+        size_t index = 0;
+        for (size_t i = 0; i < n; i++) {
+            st->delta[i] = ds * st->sin_table[index] + dc * st->cos_table[index];
+            index = (index + h) & (n - 1);
+        }
+        for (int level = 0; level < frame->num_mips && frame->max_harmonic[level] >= h; level++) {
+            float *mip = frame->mips[level];
+            for (size_t i = 0; i < n; i++)
+                mip[i] += st->delta[i];
+        }
+        st->built_magnitudes[h] = edit->magnitude;
+        st->built_phases[h] = edit->phase;
+    }
+}
+
+static void rebuild(SpectralTable *st, int count) {
+    double start = now_ms();
+    SpectralFrame *published = atomic_load(&st->published);
+    SpectralFrame *frame = spare_frame(st);
+    if (count <= SPECTRAL_INCREMENTAL_MAX && st->updates_since_full < SPECTRAL_REFRESH_INTERVAL) {
+        for (int level = 0; level < frame->num_mips; level++)
+            memcpy(frame->mips[level], published->mips[level], st->length * sizeof(float));
+        rebuild_incremental(st, frame, count);
+        st->updates_since_full++;
+    } else {
+        for (int e = 0; e < count; e++) {
+            st->built_magnitudes[st->edits[e].harmonic] = st->edits[e].magnitude;
+            st->built_phases[st->edits[e].harmonic] = st->edits[e].phase;
+        }
+        rebuild_full(st, frame);
+        st->updates_since_full = 0;
+    }
+    atomic_store(&st->published, frame);
+    atomic_store(&st->last_rebuild_ms, (float)(now_ms() - start));
+}
+
+static void *worker(void *arg) {
+    SpectralTable *st = arg;
+    pthread_mutex_lock(&st->mutex);
+    for (;;) {
+        while (st->running && !st->pending)
+            pthread_cond_wait(&st->wake, &st->mutex);
+        if (!st->running)
+            break;
+        // Take a snapshot of the edits so the editor is never held up by a rebuild.
+        int count = 0;
+        for (int h = 1; h <= st->num_harmonics; h++) {
+            if (st->dirty[h]) {
+                st->dirty[h] = 0;
+                st->edits[count++] = (SpectralEdit){h, st->magnitudes[h], st->phases[h]};
+            }
+        }
+        st->pending = 0;
+        st->busy = 1;
+        pthread_mutex_unlock(&st->mutex);
+        rebuild(st, count);
+        pthread_mutex_lock(&st->mutex);
+        st->busy = 0;
+        pthread_cond_broadcast(&st->idle);
+    }
+    pthread_mutex_unlock(&st->mutex);
+    return NULL;
+}
+
+SpectralTable *SpectralTable_create(size_t length, int num_mips) {
+    assert(length >= 4 && !(length & (length - 1)));
+    SpectralTable *st = calloc(1, sizeof(SpectralTable));
+    assert(st);
+    st->length = length;
+    st->num_harmonics = (int)(length / 2 - 1);
+    int max_mips = 1;
+    while (max_mips < SPECTRAL_MAX_MIPS && (st->num_harmonics >> max_mips) > 0)
+        max_mips++;
+    st->num_mips = num_mips < 1 ? 1 : (num_mips > max_mips ? max_mips : num_mips);
+
+    size_t harmonics = st->num_harmonics + 1;
+    st->magnitudes = calloc(harmonics, sizeof(float));
+    st->phases = calloc(harmonics, sizeof(float));
+    st->dirty = calloc(harmonics, 1);
+    st->built_magnitudes = calloc(harmonics, sizeof(float));
+    st->built_phases = calloc(harmonics, sizeof(float));
+    st->edits = malloc(harmonics * sizeof(SpectralEdit));
+    st->sin_table = malloc(length * sizeof(float));
+    st->cos_table = malloc(length * sizeof(float));
+    st->delta = malloc(length * sizeof(float));
+    st->spectrum = malloc(length * sizeof(FftComplex));
+    st->fft = Fft_create(length);
+    assert(st->magnitudes && st->phases && st->dirty && st->built_magnitudes &&
+           st->built_phases && st->edits && st->sin_table && st->cos_table && st->delta &&
+           st->spectrum);
+    for (size_t i = 0; i < length; i++) {
+        st->sin_table[i] = (float)sin(2.0 * M_PI * i / length);
+        st->cos_table[i] = (float)cos(2.0 * M_PI * i / length);
+    }
+    for (int f = 0; f < 3; f++) {
+        SpectralFrame *frame = &st->frames[f];
+        frame->length = length;
+        frame->num_mips = st->num_mips;
+        for (int level = 0; level < st->num_mips; level++) {
+            frame->mips[level] = calloc(length, sizeof(float));
+            assert(frame->mips[level]);
+            frame->max_harmonic[level] = st->num_harmonics >> level;
+        }
+    }
+    atomic_init(&st->published, &st->frames[0]);
+    atomic_init(&st->in_use, NULL);
+    atomic_init(&st->last_rebuild_ms, 0.0f);
+
+    pthread_mutex_init(&st->mutex, NULL);
+    pthread_cond_init(&st->wake, NULL);
+    pthread_cond_init(&st->idle, NULL);
+    st->running = 1;
+    if (pthread_create(&st->thread, NULL, worker, st) != 0) {
+        fprintf(stderr, "Failed to start spectral worker\n");
+        exit(EXIT_FAILURE);
+    }
+    return st;
+}
+
+void SpectralTable_destroy(SpectralTable *st) {
+    if (!st)
+        return;
+    pthread_mutex_lock(&st->mutex);
+    st->running = 0;
+    pthread_cond_signal(&st->wake);
+    pthread_mutex_unlock(&st->mutex);
+    pthread_join(st->thread, NULL);
+    pthread_mutex_destroy(&st->mutex);
+    pthread_cond_destroy(&st->wake);
+    pthread_cond_destroy(&st->idle);
+    for (int f = 0; f < 3; f++) {
+        for (int level = 0; level < st->num_mips; level++)
+            free(st->frames[f].mips[level]);
+    }
+    Fft_destroy(st->fft);
+    free(st->spectrum);
+    free(st->delta);
+    free(st->cos_table);
+    free(st->sin_table);
+    free(st->edits);
+    free(st->built_phases);
+    free(st->built_magnitudes);
+    free(st->dirty);
+    free(st->phases);
+    free(st->magnitudes);
+    free(st);
+}
+
+void SpectralTable_set_harmonic(SpectralTable *st, int harmonic, float magnitude, float phase) {
+    if (harmonic < 1 || harmonic > st->num_harmonics)
+        return;
+    pthread_mutex_lock(&st->mutex);
+    st->magnitudes[harmonic] = magnitude;
+    st->phases[harmonic] = phase;
+    st->dirty[harmonic] = 1;
+    st->pending = 1;
+    pthread_cond_signal(&st->wake);
+    pthread_mutex_unlock(&st->mutex);
+}
+
+float SpectralTable_get_magnitude(SpectralTable *st, int harmonic) {
+    if (harmonic < 1 || harmonic > st->num_harmonics)
+        return 0.0f;
+    pthread_mutex_lock(&st->mutex);
+    float magnitude = st->magnitudes[harmonic];
+    pthread_mutex_unlock(&st->mutex);
+    return magnitude;
+}
+
+float SpectralTable_get_phase(SpectralTable *st, int harmonic) {
+    if (harmonic < 1 || harmonic > st->num_harmonics)
+        return 0.0f;
+    pthread_mutex_lock(&st->mutex);
+    float phase = st->phases[harmonic];
+    pthread_mutex_unlock(&st->mutex);
+    return phase;
+}
+
+int SpectralTable_analyze(SpectralTable *st, const Wavetable *wt) {
+    size_t n = st->length;
+    if (!wt || wt->length != n)
+        return -1;
+    Fft *fft = Fft_create(n);
+    FftComplex *bins = malloc(n * sizeof(FftComplex));
+    if (!bins) {
+        Fft_destroy(fft);
+        return -1;
+    }
+    for (size_t i = 0; i < n; i++)
+        bins[i] = (FftComplex){wt->data[i], 0.0f};
+    Fft_forward(fft, bins);
+    pthread_mutex_lock(&st->mutex);
+    for (int h = 1; h <= st->num_harmonics; h++) {
+        float re = bins[h].re, im = bins[h].im;
+        st->magnitudes[h] = 2.0f * sqrtf(re * re + im * im) / n;
+        st->phases[h] = atan2f(re, -im);
+        st->dirty[h] = 1;
+    }
+    st->pending = 1;
+    pthread_cond_signal(&st->wake);
+    pthread_mutex_unlock(&st->mutex);
+    free(bins);
+    Fft_destroy(fft);
+    return 0;
+}
+
+void SpectralTable_flush(SpectralTable *st) {
+    pthread_mutex_lock(&st->mutex);
+    while (st->pending || st->busy)
+        pthread_cond_wait(&st->idle, &st->mutex);
+    pthread_mutex_unlock(&st->mutex);
+}
+
+float SpectralTable_last_rebuild_ms(SpectralTable *st) {
+    return atomic_load(&st->last_rebuild_ms);
+}
+
+const SpectralFrame *SpectralTable_acquire(SpectralTable *st) {
+    // Hazard pointer: pin the frame, then confirm it is still the published one, so the
+    // worker can never pick it as its spare while we read it.
+    SpectralFrame *frame;
+    do {
+        frame = atomic_load(&st->published);
+        atomic_store(&st->in_use, frame);
+    } while (atomic_load(&st->published) != frame);
+    return frame;
+}
+
+void SpectralTable_release(SpectralTable *st) {
+    atomic_store(&st->in_use, NULL);
+}
+
+const float *SpectralFrame_mip(const SpectralFrame *frame, double phase_inc) {
+    if (phase_inc <= 0.0)
+        return frame->mips[0];
+    double limit = frame->length / (2.0 * phase_inc);
+    for (int level = 0; level < frame->num_mips; level++) {
+        if (frame->max_harmonic[level] < limit)
+            return frame->mips[level];
+    }
+    return frame->mips[frame->num_mips - 1];
+}
+
+SpectralFrame *SpectralFrame_build(const float *table, size_t length, int num_mips) {
+    assert(length >= 4);
+    SpectralFrame *frame = calloc(1, sizeof(SpectralFrame));
+    assert(frame);
+    frame->length = length;
+    int harmonics = (int)((length - 1) / 2);
+    int max_mips = 1;
+    while (max_mips < SPECTRAL_MAX_MIPS && (harmonics >> max_mips) > 0)
+        max_mips++;
+    frame->num_mips = num_mips < 1 ? 1 : (num_mips > max_mips ? max_mips : num_mips);
+    Fft *fft = Fft_create(length);
+    FftComplex *spectrum = malloc(length * sizeof(FftComplex));
+    FftComplex *bins = malloc(length * sizeof(FftComplex));
+    assert(spectrum && bins);
+    for (size_t i = 0; i < length; i++)
+        spectrum[i] = (FftComplex){table[i], 0.0f};
+    Fft_forward(fft, spectrum);
+    for (int level = 0; level < frame->num_mips; level++) {
+        int top = harmonics >> level;
+        frame->max_harmonic[level] = top;
+        frame->mips[level] = malloc(length * sizeof(float));
+        assert(frame->mips[level]);
+        // Keep DC and harmonics 1..top with their mirror bins; the rest is zeroed.
+        memset(bins, 0, length * sizeof(FftComplex));
+        bins[0] = spectrum[0];
+        for (int h = 1; h <= top; h++) {
+            bins[h] = spectrum[h];
+            bins[length - h] = spectrum[length - h];
+        }
+        Fft_inverse(fft, bins);
+        for (size_t i = 0; i < length; i++)
+            frame->mips[level][i] = bins[i].re;
+    }
+    free(bins);
+    free(spectrum);
+    Fft_destroy(fft);
+    return frame;
+}
+
+void SpectralFrame_destroy(SpectralFrame *frame) {
+    if (!frame)
+        return;
+    for (int level = 0; level < frame->num_mips; level++)
+        free(frame->mips[level]);
+    free(frame);
+}
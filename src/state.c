@@ -1,42 +1,100 @@
 #include "state.h"
 #include "config.h"
+#include "dsp.h"
 #include "filter.h"
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 const int NUM_OSCS = 4;
 const int NUM_WAVETABLES = 4;
 const int NUM_VOICES = 12; // increased to cover all keys
 
+// Move a table into its slot of the pool's array.
+static void take_table(Wavetable *slot, Wavetable *wt) {
+    *slot = *wt;
+    free(wt); // the data now belongs to the slot
+}
+
+TablePool *TablePool_create(void) {
+    TablePool *pool = malloc(sizeof(TablePool));
+    assert(pool);
+    pool->wts = malloc(NUM_WAVETABLES * sizeof(Wavetable));
+    assert(pool->wts);
+    take_table(&pool->wts[WAVEFORM_SINE], Wavetable_create(WAVEFORM_SINE, TABLE_SIZE));
+    take_table(&pool->wts[WAVEFORM_SAW], Wavetable_create(WAVEFORM_SAW, TABLE_SIZE));
+    take_table(&pool->wts[WAVEFORM_SQUARE], Wavetable_create(WAVEFORM_SQUARE, TABLE_SIZE));
+    // The trumpet plays in the triangle's slot; without Trumpet.bin the triangle stays.
+    take_table(&pool->wts[WAVEFORM_TRIANGLE], Wavetable_create(WAVEFORM_TRIANGLE, TABLE_SIZE));
+    Wavetable loaded = {NULL, 0, WAVEFORM_CUSTOM};
+    if (Wavetable_load(&loaded, "Trumpet.bin") == 0 && loaded.length > 0) {
+        free(pool->wts[WAVEFORM_TRIANGLE].data);
+        pool->wts[WAVEFORM_TRIANGLE] = loaded;
+    } else {
+        free(loaded.data);
+    }
+    atomic_init(&pool->refs, 1);
+    return pool;
+}
+
+TablePool *TablePool_retain(TablePool *pool) {
+    atomic_fetch_add_explicit(&pool->refs, 1, memory_order_relaxed);
+    return pool;
+}
+
+void TablePool_release(TablePool *pool) {
+    if (!pool || atomic_fetch_sub_explicit(&pool->refs, 1, memory_order_acq_rel) != 1)
+        return;
+    for (int i = 0; i < NUM_WAVETABLES; i++)
+        free(pool->wts[i].data); // the tables live in the wts array, not on the heap
+    free(pool->wts);
+    free(pool);
+}
+
 State *State_create(void) {
+    TablePool *pool = TablePool_create();
+    State *state = State_create_shared(pool);
+    TablePool_release(pool); // the state holds the only reference now
+    state->effects = Effects_create();
+    return state;
+}
+
+State *State_create_shared(TablePool *pool) {
     State *state = malloc(sizeof(State));
     assert(state);
     state->oscs = malloc(NUM_VOICES * NUM_OSCS * sizeof(Osc));
     assert(state->oscs);
-    state->wts = malloc(NUM_WAVETABLES * sizeof(Wavetable));
-    assert(state->wts);
     state->wt_levels = malloc(NUM_WAVETABLES * sizeof(float));
     assert(state->wt_levels);
     for (int i = 0; i < NUM_VOICES * NUM_OSCS; i++) {
-        state->oscs[i] = Osc_create(i % 4, 0); // TODO generalize to n wavetables
+        state->oscs[i] = Osc_create(i % NUM_WAVETABLES, 0);
     }
     for (int i = 0; i < NUM_WAVETABLES; i++) {
         state->wt_levels[i] = 1.0f;
     }
+    state->spectral = calloc(NUM_WAVETABLES, sizeof(SpectralTable *));
+    assert(state->spectral);
+    state->mixer = NULL;
+    state->hot = calloc(NUM_WAVETABLES, sizeof(HotSlot));
+    assert(state->hot);
+    for (int i = 0; i < NUM_WAVETABLES; i++) {
+        atomic_init(&state->hot[i].pending, NULL);
+        atomic_init(&state->hot[i].retired, NULL);
+        state->hot[i].fade = RELOAD_FADE_FRAMES;
+    }
     state->active = malloc(NUM_VOICES * sizeof(int));
     assert(state->active);
     for (int i = 0; i < NUM_VOICES; i++) {
         state->active[i] = 0;
     }
-    // Create shared wavetables.
-    state->wts[WAVEFORM_SINE] = *Wavetable_create(WAVEFORM_SINE, TABLE_SIZE);
-    state->wts[WAVEFORM_SAW] = *Wavetable_create(WAVEFORM_SAW, TABLE_SIZE);
-    state->wts[WAVEFORM_SQUARE] = *Wavetable_create(WAVEFORM_SQUARE, TABLE_SIZE);
-    // state->wts[WAVEFORM_TRIANGLE] = *Wavetable_create(WAVEFORM_TRIANGLE, TABLE_SIZE);
-    state->wts[WAVEFORM_TRIANGLE] = *Wavetable_create(WAVEFORM_CUSTOM, TABLE_SIZE);
-    Wavetable_load(&state->wts[WAVEFORM_TRIANGLE], "Trumpet.bin");
+    state->pool = TablePool_retain(pool);
+    state->wts = pool->wts;
 
     Lowpass_init(&state->lpf);
+    state->effects = NULL;
+    state->interp = DSP_INTERP_LINEAR;
+    PatchSlot_init(&state->patches);
+    state->patch_serial = 0;
     return state;
 }
 
@@ -44,9 +102,19 @@ void State_destroy(State *state) {
     if (!state)
         return;
     for (int i = 0; i < NUM_WAVETABLES; i++) {
-        Wavetable_destroy(&state->wts[i]);
+        SpectralTable_destroy(state->spectral[i]);
+        HotSlot *hot = &state->hot[i];
+        SpectralFrame_destroy(atomic_load(&hot->pending));
+        SpectralFrame_destroy(atomic_load(&hot->retired));
+        SpectralFrame_destroy(hot->playing);
+        SpectralFrame_destroy(hot->previous);
     }
-    free(state->wts);
+    free(state->hot);
+    free(state->spectral);
+    Mixer_destroy(state->mixer);
+    Effects_destroy(state->effects);
+    PatchSlot_destroy(&state->patches);
+    TablePool_release(state->pool);
     free(state->wt_levels);
     free(state->oscs);
     free(state->active);
@@ -64,6 +132,50 @@ void State_set_note(State *state, int voice, double freq) {
     }
 }
 
+void State_set_freq(State *state, int voice, double freq) {
+    if (voice < 0 || voice >= NUM_VOICES)
+        return;
+    for (int i = 0; i < NUM_OSCS; i++)
+        Osc_set_freq(&state->oscs[voice * NUM_OSCS + i], freq);
+}
+
+int State_active_voices(const State *state) {
+    int count = 0;
+    for (int voice = 0; voice < NUM_VOICES; voice++)
+        count += state->active[voice] != 0;
+    return count;
+}
+
+void State_set_spectral(State *state, int slot, SpectralTable *st) {
+    if (slot < 0 || slot >= NUM_WAVETABLES)
+        return;
+    state->spectral[slot] = st;
+}
+
+void State_set_mixer(State *state, Mixer *mixer) {
+    state->mixer = mixer;
+}
+
+void State_offer_table(State *state, int slot, SpectralFrame *frame) {
+    if (slot < 0 || slot >= NUM_WAVETABLES || frame->length != state->wts[slot].length) {
+        SpectralFrame_destroy(frame);
+        return;
+    }
+    SpectralFrame_destroy(atomic_exchange(&state->hot[slot].pending, frame));
+}
+
+int State_collect_tables(State *state) {
+    int freed = 0;
+    for (int slot = 0; slot < NUM_WAVETABLES; slot++) {
+        SpectralFrame *old = atomic_exchange(&state->hot[slot].retired, NULL);
+        if (old) {
+            SpectralFrame_destroy(old);
+            freed++;
+        }
+    }
+    return freed;
+}
+
 void State_clear_voice(State *state, int voice) {
     if (voice < 0 || voice >= NUM_VOICES)
         return;
@@ -82,16 +194,19 @@ float State_mix_sample(State *state) {
             for (int i = 0; i < NUM_OSCS; i++) {
                 int idx = voice * NUM_OSCS + i;
                 Osc *osc = &state->oscs[idx];
-                Wavetable *wt = &state->wts[osc->wt_index];
-                size_t len = wt->length;
-                double pos = osc->phase;
-                int index0 = (int)pos;
-                int index1 = (index0 + 1) % len;
-                double frac = pos - index0;
-                float sample = (float)((1.0 - frac) * wt->data[index0] + frac * wt->data[index1]);
+                const Wavetable *wt = &state->wts[osc->wt_index];
+                SpectralTable *st = state->spectral[osc->wt_index];
+                const SpectralFrame *frame = st ? SpectralTable_acquire(st) : NULL;
+                size_t len = frame ? frame->length : wt->length;
+                // phase_inc is in TABLE_SIZE units; tables of other lengths scale it.
+                double inc = osc->phase_inc * len / TABLE_SIZE;
+                const float *data = frame ? SpectralFrame_mip(frame, inc) : wt->data;
+                float sample = Dsp_interp_sample(data, len, osc->phase, state->interp);
+                if (st)
+                    SpectralTable_release(st);
                 sample *= state->wt_levels[osc->wt_index];
                 voice_sum += sample;
-                osc->phase += osc->phase_inc;
+                osc->phase += inc;
                 if (osc->phase >= len)
                     osc->phase -= len;
             }
@@ -101,3 +216,176 @@ float State_mix_sample(State *state) {
     }
     return mix;
 }
+
+// Gather one table per mixer face and return the premix for this block.
+static const float *render_premix(State *state, const Wavetable *wts, const HotSlot *hot,
+                                  int frames) {
+    Mixer *mixer = state->mixer;
+    const float *slots[NUM_WAVETABLES];
+    int live = 0; // spectral slots can change under us, so rebuild every block
+    for (int slot = 0; slot < NUM_WAVETABLES; slot++) {
+        SpectralTable *st = state->spectral[slot];
+        const SpectralFrame *frame = st ? SpectralTable_acquire(st) : NULL;
+        if (frame && frame->length == mixer->length) {
+            slots[slot] = frame->mips[0];
+            live = 1;
+        } else if (hot && hot[slot].playing && hot[slot].playing->length == mixer->length) {
+            slots[slot] = hot[slot].playing->mips[0]; // a new frame, so the mixer fades to it
+        } else if (wts[slot].length == mixer->length) {
+            slots[slot] = wts[slot].data;
+        } else {
+            slots[slot] = NULL; // no table of the mixer's length, so the face is silent
+        }
+    }
+    // Faces past the slots play only the tables given with Mixer_set_face.
+    const float *tables[MIXER_MAX_FACES];
+    for (int f = 0; f < mixer->shape->faces; f++)
+        tables[f] = f < NUM_WAVETABLES ? slots[f] : NULL;
+    const float *premix = Mixer_update(mixer, tables, frames, live);
+    for (int slot = 0; slot < NUM_WAVETABLES; slot++) {
+        if (state->spectral[slot])
+            SpectralTable_release(state->spectral[slot]);
+    }
+    return premix;
+}
+
+// Samples in the table an oscillator on slot plays outside the mixer, which its phase counts.
+static size_t slot_length(const State *state, const Wavetable *wts, int slot) {
+    return state->spectral[slot] ? state->spectral[slot]->length : wts[slot].length;
+}
+
+// Table a reloaded slot plays at inc: its frame's mip, or the static table when frame is NULL.
+static const float *hot_table(const SpectralFrame *frame, const Wavetable *wt, double inc) {
+    return frame ? SpectralFrame_mip(frame, inc) : wt->data;
+}
+
+static void render_voices(State *state, const Wavetable *wts, const float *levels,
+                          const HotSlot *hot, DspInterp interp, float *out, int frames) {
+    DspOscFunc osc_interp = Dsp_osc(Dsp_get(), interp);
+    memset(out, 0, frames * sizeof(float));
+    if (state->mixer) {
+        // One premixed table per block: a voice costs the same whatever the face count.
+        const float *premix = render_premix(state, wts, hot, frames);
+        const Mixer *mixer = state->mixer;
+        size_t len = mixer->length;
+        float x = (float)mixer->fade / MIXER_FADE_FRAMES;
+        for (int voice = 0; voice < NUM_VOICES; voice++) {
+            if (!state->active[voice])
+                continue;
+            // Play from osc 0's place in the cycle and move every oscillator there, each in its
+            // own table's samples, so leaving the mixer picks up in step and in bounds.
+            Osc *oscs = &state->oscs[voice * NUM_OSCS];
+            double cycle = oscs[0].phase / slot_length(state, wts, oscs[0].wt_index);
+            double phase = cycle * len;
+            double inc = oscs[0].phase_inc * len / TABLE_SIZE;
+            if (mixer->fade < MIXER_FADE_FRAMES) {
+                double from = phase;
+                osc_interp(mixer->previous, len, &from, inc, 1.0f - x, out, frames);
+            }
+            osc_interp(premix, len, &phase, inc, x, out, frames);
+            for (int i = 0; i < NUM_OSCS; i++) {
+                size_t own = slot_length(state, wts, oscs[i].wt_index);
+                oscs[i].phase = phase / len * own;
+                if (oscs[i].phase >= own)
+                    oscs[i].phase -= own;
+            }
+        }
+        return;
+    }
+    for (int voice = 0; voice < NUM_VOICES; voice++) {
+        if (!state->active[voice])
+            continue;
+        for (int i = 0; i < NUM_OSCS; i++) {
+            Osc *osc = &state->oscs[voice * NUM_OSCS + i];
+            const Wavetable *wt = &wts[osc->wt_index];
+            SpectralTable *st = state->spectral[osc->wt_index];
+            float gain = levels[osc->wt_index] / NUM_OSCS;
+            if (st) {
+                const SpectralFrame *frame = SpectralTable_acquire(st);
+                double inc = osc->phase_inc * frame->length / TABLE_SIZE;
+                osc_interp(SpectralFrame_mip(frame, inc), frame->length, &osc->phase, inc, gain,
+                           out, frames);
+                SpectralTable_release(st);
+            } else if (hot && hot[osc->wt_index].playing) {
+                // Render the outgoing table from a copy of the phase, then the incoming one;
+                // both are the same length, so they stay in step. The fade steps per block.
+                const HotSlot *h = &hot[osc->wt_index];
+                double inc = osc->phase_inc * wt->length / TABLE_SIZE;
+                float x = (float)h->fade / RELOAD_FADE_FRAMES;
+                if (h->fade < RELOAD_FADE_FRAMES) {
+                    double phase = osc->phase;
+                    osc_interp(hot_table(h->previous, wt, inc), wt->length, &phase, inc,
+                               gain * (1.0f - x), out, frames);
+                } else {
+                    x = 1.0f;
+                }
+                osc_interp(hot_table(h->playing, wt, inc), wt->length, &osc->phase, inc,
+                           gain * x, out, frames);
+            } else {
+                double inc = osc->phase_inc * wt->length / TABLE_SIZE;
+                osc_interp(wt->data, wt->length, &osc->phase, inc, gain, out, frames);
+            }
+        }
+    }
+}
+
+// Move the lowpass onto the patch's precomputed coefficients, or back to the live settings,
+// without clearing its state.
+static void follow_patch_filter(State *state, const Patch *patch) {
+    unsigned long serial = patch ? patch->serial : 0;
+    if (serial == state->patch_serial)
+        return;
+    state->patch_serial = serial;
+    if (patch) {
+        Biquad_copy_coefficients(&state->lpf.biquad, &patch->filter);
+    } else {
+        BiquadFilter live;
+        Biquad_design_lowpass(&live, state->lpf.cutoff, state->lpf.q);
+        Biquad_copy_coefficients(&state->lpf.biquad, &live);
+    }
+}
+
+// Hand finished fades back and take offered tables; only pointer exchanges.
+static void update_hot_slots(State *state) {
+    for (int slot = 0; slot < NUM_WAVETABLES; slot++) {
+        HotSlot *hot = &state->hot[slot];
+        if (hot->fade < RELOAD_FADE_FRAMES)
+            continue;
+        if (hot->previous) {
+            // The mailbox is full until the last retired table has been collected.
+            SpectralFrame *empty = NULL;
+            if (!atomic_compare_exchange_strong(&hot->retired, &empty, hot->previous))
+                continue;
+            hot->previous = NULL;
+        }
+        SpectralFrame *next = atomic_exchange(&hot->pending, NULL);
+        if (next) {
+            hot->previous = hot->playing;
+            hot->playing = next;
+            hot->fade = 0;
+        }
+    }
+}
+
+static void advance_fades(State *state, int frames) {
+    for (int slot = 0; slot < NUM_WAVETABLES; slot++) {
+        HotSlot *hot = &state->hot[slot];
+        if (hot->fade < RELOAD_FADE_FRAMES)
+            hot->fade = hot->fade + frames < RELOAD_FADE_FRAMES ? hot->fade + frames
+                                                                : RELOAD_FADE_FRAMES;
+    }
+}
+
+void State_render(State *state, float *out, int frames) {
+    const Patch *patch = PatchSlot_enter(&state->patches);
+    follow_patch_filter(state, patch);
+    update_hot_slots(state);
+    // Patches bring their own tables; reloads apply to the live ones.
+    if (patch)
+        render_voices(state, patch->tables, patch->levels, NULL, patch->interp, out, frames);
+    else
+        render_voices(state, state->wts, state->wt_levels, state->hot, state->interp, out,
+                      frames);
+    advance_fades(state, frames);
+    PatchSlot_exit(&state->patches);
+}
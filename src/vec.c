@@ -1,6 +1,5 @@
 #include "vec.h"
 #include <assert.h>
-#include <criterion/criterion.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -58,10 +57,14 @@ void Vec_push_back(Vec *vec, const void *element) {
 }
 
 void Vec_get(const Vec *vec, size_t index, void *out_element) {
-    cr_assert(vec);
-    cr_assert(index < vec->size);
+    memcpy(out_element, Vec_at(vec, index), vec->element_size);
+}
+
+void *Vec_at(const Vec *vec, size_t index) {
+    assert(vec);
+    assert(index < vec->size);
 
-    memcpy(out_element, (char *)vec->data + index * vec->element_size, vec->element_size);
+    return (char *)vec->data + index * vec->element_size;
 }
 
 void Vec_set(Vec *vec, size_t index, const void *element) {
@@ -0,0 +1,114 @@
+#include "wav.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WAV_FORMAT_PCM 1
+#define WAV_FORMAT_FLOAT 3
+#define WAV_FORMAT_EXTENSIBLE 0xfffe
+
+static uint16_t read_u16(const unsigned char *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t read_u32(const unsigned char *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+static float decode_sample(const unsigned char *p, int format, int bits) {
+    if (format == WAV_FORMAT_FLOAT) {
+        if (bits == 32) {
+            uint32_t u = read_u32(p);
+            float f;
+            memcpy(&f, &u, sizeof(f));
+            return f;
+        }
+        uint64_t u = (uint64_t)read_u32(p) | ((uint64_t)read_u32(p + 4) << 32);
+        double d;
+        memcpy(&d, &u, sizeof(d));
+        return (float)d;
+    }
+    switch (bits) {
+    case 8:
+        return (p[0] - 128) / 128.0f;
+    case 16:
+        return (int16_t)read_u16(p) / 32768.0f;
+    case 24: {
+        int32_t v = (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24);
+        return (v >> 8) / 8388608.0f;
+    }
+    default:
+        return (int32_t)read_u32(p) / 2147483648.0f;
+    }
+}
+
+int Wav_read_mono(const char *filename, float **samples, size_t *length, int *sample_rate) {
+    FILE *f = fopen(filename, "rb");
+    if (!f)
+        return -1;
+    unsigned char header[12];
+    if (fread(header, 1, 12, f) != 12 || memcmp(header, "RIFF", 4) != 0 ||
+        memcmp(header + 8, "WAVE", 4) != 0) {
+        fclose(f);
+        return -1;
+    }
+    int format = 0, channels = 0, bits = 0, rate = 0;
+    unsigned char *data = NULL;
+    uint32_t data_size = 0;
+    unsigned char chunk[8];
+    while (fread(chunk, 1, 8, f) == 8) {
+        uint32_t size = read_u32(chunk + 4);
+        if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+            unsigned char fmt[40] = {0};
+            size_t want = size < sizeof(fmt) ? size : sizeof(fmt);
+            if (fread(fmt, 1, want, f) != want)
+                break;
+            format = read_u16(fmt);
+            channels = read_u16(fmt + 2);
+            rate = (int)read_u32(fmt + 4);
+            bits = read_u16(fmt + 14);
+            if (format == WAV_FORMAT_EXTENSIBLE && size >= 26)
+                format = read_u16(fmt + 24); // first two bytes of the subformat GUID
+            if (fseek(f, (long)(size - want + (size & 1)), SEEK_CUR) != 0)
+                break;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            data = malloc(size ? size : 1);
+            if (!data)
+                break;
+            // A truncated final chunk is common from recorders; keep what is there.
+            data_size = (uint32_t)fread(data, 1, size, f);
+            break;
+        } else if (fseek(f, (long)(size + (size & 1)), SEEK_CUR) != 0) {
+            break;
+        }
+    }
+    fclose(f);
+    int valid_format = (format == WAV_FORMAT_PCM && (bits == 8 || bits == 16 || bits == 24 ||
+                                                     bits == 32)) ||
+                       (format == WAV_FORMAT_FLOAT && (bits == 32 || bits == 64));
+    if (!data || !valid_format || channels <= 0 || rate <= 0) {
+        free(data);
+        return -1;
+    }
+    size_t frame_bytes = (size_t)channels * (bits / 8);
+    size_t frames = data_size / frame_bytes;
+    float *out = malloc((frames ? frames : 1) * sizeof(float));
+    if (!out) {
+        free(data);
+        return -1;
+    }
+    for (size_t i = 0; i < frames; i++) {
+        const unsigned char *frame = data + i * frame_bytes;
+        float sum = 0.0f;
+        for (int ch = 0; ch < channels; ch++)
+            sum += decode_sample(frame + ch * (bits / 8), format, bits);
+        out[i] = sum / channels;
+    }
+    free(data);
+    *samples = out;
+    *length = frames;
+    *sample_rate = rate;
+    return 0;
+}
@@ -1,8 +1,10 @@
 #include "wavetable.h"
 #include <assert.h>
 #include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 Wavetable *Wavetable_create(Waveform type, size_t length) {
     assert(length > 0);
@@ -48,6 +50,10 @@ void Wavetable_destroy(Wavetable *wt) {
 }
 
 int Wavetable_load(Wavetable *wt, const char *filename) {
+    return Wavetable_load_max(wt, filename, UINT32_MAX);
+}
+
+int Wavetable_load_max(Wavetable *wt, const char *filename, size_t max_length) {
     FILE *f = fopen(filename, "rb");
     if (!f) return -1;
     uint32_t length;
@@ -55,6 +61,15 @@ int Wavetable_load(Wavetable *wt, const char *filename) {
         fclose(f);
         return -1;
     }
+    // The header is untrusted: check it against the limit and the file before allocating.
+    long start = ftell(f);
+    long end = fseek(f, 0, SEEK_END) == 0 ? ftell(f) : -1;
+    if (length > max_length || start < 0 || end < 0 ||
+        (uint64_t)(end - start) < (uint64_t)length * sizeof(float) ||
+        fseek(f, start, SEEK_SET) != 0) {
+        fclose(f);
+        return -1;
+    }
     wt->length = length;
     wt->data = (float*)malloc(length * sizeof(float));
     if (!wt->data) {
@@ -63,9 +78,41 @@ int Wavetable_load(Wavetable *wt, const char *filename) {
     }
     if (fread(wt->data, sizeof(float), length, f) != length) {
         free(wt->data);
+        wt->data = NULL; // leave nothing for the caller to free twice
+        wt->length = 0;
         fclose(f);
         return -1;
     }
     fclose(f);
     return 0;
-}
\ No newline at end of file
+}
+
+// Same layout as save_wavetable_to_binary in resampler.py: little-endian uint32 length, then
+// little-endian float32 samples. Appending several records to one file makes a bank.
+int Wavetable_write(const Wavetable *wt, FILE *f) {
+    unsigned char bytes[4];
+    uint32_t length = (uint32_t)wt->length;
+    for (int b = 0; b < 4; b++)
+        bytes[b] = (unsigned char)(length >> (8 * b));
+    if (fwrite(bytes, 1, 4, f) != 4)
+        return -1;
+    for (size_t i = 0; i < wt->length; i++) {
+        uint32_t u;
+        memcpy(&u, &wt->data[i], sizeof(u));
+        for (int b = 0; b < 4; b++)
+            bytes[b] = (unsigned char)(u >> (8 * b));
+        if (fwrite(bytes, 1, 4, f) != 4)
+            return -1;
+    }
+    return 0;
+}
+
+int Wavetable_save(const Wavetable *wt, const char *filename) {
+    FILE *f = fopen(filename, "wb");
+    if (!f)
+        return -1;
+    int err = Wavetable_write(wt, f);
+    if (fclose(f) != 0)
+        err = -1;
+    return err;
+}
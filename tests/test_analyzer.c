@@ -0,0 +1,131 @@
+#include <criterion/criterion.h>
+#include "analyzer.h"
+#include <math.h>
+#include <time.h>
+
+static void pause_ms(int ms) {
+    struct timespec pause = {0, ms * 1000 * 1000};
+    nanosleep(&pause, NULL);
+}
+
+// Feed blocks of a sine (amplitude 0 for silence), waiting for room in the tap like a steady
+// audio callback would.
+static void feed(Analyzer *an, float hz, float amplitude, int blocks, double *phase) {
+    float block[BLOCK_SIZE];
+    for (int b = 0; b < blocks; b++) {
+        for (int i = 0; i < BLOCK_SIZE; i++) {
+            block[i] = amplitude * (float)sin(*phase);
+            *phase += 2.0 * M_PI * hz / SAMPLE_RATE;
+        }
+        while (SpscRing_AnalyzerBlock_size(&an->tap) >= ANALYZER_TAP_BLOCKS - 1)
+            pause_ms(1);
+        Analyzer_write(an, block, BLOCK_SIZE);
+    }
+}
+
+// Read until `expected` spectra have been produced in total.
+static int wait_spectra(Analyzer *an, int expected, float *bands, float *peaks) {
+    int seen = 0;
+    for (int tries = 0; tries < 2000 && seen < expected; tries++) {
+        seen += Analyzer_read(an, bands, peaks);
+        if (seen < expected)
+            pause_ms(1);
+    }
+    return seen;
+}
+
+static int spectra_for(int samples) {
+    return samples < ANALYZER_FFT_SIZE ? 0 : (samples - ANALYZER_FFT_SIZE) / ANALYZER_HOP + 1;
+}
+
+static int loudest(const float *bands) {
+    int best = 0;
+    for (int b = 1; b < ANALYZER_BANDS; b++) {
+        if (bands[b] > bands[best])
+            best = b;
+    }
+    return best;
+}
+
+Test(analyzer, sine_lands_in_its_band) {
+    Analyzer *an = Analyzer_create();
+    cr_assert_eq(Analyzer_start(an), 0);
+    float bands[ANALYZER_BANDS], peaks[ANALYZER_BANDS];
+    double phase = 0.0;
+    feed(an, 1000.0f, 1.0f, 16, &phase);
+    int expected = spectra_for(16 * BLOCK_SIZE);
+    cr_assert_eq(wait_spectra(an, expected, bands, peaks), expected);
+
+    int band = loudest(bands);
+    float ratio = Analyzer_band_hz(band) / 1000.0f;
+    float width = powf(ANALYZER_MAX_HZ / ANALYZER_MIN_HZ, 1.0f / ANALYZER_BANDS);
+    cr_assert(ratio > 1.0f / width && ratio < width, "band %d at %.0f Hz", band,
+              Analyzer_band_hz(band));
+    cr_assert_float_eq(bands[band], 0.0f, 1.5f, "full-scale sine reads 0 dB, got %.2f",
+                       bands[band]);
+    // A Hann window's leakage is far down two octaves away.
+    for (int b = 0; b < ANALYZER_BANDS; b++) {
+        float hz = Analyzer_band_hz(b);
+        if (hz < 250.0f || hz > 4000.0f)
+            cr_assert_lt(bands[b], -60.0f, "band at %.0f Hz reads %.1f dB", hz, bands[b]);
+    }
+    // The last spectrum's analysis was timed.
+    float ms = Analyzer_last_analysis_ms(an);
+    cr_assert(ms > 0.0f && isfinite(ms), "analysis took %f ms", ms);
+    Analyzer_destroy(an);
+}
+
+Test(analyzer, low_bands_read_between_bins) {
+    Analyzer *an = Analyzer_create();
+    cr_assert_eq(Analyzer_start(an), 0);
+    float bands[ANALYZER_BANDS], peaks[ANALYZER_BANDS];
+    double phase = 0.0;
+    feed(an, 50.0f, 0.5f, 16, &phase);
+    int expected = spectra_for(16 * BLOCK_SIZE);
+    cr_assert_eq(wait_spectra(an, expected, bands, peaks), expected);
+    // Bands here are narrower than a bin, so the loudest is within a bin of the tone.
+    int band = loudest(bands);
+    float bin_hz = (float)SAMPLE_RATE / ANALYZER_FFT_SIZE;
+    cr_assert_lt(fabsf(Analyzer_band_hz(band) - 50.0f), bin_hz, "band at %.1f Hz",
+                 Analyzer_band_hz(band));
+    cr_assert_float_eq(bands[band], -6.0f, 1.5f);
+    Analyzer_destroy(an);
+}
+
+Test(analyzer, peaks_hold_then_fall) {
+    Analyzer *an = Analyzer_create();
+    cr_assert_eq(Analyzer_start(an), 0);
+    float bands[ANALYZER_BANDS], peaks[ANALYZER_BANDS];
+    double phase = 0.0;
+    feed(an, 1000.0f, 1.0f, 16, &phase);
+    int produced = wait_spectra(an, spectra_for(16 * BLOCK_SIZE), bands, peaks);
+    int band = loudest(bands);
+
+    // Half a second of silence: the band is empty but its peak holds.
+    int quiet = SAMPLE_RATE / 2 / BLOCK_SIZE;
+    feed(an, 0.0f, 0.0f, quiet, &phase);
+    produced += wait_spectra(an, spectra_for((16 + quiet) * BLOCK_SIZE) - produced, bands, peaks);
+    cr_assert_eq(bands[band], ANALYZER_FLOOR_DB);
+    cr_assert_float_eq(peaks[band], 0.0f, 1.5f);
+
+    // Past the hold the peak falls at ANALYZER_FALL_DB a second.
+    feed(an, 0.0f, 0.0f, quiet * 2, &phase);
+    wait_spectra(an, spectra_for((16 + quiet * 3) * BLOCK_SIZE) - produced, bands, peaks);
+    cr_assert_lt(peaks[band], -ANALYZER_FALL_DB * 0.3f);
+    cr_assert_gt(peaks[band], -ANALYZER_FALL_DB * 0.7f);
+    Analyzer_destroy(an);
+}
+
+Test(analyzer, tap_ignores_writes_while_stopped) {
+    Analyzer *an = Analyzer_create();
+    float block[BLOCK_SIZE] = {0};
+    Analyzer_write(an, block, BLOCK_SIZE);
+    cr_assert_eq(SpscRing_AnalyzerBlock_size(&an->tap), 0);
+    cr_assert_eq(Analyzer_start(an), 0);
+    cr_assert(Analyzer_running(an));
+    Analyzer_stop(an);
+    cr_assert_not(Analyzer_running(an));
+    Analyzer_write(an, block, BLOCK_SIZE);
+    cr_assert_eq(SpscRing_AnalyzerBlock_size(&an->tap), 0);
+    Analyzer_destroy(an);
+}
@@ -0,0 +1,100 @@
+#include <criterion/criterion.h>
+#include "containers.h"
+#include <pthread.h>
+#include <sched.h>
+
+DECLARE_FIXED_VEC(int, Int4, 4)
+DECLARE_SMALL_VEC(int, Int2, 2)
+DECLARE_SPSC_RING(long, Long, 8)
+DECLARE_SPSC_RING(long, Wide, 1024)
+
+Test(containers, fixed_vec_is_bounded) {
+    FixedVec_Int4 v = {0};
+    for (int i = 0; i < 4; i++)
+        cr_assert_eq(FixedVec_Int4_push(&v, i * 10), 0);
+    cr_assert_eq(FixedVec_Int4_push(&v, 99), -1, "full");
+    cr_assert_null(FixedVec_Int4_emplace(&v));
+    cr_assert_eq(v.size, 4);
+
+    *FixedVec_Int4_at(&v, 2) += 5; // in place
+    cr_assert_eq(v.data[2], 25);
+    FixedVec_Int4_swap_remove(&v, 0);
+    cr_assert_eq(v.size, 3);
+    cr_assert_eq(*FixedVec_Int4_at(&v, 0), 30, "last element fills the gap");
+    cr_assert_eq(FixedVec_Int4_pop(&v), 25);
+}
+
+Test(containers, small_vec_reserves_once) {
+    SmallVec_Int2 small;
+    SmallVec_Int2_init(&small, 2);
+    cr_assert_null(small.heap);
+    cr_assert_eq(SmallVec_Int2_push(&small, 1), 0);
+    cr_assert_eq(SmallVec_Int2_push(&small, 2), 0);
+    cr_assert_eq(SmallVec_Int2_push(&small, 3), -1, "never grows");
+    cr_assert_eq(SmallVec_Int2_data(&small), small.local);
+    SmallVec_Int2_destroy(&small);
+
+    SmallVec_Int2 big;
+    SmallVec_Int2_init(&big, 100);
+    cr_assert_not_null(big.heap);
+    for (int i = 0; i < 100; i++)
+        cr_assert_eq(SmallVec_Int2_push(&big, i), 0);
+    int *first = SmallVec_Int2_at(&big, 0);
+    cr_assert_eq(SmallVec_Int2_push(&big, 100), -1);
+    cr_assert_eq(SmallVec_Int2_at(&big, 0), first, "elements stay where they are");
+    cr_assert_eq(*SmallVec_Int2_at(&big, 99), 99);
+    SmallVec_Int2_destroy(&big);
+}
+
+Test(containers, spsc_ring_wraps) {
+    SpscRing_Long ring;
+    SpscRing_Long_init(&ring);
+    long out;
+    cr_assert_eq(SpscRing_Long_pop(&ring, &out), -1, "empty");
+    for (long round = 0; round < 3; round++) {
+        for (long i = 0; i < 8; i++)
+            cr_assert_eq(SpscRing_Long_push(&ring, &(long){round * 8 + i}), 0);
+        cr_assert_null(SpscRing_Long_write_slot(&ring), "full");
+        cr_assert_eq(SpscRing_Long_size(&ring), 8);
+        for (long i = 0; i < 8; i++) {
+            cr_assert_eq(*SpscRing_Long_read_slot(&ring), round * 8 + i);
+            SpscRing_Long_release(&ring);
+        }
+    }
+    cr_assert_null(SpscRing_Long_read_slot(&ring));
+}
+
+#define RING_ITEMS 200000L
+
+static void *produce(void *arg) {
+    SpscRing_Wide *ring = arg;
+    for (long i = 0; i < RING_ITEMS;) {
+        long *slot = SpscRing_Wide_write_slot(ring);
+        if (!slot) {
+            sched_yield();
+            continue;
+        }
+        *slot = i++;
+        SpscRing_Wide_commit(ring);
+    }
+    return NULL;
+}
+
+Test(containers, spsc_ring_across_threads) {
+    SpscRing_Wide ring;
+    SpscRing_Wide_init(&ring);
+    pthread_t producer;
+    pthread_create(&producer, NULL, produce, &ring);
+    long expected = 0;
+    while (expected < RING_ITEMS) {
+        long value;
+        if (SpscRing_Wide_pop(&ring, &value) == 0) {
+            cr_assert_eq(value, expected, "items arrive once and in order");
+            expected++;
+        } else {
+            sched_yield();
+        }
+    }
+    pthread_join(producer, NULL);
+    cr_assert_eq(SpscRing_Wide_size(&ring), 0);
+}
@@ -0,0 +1,252 @@
+#include <criterion/criterion.h>
+#include "config.h"
+#include "control.h"
+#include "state.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+// Minimal OSC encoder for the tests.
+typedef struct {
+    unsigned char data[1024];
+    size_t size;
+} Packet;
+
+static void put_string(Packet *p, const char *s) {
+    size_t len = strlen(s);
+    memcpy(p->data + p->size, s, len);
+    size_t padded = (len + 4) & ~(size_t)3;
+    memset(p->data + p->size + len, 0, padded - len);
+    p->size += padded;
+}
+
+static void put_u32(Packet *p, uint32_t v) {
+    for (int b = 0; b < 4; b++)
+        p->data[p->size++] = (unsigned char)(v >> (24 - 8 * b));
+}
+
+static void put_float(Packet *p, float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    put_u32(p, bits);
+}
+
+static Packet message(const char *address, const char *tags, const int *ints,
+                      const float *floats) {
+    Packet p = {.size = 0};
+    put_string(&p, address);
+    put_string(&p, tags);
+    for (const char *t = tags + 1; *t; t++) {
+        if (*t == 'i')
+            put_u32(&p, (uint32_t)*ints++);
+        else
+            put_float(&p, *floats++);
+    }
+    return p;
+}
+
+static void bundle_add(Packet *bundle, const Packet *element) {
+    put_u32(bundle, (uint32_t)element->size);
+    memcpy(bundle->data + bundle->size, element->data, element->size);
+    bundle->size += element->size;
+}
+
+static Packet bundle(void) {
+    Packet p = {.size = 0};
+    put_string(&p, "#bundle");
+    put_u32(&p, 0);
+    put_u32(&p, 1); // "immediately"
+    return p;
+}
+
+Test(control, decodes_messages) {
+    CommandBatch batch = {.count = 0};
+    int query;
+    Packet note = message("/wave/note_on", ",if", (int[]){3}, (float[]){440.0f});
+    cr_assert_eq(Control_decode(note.data, note.size, &batch, &query), 1);
+    cr_assert_eq(batch.commands[0].type, COMMAND_NOTE_ON);
+    cr_assert_eq(batch.commands[0].target, 3);
+    cr_assert_float_eq(batch.commands[0].args[0], 440.0f, 0.0);
+    cr_assert_not(query);
+
+    Packet cursor = message("/wave/cursor", ",ff", NULL, (float[]){0.5f, -0.25f});
+    cr_assert_eq(Control_decode(cursor.data, cursor.size, &batch, &query), 1);
+    cr_assert_eq(batch.commands[1].target, 2);
+    cr_assert_float_eq(batch.commands[1].args[1], -0.25f, 0.0);
+
+    Packet interp = message("/wave/interp", ",i", (int[]){DSP_INTERP_SINC}, NULL);
+    cr_assert_eq(Control_decode(interp.data, interp.size, &batch, &query), 1);
+    cr_assert_eq(batch.commands[2].type, COMMAND_INTERP);
+    cr_assert_eq(batch.commands[2].target, DSP_INTERP_SINC);
+    Packet bad_mode = message("/wave/interp", ",i", (int[]){DSP_INTERP_COUNT}, NULL);
+    cr_assert_eq(Control_decode(bad_mode.data, bad_mode.size, &batch, &query), -1);
+
+    Packet latency = message("/wave/latency", ",", NULL, NULL);
+    cr_assert_eq(Control_decode(latency.data, latency.size, &batch, &query), 0);
+    cr_assert(query);
+}
+
+// One 64-bit float argument, which the encoder above does not write.
+static Packet double_message(const char *address, double value) {
+    Packet p = {.size = 0};
+    put_string(&p, address);
+    put_string(&p, ",d");
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put_u32(&p, (uint32_t)(bits >> 32));
+    put_u32(&p, (uint32_t)bits);
+    return p;
+}
+
+Test(control, rejects_out_of_range_values) {
+    CommandBatch batch = {.count = 0};
+    int query;
+    // Targets past the engine's voices and slots, or past int's range.
+    Packet voice = message("/wave/note_on", ",if", (int[]){NUM_VOICES}, (float[]){440.0f});
+    cr_assert_eq(Control_decode(voice.data, voice.size, &batch, &query), -1);
+    Packet negative = message("/wave/note_off", ",i", (int[]){-1}, NULL);
+    cr_assert_eq(Control_decode(negative.data, negative.size, &batch, &query), -1);
+    Packet slot = message("/wave/level", ",if", (int[]){NUM_WAVETABLES}, (float[]){0.5f});
+    cr_assert_eq(Control_decode(slot.data, slot.size, &batch, &query), -1);
+    Packet huge = message("/wave/note_on", ",ff", NULL, (float[]){3e38f, 440.0f});
+    cr_assert_eq(Control_decode(huge.data, huge.size, &batch, &query), -1);
+    Packet off = double_message("/wave/note_off", 1e300);
+    cr_assert_eq(Control_decode(off.data, off.size, &batch, &query), -1);
+    // Past float's range.
+    Packet cutoff = double_message("/wave/cutoff", 1e300);
+    cr_assert_eq(Control_decode(cutoff.data, cutoff.size, &batch, &query), -1);
+    cr_assert_eq(batch.count, 0);
+
+    // A float voice in range still names a voice.
+    Packet ok = message("/wave/note_on", ",ff", NULL, (float[]){2.0f, 440.0f});
+    cr_assert_eq(Control_decode(ok.data, ok.size, &batch, &query), 1);
+    cr_assert_eq(batch.commands[0].target, 2);
+    Packet d = double_message("/wave/cutoff", 800.0);
+    cr_assert_eq(Control_decode(d.data, d.size, &batch, &query), 1);
+    cr_assert_float_eq(batch.commands[1].args[0], 800.0f, 0.0);
+}
+
+Test(control, bundle_is_all_or_nothing) {
+    CommandBatch batch = {.count = 0};
+    int query;
+    Packet b = bundle();
+    Packet level = message("/wave/level", ",if", (int[]){1}, (float[]){0.5f});
+    Packet cutoff = message("/wave/cutoff", ",f", NULL, (float[]){800.0f});
+    Packet q = message("/wave/q", ",f", NULL, (float[]){0.7f});
+    bundle_add(&b, &level);
+    bundle_add(&b, &cutoff);
+    bundle_add(&b, &q);
+    cr_assert_eq(Control_decode(b.data, b.size, &batch, &query), 3);
+
+    Packet bad = message("/wave/nonsense", ",f", NULL, (float[]){1.0f});
+    bundle_add(&b, &bad);
+    cr_assert_eq(Control_decode(b.data, b.size, &batch, &query), -1);
+    cr_assert_eq(batch.count, 3, "a rejected packet adds nothing");
+    // Truncated argument.
+    cr_assert_eq(Control_decode(level.data, level.size - 4, &batch, &query), -1);
+}
+
+Test(control, queue_applies_and_drops) {
+    CommandQueue queue;
+    CommandQueue_init(&queue);
+    State *state = State_create();
+    CommandBatch *batch = CommandQueue_begin(&queue);
+    batch->commands[0] = (Command){COMMAND_NOTE_ON, 2, {220.0f}};
+    batch->commands[1] = (Command){COMMAND_LEVEL, 0, {0.25f}};
+    batch->commands[2] = (Command){COMMAND_CUTOFF, 0, {1000.0f}};
+    batch->commands[3] = (Command){COMMAND_REVERB, 1, {0.5f}};
+    batch->count = 4;
+    CommandQueue_push(&queue);
+    float decay = state->effects->decay;
+    CommandQueue_apply(&queue, state);
+    cr_assert_float_eq(state->effects->reverb_send, 0.5f, 0.0);
+    cr_assert_float_eq(state->effects->decay, decay, 0.0, "values left out are kept");
+    cr_assert(state->active[2]);
+    cr_assert_float_eq(state->wt_levels[0], 0.25f, 0.0);
+    cr_assert_float_eq(state->lpf.cutoff, 1000.0f, 0.0);
+    cr_assert_eq(atomic_load(&queue.applied), 4);
+    cr_assert_geq(atomic_load(&queue.last_latency_ms), 0.0f);
+
+    for (int i = 0; i < COMMAND_QUEUE_SIZE; i++) {
+        cr_assert_not_null(CommandQueue_begin(&queue));
+        CommandQueue_push(&queue);
+    }
+    cr_assert_null(CommandQueue_begin(&queue));
+    cr_assert_eq(atomic_load(&queue.dropped), 1);
+    State_destroy(state);
+}
+
+// What /wave/cursor does in headless mode: with --mixer it steers the mixer main attached at
+// startup, without one it changes nothing.
+Test(control, cursor_steers_attached_mixer) {
+    CommandQueue queue;
+    CommandQueue_init(&queue);
+    State *state = State_create();
+    Packet cursor = message("/wave/cursor", ",ff", NULL, (float[]){0.5f, -0.25f});
+    int query;
+    cr_assert_eq(Control_decode(cursor.data, cursor.size, CommandQueue_begin(&queue), &query), 1);
+    CommandQueue_push(&queue);
+    CommandQueue_apply(&queue, state);
+    cr_assert_null(state->mixer);
+
+    Mixer *mixer = Mixer_create(MixerShape_polygon(NUM_WAVETABLES), TABLE_SIZE);
+    State_set_mixer(state, mixer);
+    cr_assert_eq(Control_decode(cursor.data, cursor.size, CommandQueue_begin(&queue), &query), 1);
+    CommandQueue_push(&queue);
+    CommandQueue_apply(&queue, state);
+    cr_assert_float_eq(mixer->cursor[0], 0.5f, 0.0);
+    cr_assert_float_eq(mixer->cursor[1], -0.25f, 0.0);
+    float gains[MIXER_MAX_FACES];
+    Mixer_compute_gains(mixer->shape, (float[]){0.5f, -0.25f}, gains);
+    for (int f = 0; f < NUM_WAVETABLES; f++)
+        cr_assert_float_eq(mixer->target[f], gains[f], 1e-6);
+    State_destroy(state); // destroys the attached mixer
+}
+
+Test(control, server_batches_per_packet) {
+    CommandQueue queue;
+    CommandQueue_init(&queue);
+    ControlServer *server = ControlServer_start(&queue, 0);
+    cr_assert_not_null(server);
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)ControlServer_port(server));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    Packet b = bundle();
+    for (int voice = 0; voice < 4; voice++) {
+        float freq = 110.0f * (voice + 1);
+        Packet note = message("/wave/note_on", ",if", (int[]){voice}, (float[]){freq});
+        bundle_add(&b, &note);
+    }
+    sendto(fd, b.data, b.size, 0, (struct sockaddr *)&addr, sizeof(addr));
+    for (int tries = 0; tries < 200 && atomic_load(&queue.batches.write_pos) == 0; tries++) {
+        struct timespec pause = {0, 5 * 1000 * 1000};
+        nanosleep(&pause, NULL);
+    }
+    cr_assert_eq(atomic_load(&queue.batches.write_pos), 1, "one batch for the whole bundle");
+    cr_assert_eq(queue.batches.data[0].count, 4);
+
+    State *state = State_create();
+    CommandQueue_apply(&queue, state);
+    cr_assert_eq(State_active_voices(state), 4);
+
+    Packet query = message("/wave/latency", ",", NULL, NULL);
+    sendto(fd, query.data, query.size, 0, (struct sockaddr *)&addr, sizeof(addr));
+    struct timeval timeout = {2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    unsigned char reply[64];
+    ssize_t size = recv(fd, reply, sizeof(reply), 0);
+    cr_assert_eq(size, 40);
+    cr_assert_str_eq((const char *)reply, "/wave/latency");
+    cr_assert_eq(reply[35], 4, "applied count");
+
+    close(fd);
+    ControlServer_stop(server);
+    State_destroy(state);
+}
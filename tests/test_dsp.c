@@ -0,0 +1,227 @@
+#include <criterion/criterion.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "dsp.h"
+#include "filter.h"
+#include "wavetable.h"
+
+#define N 1000
+
+// Every ISA this CPU supports must match the scalar reference.
+
+Test(dsp, osc_interp_matches_scalar) {
+    const DspKernels *ref = Dsp_kernels_scalar();
+    Wavetable *wt = Wavetable_create(WAVEFORM_SAW, TABLE_SIZE);
+    const double incs[] = {0.37, 9.1, 300.5};
+    for (int isa = 0; isa < DSP_ISA_COUNT; isa++) {
+        const DspKernels *k = Dsp_get_isa(isa);
+        if (!k)
+            continue;
+        for (size_t t = 0; t < sizeof(incs) / sizeof(incs[0]); t++) {
+            float expected[N] = {0}, actual[N] = {0};
+            double phase_ref = 17.25, phase = 17.25;
+            ref->osc_interp(wt->data, wt->length, &phase_ref, incs[t], 0.5f, expected, N);
+            k->osc_interp(wt->data, wt->length, &phase, incs[t], 0.5f, actual, N);
+            for (int i = 0; i < N; i++) {
+                cr_assert_float_eq(actual[i], expected[i], 1e-3, "%s inc %f sample %d", k->name,
+                                   incs[t], i);
+            }
+            cr_assert_float_eq(phase, phase_ref, 1e-6, "%s final phase", k->name);
+        }
+    }
+    Wavetable_destroy(wt);
+}
+
+Test(dsp, osc_modes_match_scalar) {
+    const DspKernels *ref = Dsp_kernels_scalar();
+    Wavetable *wt = Wavetable_create(WAVEFORM_SAW, TABLE_SIZE);
+    // A short table sends the Hermite and sinc taps across the wrap every few samples.
+    float small[37];
+    for (int i = 0; i < 37; i++)
+        small[i] = sinf(2.0f * (float)M_PI * i / 37.0f);
+    const float *tables[] = {wt->data, small};
+    const size_t lengths[] = {wt->length, 37};
+    const double incs[] = {0.37, 9.1, 30.5};
+    for (int isa = 0; isa < DSP_ISA_COUNT; isa++) {
+        const DspKernels *k = Dsp_get_isa(isa);
+        if (!k)
+            continue;
+        for (int mode = DSP_INTERP_HERMITE; mode < DSP_INTERP_COUNT; mode++) {
+            for (int t = 0; t < 2; t++) {
+                for (size_t j = 0; j < sizeof(incs) / sizeof(incs[0]); j++) {
+                    float expected[N] = {0}, actual[N] = {0};
+                    double phase_ref = 17.25, phase = 17.25;
+                    Dsp_osc(ref, mode)(tables[t], lengths[t], &phase_ref, incs[j], 0.5f, expected,
+                                       N);
+                    Dsp_osc(k, mode)(tables[t], lengths[t], &phase, incs[j], 0.5f, actual, N);
+                    for (int i = 0; i < N; i++) {
+                        cr_assert_float_eq(actual[i], expected[i], 1e-3, "%s %s inc %f sample %d",
+                                           k->name, Dsp_interp_name(mode), incs[j], i);
+                    }
+                    cr_assert_float_eq(phase, phase_ref, 1e-6, "%s final phase", k->name);
+                }
+            }
+        }
+    }
+    Wavetable_destroy(wt);
+}
+
+// Harmonics up to 0.3 of the sample rate: each mode must beat the one below it.
+Test(dsp, interp_accuracy_ordering) {
+    const int harmonics = 320;
+    float table[TABLE_SIZE];
+    for (int i = 0; i < TABLE_SIZE; i++) {
+        double sum = 0.0;
+        for (int h = 1; h <= harmonics; h++)
+            sum += sin(2.0 * M_PI * h * i / TABLE_SIZE) / h;
+        table[i] = (float)sum;
+    }
+    double error[DSP_INTERP_COUNT] = {0};
+    for (double pos = 0.123; pos < TABLE_SIZE; pos += 0.731) {
+        double exact = 0.0;
+        for (int h = 1; h <= harmonics; h++)
+            exact += sin(2.0 * M_PI * h * pos / TABLE_SIZE) / h;
+        for (int mode = 0; mode < DSP_INTERP_COUNT; mode++) {
+            double d = Dsp_interp_sample(table, TABLE_SIZE, pos, mode) - exact;
+            error[mode] += d * d;
+        }
+    }
+    cr_assert_lt(error[DSP_INTERP_HERMITE], error[DSP_INTERP_LINEAR]);
+    cr_assert_lt(error[DSP_INTERP_SINC], error[DSP_INTERP_HERMITE] / 10.0);
+
+    // Every mode reproduces a constant and lands on the samples of a band-limited table.
+    float flat[16];
+    for (int i = 0; i < 16; i++)
+        flat[i] = 0.75f;
+    for (int mode = 0; mode < DSP_INTERP_COUNT; mode++) {
+        cr_assert_float_eq(Dsp_interp_sample(flat, 16, 3.4, mode), 0.75f, 1e-5, "%s",
+                           Dsp_interp_name(mode));
+        cr_assert_float_eq(Dsp_interp_sample(table, TABLE_SIZE, 100.0, mode), table[100], 1e-4,
+                           "%s", Dsp_interp_name(mode));
+    }
+}
+
+Test(dsp, biquad_block_matches_scalar) {
+    float input[N];
+    for (int i = 0; i < N; i++)
+        input[i] = sinf(i * 0.05f) + 0.3f * sinf(i * 1.7f);
+    for (int isa = 0; isa < DSP_ISA_COUNT; isa++) {
+        const DspKernels *k = Dsp_get_isa(isa);
+        if (!k)
+            continue;
+        BiquadFilter ref, f;
+        Biquad_design_lowpass(&ref, 800.0f, 0.7f);
+        Biquad_design_lowpass(&f, 800.0f, 0.7f);
+        float buf[N];
+        memcpy(buf, input, sizeof(buf));
+        // Uneven block sizes exercise state carried between calls.
+        int done = 0, sizes[] = {1, 2, 3, 61, 256, 677};
+        for (size_t b = 0; b < sizeof(sizes) / sizeof(sizes[0]); b++) {
+            k->biquad_block(&f, buf + done, sizes[b]);
+            done += sizes[b];
+        }
+        for (int i = 0; i < N; i++) {
+            float expected = Biquad_process(&ref, input[i]);
+            cr_assert_float_eq(buf[i], expected, 1e-4, "%s sample %d", k->name, i);
+        }
+    }
+}
+
+Test(dsp, mix_and_convert_match_scalar) {
+    const DspKernels *ref = Dsp_kernels_scalar();
+    float src[N];
+    for (int i = 0; i < N; i++)
+        src[i] = 1.5f * sinf(i * 0.01f);
+    for (int isa = 0; isa < DSP_ISA_COUNT; isa++) {
+        const DspKernels *k = Dsp_get_isa(isa);
+        if (!k)
+            continue;
+        float expected[N] = {0}, actual[N] = {0};
+        ref->mix_add(expected, src, 0.25f, N - 3);
+        k->mix_add(actual, src, 0.25f, N - 3);
+        for (int i = 0; i < N; i++)
+            cr_assert_float_eq(actual[i], expected[i], 1e-6, "%s mix sample %d", k->name, i);
+
+        int16_t s_ref[N], s_isa[N];
+        ref->convert_s16(src, s_ref, N);
+        k->convert_s16(src, s_isa, N);
+        for (int i = 0; i < N; i++)
+            cr_assert(abs(s_ref[i] - s_isa[i]) <= 1, "%s s16 sample %d", k->name, i);
+
+        // Odd lengths exercise the tails.
+        int32_t w_ref[N], w_isa[N];
+        ref->convert_s32(src, w_ref, DSP_S32_SCALE, N - 1);
+        k->convert_s32(src, w_isa, DSP_S32_SCALE, N - 1);
+        for (int i = 0; i < N - 1; i++)
+            cr_assert(llabs((long long)w_ref[i] - w_isa[i]) <= 128, "%s s32 sample %d",
+                      k->name, i);
+        cr_assert_eq(w_isa[157], (int32_t)DSP_S32_SCALE, "%s clips to full scale", k->name);
+
+        double d_isa[N];
+        k->convert_f64(src, d_isa, N - 5);
+        for (int i = 0; i < N - 5; i++)
+            cr_assert_eq(d_isa[i], (double)src[i], "%s f64 sample %d", k->name, i);
+    }
+}
+
+Test(dsp, hadamard8_matches_scalar) {
+    enum { FRAMES = 37 };
+    float input[FRAMES * 8];
+    for (int i = 0; i < FRAMES * 8; i++)
+        input[i] = sinf(i * 0.37f) + 0.1f * (i % 5);
+    float expected[FRAMES * 8];
+    memcpy(expected, input, sizeof(input));
+    Dsp_kernels_scalar()->hadamard8(expected, FRAMES);
+    // H * H = 8 I.
+    float twice[FRAMES * 8];
+    memcpy(twice, expected, sizeof(expected));
+    Dsp_kernels_scalar()->hadamard8(twice, FRAMES);
+    for (int i = 0; i < FRAMES * 8; i++)
+        cr_assert_float_eq(twice[i], 8.0f * input[i], 1e-4, "sample %d", i);
+    for (int isa = 0; isa < DSP_ISA_COUNT; isa++) {
+        const DspKernels *k = Dsp_get_isa(isa);
+        if (!k)
+            continue;
+        float actual[FRAMES * 8];
+        memcpy(actual, input, sizeof(input));
+        k->hadamard8(actual, FRAMES);
+        for (int i = 0; i < FRAMES * 8; i++)
+            cr_assert_float_eq(actual[i], expected[i], 1e-5, "%s value %d", k->name, i);
+    }
+}
+
+Test(dsp, detect_selects_supported) {
+    DspIsa isa = Dsp_detect();
+    cr_assert_not_null(Dsp_get_isa(isa));
+    cr_assert_not_null(Dsp_get());
+    cr_assert_not_null(Dsp_get_isa(DSP_ISA_SCALAR));
+}
+
+Test(dsp, biquad_tail_settles) {
+    LowpassFilter lpf;
+    Lowpass_init(&lpf);
+    Lowpass_set_cutoff(&lpf, 100.0f); // slow decay: the tail spans several blocks
+    float buf[BLOCK_SIZE] = {1.0f};
+    Lowpass_process_block(&lpf, buf, BLOCK_SIZE);
+    cr_assert_not(Lowpass_settle(&lpf, SILENCE_THRESHOLD), "an impulse tail is not silent yet");
+    int blocks = 0;
+    do {
+        memset(buf, 0, sizeof(buf));
+        Lowpass_process_block(&lpf, buf, BLOCK_SIZE);
+        blocks++;
+    } while (!Lowpass_settle(&lpf, SILENCE_THRESHOLD) && blocks < 1000);
+    cr_assert_lt(blocks, 1000);
+    cr_assert_eq(lpf.biquad.z1, 0.0f);
+    cr_assert_eq(lpf.biquad.z2, 0.0f);
+}
+
+Test(dsp, flush_denormals) {
+    Dsp_flush_denormals();
+#if defined(__SSE__) || defined(__aarch64__)
+    volatile float tiny = 1e-30f;
+    volatile float scale = 1e-10f;
+    cr_assert_eq(tiny * scale, 0.0f, "subnormal results flush to zero");
+#endif
+}
@@ -0,0 +1,86 @@
+#include <criterion/criterion.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dsp.h"
+#include "effects.h"
+
+#define SECONDS(s) ((int)((s) * SAMPLE_RATE))
+
+// Run n frames of in through fx a block at a time.
+static void run(Effects *fx, const float *in, float *left, float *right, int n) {
+    for (int done = 0; done < n; done += BLOCK_SIZE) {
+        int block = n - done < BLOCK_SIZE ? n - done : BLOCK_SIZE;
+        Effects_process(fx, in + done, left + done, right + done, block);
+    }
+}
+
+static double energy(const float *x, int from, int to) {
+    double sum = 0.0;
+    for (int i = from; i < to; i++)
+        sum += (double)x[i] * x[i];
+    return sum;
+}
+
+Test(effects, passes_dry_with_sends_off) {
+    Dsp_init();
+    Effects *fx = Effects_create();
+    cr_assert(Effects_settled(fx));
+    enum { N = 1000 };
+    float in[N], left[N], right[N];
+    for (int i = 0; i < N; i++)
+        in[i] = sinf(i * 0.05f);
+    run(fx, in, left, right, N);
+    for (int i = 0; i < N; i++) {
+        cr_assert_eq(left[i], in[i]);
+        cr_assert_eq(right[i], in[i]);
+    }
+    Effects_destroy(fx);
+}
+
+Test(effects, delay_ping_pongs) {
+    Dsp_init();
+    Effects *fx = Effects_create();
+    Effects_set_delay(fx, 1.0f, 0.01f, 0.5f);
+    const int d = SECONDS(0.01);
+    enum { N = 2048 };
+    static float in[N], left[N], right[N];
+    in[0] = 1.0f;
+    run(fx, in, left, right, N);
+    cr_assert_float_eq(left[d], 1.0f, 1e-5, "first echo on the left");
+    cr_assert_float_eq(right[d], 0.0f, 1e-5);
+    cr_assert_float_eq(right[2 * d], 0.5f, 1e-5, "second on the right");
+    cr_assert_float_eq(left[3 * d], 0.25f, 1e-5);
+    cr_assert_float_eq(energy(left, 1, d) + energy(right, 1, 2 * d), 0.0, 1e-12);
+    Effects_destroy(fx);
+}
+
+Test(effects, reverb_decays_at_rt60_and_settles) {
+    Dsp_init();
+    Effects *fx = Effects_create();
+    Effects_set_reverb(fx, 1.0f, 1.0f, 0.0f);
+    const int n = SECONDS(1.5);
+    float *in = calloc(n, sizeof(float));
+    float *left = malloc(n * sizeof(float)), *right = malloc(n * sizeof(float));
+    in[0] = 1.0f;
+    run(fx, in, left, right, n);
+    double early = energy(left, SECONDS(0.1), SECONDS(0.2)) +
+                   energy(right, SECONDS(0.1), SECONDS(0.2));
+    double late = energy(left, SECONDS(1.1), SECONDS(1.2)) +
+                  energy(right, SECONDS(1.1), SECONDS(1.2));
+    double drop_db = 10.0 * log10(early / late);
+    cr_assert(drop_db > 54.0 && drop_db < 66.0, "60 dB per second, got %.1f dB", drop_db);
+    // The two sides carry different lines.
+    cr_assert_gt(energy(left, 1, SECONDS(0.2)), 0.0);
+    cr_assert_neq(left[SECONDS(0.15)], right[SECONDS(0.15)]);
+
+    cr_assert_not(Effects_settled(fx));
+    memset(in, 0, n * sizeof(float));
+    for (int pass = 0; pass < 3 && !Effects_settled(fx); pass++)
+        run(fx, in, left, right, n);
+    cr_assert(Effects_settled(fx), "the tail dies away once the input is quiet");
+    free(in);
+    free(left);
+    free(right);
+    Effects_destroy(fx);
+}
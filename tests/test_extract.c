@@ -0,0 +1,86 @@
+#include <criterion/criterion.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "config.h"
+#include "extract.h"
+#include "fft.h"
+#include "wavetable.h"
+
+Test(fft, matches_naive_dft) {
+    const size_t sizes[] = {8, 12, 109, 1024};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t n = sizes[s];
+        FftComplex *data = malloc(n * sizeof(FftComplex));
+        for (size_t i = 0; i < n; i++)
+            data[i] = (FftComplex){sinf(i * 0.3f) + 0.1f * i / n, cosf(i * 1.1f)};
+        FftComplex *orig = malloc(n * sizeof(FftComplex));
+        memcpy(orig, data, n * sizeof(FftComplex));
+        Fft *fft = Fft_create(n);
+        Fft_forward(fft, data);
+        for (size_t k = 0; k < n; k += 7) {
+            double re = 0.0, im = 0.0;
+            for (size_t j = 0; j < n; j++) {
+                double angle = -2.0 * M_PI * (double)((j * k) % n) / n;
+                re += orig[j].re * cos(angle) - orig[j].im * sin(angle);
+                im += orig[j].re * sin(angle) + orig[j].im * cos(angle);
+            }
+            cr_assert_float_eq(data[k].re, re, 1e-3 * n, "size %zu bin %zu re", n, k);
+            cr_assert_float_eq(data[k].im, im, 1e-3 * n, "size %zu bin %zu im", n, k);
+        }
+        Fft_inverse(fft, data);
+        for (size_t i = 0; i < n; i++)
+            cr_assert_float_eq(data[i].re, orig[i].re, 1e-4, "size %zu roundtrip %zu", n, i);
+        Fft_destroy(fft);
+        free(data);
+        free(orig);
+    }
+}
+
+Test(extract, resample_sine_cycle) {
+    float cycle[109];
+    for (int i = 0; i < 109; i++)
+        cycle[i] = sinf(2.0f * M_PI * i / 109);
+    float table[TABLE_SIZE];
+    Extract_resample_fft(cycle, 109, table, TABLE_SIZE);
+    for (int i = 0; i < TABLE_SIZE; i++) {
+        float expected = sinf(2.0f * M_PI * i / TABLE_SIZE);
+        cr_assert_float_eq(table[i], expected, 1e-3, "sample %d", i);
+    }
+}
+
+Test(extract, detects_pitch) {
+    const int sr = 44100;
+    const size_t n = sr / 2;
+    float *note = malloc(n * sizeof(float));
+    for (size_t i = 0; i < n; i++) {
+        double t = (double)i / sr;
+        note[i] = (float)(0.6 * sin(2 * M_PI * 233.08 * t) + 0.3 * sin(2 * M_PI * 466.16 * t));
+    }
+    double freq = Extract_detect_pitch(note, 4000, sr, 50.0, 2000.0);
+    cr_assert_float_eq(freq, 233.08, 1.0, "detected %f", freq);
+
+    ExtractOptions opts = ExtractOptions_default();
+    Wavetable *wt = Extract_wavetable(note, n, sr, &opts, &freq);
+    cr_assert_not_null(wt);
+    cr_assert_eq(wt->length, TABLE_SIZE);
+    float peak = 0.0f;
+    for (size_t i = 0; i < wt->length; i++)
+        peak = fmaxf(peak, fabsf(wt->data[i]));
+    cr_assert_float_eq(peak, 1.0f, 1e-5, "table should be normalised");
+    Wavetable_destroy(wt);
+    free(note);
+}
+
+Test(extract, save_load_roundtrip) {
+    Wavetable *wt = Wavetable_create(WAVEFORM_SAW, TABLE_SIZE);
+    const char *path = "test_extract_roundtrip.bin";
+    cr_assert_eq(Wavetable_save(wt, path), 0);
+    Wavetable loaded;
+    cr_assert_eq(Wavetable_load(&loaded, path), 0);
+    cr_assert_eq(loaded.length, wt->length);
+    cr_assert_eq(memcmp(loaded.data, wt->data, wt->length * sizeof(float)), 0);
+    free(loaded.data);
+    remove(path);
+    Wavetable_destroy(wt);
+}
@@ -0,0 +1,90 @@
+#include <criterion/criterion.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "dsp.h"
+#include "golden.h"
+
+// Stored references live here; run with WAVE_GOLDEN_UPDATE=1 to regenerate them after an
+// intended change to the engine's semantics.
+#ifndef WAVE_GOLDEN_DIR
+#define WAVE_GOLDEN_DIR "tests/golden"
+#endif
+
+static double *load_reference(const GoldenScenario *sc) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s.f64", WAVE_GOLDEN_DIR, sc->name);
+    double *reference = malloc(sc->frames * sizeof(double));
+    cr_assert(reference);
+    const char *update = getenv("WAVE_GOLDEN_UPDATE");
+    if (update && *update == '1') {
+        Golden_render_reference(sc, reference);
+        cr_assert_eq(Golden_save(path, reference, sc->frames), 0, "cannot write %s", path);
+        return reference;
+    }
+    free(reference);
+    size_t n = 0;
+    cr_assert_eq(Golden_load(path, &reference, &n), 0, "missing %s", path);
+    cr_assert_eq(n, (size_t)sc->frames, "%s has %zu frames", path, n);
+    return reference;
+}
+
+Test(golden, reference_model_is_stable) {
+    // The stored files must still describe what the model renders; if this fails the model
+    // changed and the references need regenerating.
+    for (int s = 0; s < Golden_scenario_count(); s++) {
+        GoldenScenario sc;
+        Golden_scenario(s, &sc);
+        double *stored = load_reference(&sc);
+        double *fresh = malloc(sc.frames * sizeof(double));
+        Golden_render_reference(&sc, fresh);
+        for (int i = 0; i < sc.frames; i++)
+            cr_assert_float_eq(fresh[i], stored[i], 1e-9, "%s frame %d", sc.name, i);
+        free(fresh);
+        free(stored);
+    }
+}
+
+Test(golden, engine_matches_reference_on_every_isa) {
+    for (int s = 0; s < Golden_scenario_count(); s++) {
+        GoldenScenario sc;
+        Golden_scenario(s, &sc);
+        double *reference = load_reference(&sc);
+        float *out = malloc(sc.frames * sizeof(float));
+        for (int isa = 0; isa < DSP_ISA_COUNT; isa++) {
+            if (Dsp_select(isa) != 0)
+                continue;
+            GoldenStats stats;
+            Golden_render(&sc, out, 0);
+            Golden_compare(out, reference, sc.frames, &stats);
+            cr_assert(Golden_passes(&sc, &stats),
+                      "%s on %s: SNR %.1f dB, max error %g at frame %zu", sc.name,
+                      Dsp_isa_name(isa), stats.snr_db, stats.max_abs_error, stats.worst_frame);
+        }
+        Dsp_init();
+        GoldenStats stats;
+        Golden_render(&sc, out, 1);
+        Golden_compare(out, reference, sc.frames, &stats);
+        cr_assert(Golden_passes(&sc, &stats), "%s per sample: SNR %.1f dB, max error %g",
+                  sc.name, stats.snr_db, stats.max_abs_error);
+        free(out);
+        free(reference);
+    }
+}
+
+Test(golden, rejects_a_real_regression) {
+    GoldenScenario sc;
+    Golden_scenario(0, &sc);
+    double *reference = load_reference(&sc);
+    float *out = malloc(sc.frames * sizeof(float));
+    float *shifted = malloc(sc.frames * sizeof(float));
+    Golden_render(&sc, out, 0);
+    // A pitch error of a few cents is far outside the tolerance.
+    for (int i = 0; i < sc.frames; i++)
+        shifted[i] = out[(int)(i * 0.998)];
+    GoldenStats stats;
+    Golden_compare(shifted, reference, sc.frames, &stats);
+    cr_assert_not(Golden_passes(&sc, &stats), "SNR %.1f dB", stats.snr_db);
+    free(shifted);
+    free(out);
+    free(reference);
+}
@@ -0,0 +1,140 @@
+#include <criterion/criterion.h>
+#include "config.h"
+#include "dsp.h"
+#include "host.h"
+#include "state.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+Test(host, shared_states_share_tables) {
+    TablePool *pool = TablePool_create();
+    State *a = State_create_shared(pool);
+    State *b = State_create_shared(pool);
+    cr_assert_eq(atomic_load(&pool->refs), 3);
+    cr_assert_eq(a->wts, pool->wts);
+    cr_assert_eq(b->wts, pool->wts);
+    cr_assert_null(a->effects);
+    State_destroy(a);
+    State_destroy(b);
+    cr_assert_eq(atomic_load(&pool->refs), 1);
+    // A standalone State builds its own pool and effects.
+    State *own = State_create();
+    cr_assert_neq(own->wts, pool->wts);
+    cr_assert_not_null(own->effects);
+    State_destroy(own);
+    TablePool_release(pool);
+}
+
+// Build a pool in dir, where Trumpet.bin may or may not exist.
+static TablePool *pool_in(const char *dir) {
+    char cwd[512];
+    cr_assert_not_null(getcwd(cwd, sizeof(cwd)));
+    cr_assert_eq(chdir(dir), 0);
+    TablePool *pool = TablePool_create();
+    cr_assert_eq(chdir(cwd), 0);
+    return pool;
+}
+
+Test(host, pool_loads_trumpet_or_keeps_triangle) {
+    char dir[] = "/tmp/wave-pool-XXXXXX";
+    cr_assert_not_null(mkdtemp(dir));
+    TablePool *pool = pool_in(dir);
+    const Wavetable *slot = &pool->wts[WAVEFORM_TRIANGLE];
+    cr_assert_eq(slot->length, TABLE_SIZE);
+    cr_assert_float_eq(slot->data[TABLE_SIZE / 4], 0.0f, 1e-6, "a triangle, not silence");
+    cr_assert_float_eq(slot->data[TABLE_SIZE / 2], 1.0f, 1e-6);
+    TablePool_release(pool);
+
+    char path[64];
+    snprintf(path, sizeof(path), "%s/Trumpet.bin", dir);
+    Wavetable *trumpet = Wavetable_create(WAVEFORM_SAW, 600);
+    cr_assert_eq(Wavetable_save(trumpet, path), 0);
+    pool = pool_in(dir);
+    slot = &pool->wts[WAVEFORM_TRIANGLE];
+    cr_assert_eq(slot->length, 600);
+    cr_assert_eq(memcmp(slot->data, trumpet->data, 600 * sizeof(float)), 0);
+    TablePool_release(pool);
+
+    // A truncated file leaves the triangle.
+    FILE *f = fopen(path, "wb");
+    uint32_t length = 600;
+    fwrite(&length, sizeof(length), 1, f);
+    fwrite(trumpet->data, sizeof(float), 10, f);
+    fclose(f);
+    pool = pool_in(dir);
+    cr_assert_eq(pool->wts[WAVEFORM_TRIANGLE].length, TABLE_SIZE);
+    TablePool_release(pool);
+
+    Wavetable_destroy(trumpet);
+    remove(path);
+    rmdir(dir);
+}
+
+Test(host, engines_render_like_a_standalone_state) {
+    Dsp_init();
+    enum { ENGINES = 5, BLOCKS = 8 };
+    Host *host = Host_create(NULL, NULL, 2, 8);
+    cr_assert_not_null(host);
+    State *reference[ENGINES];
+    int engines[ENGINES];
+    for (int i = 0; i < ENGINES; i++) {
+        engines[i] = Host_add(host);
+        cr_assert_geq(engines[i], 0);
+        reference[i] = State_create();
+        double freq = 110.0 * (i + 1);
+        State_set_note(Host_state(host, engines[i]), i, freq);
+        State_set_note(reference[i], i, freq);
+    }
+    // Least loaded first: five engines split three and two.
+    cr_assert_eq(host->workers[0].engines + host->workers[1].engines, ENGINES);
+    cr_assert_leq(abs(host->workers[0].engines - host->workers[1].engines), 1);
+
+    float mix[BLOCK_SIZE], expected[BLOCK_SIZE], sum[BLOCK_SIZE];
+    for (int b = 0; b < BLOCKS; b++) {
+        Host_render(host, mix, BLOCK_SIZE);
+        memset(sum, 0, sizeof(sum));
+        for (int i = 0; i < ENGINES; i++) {
+            State_render(reference[i], expected, BLOCK_SIZE);
+            Lowpass_process_block(&reference[i]->lpf, expected, BLOCK_SIZE);
+            const float *out = Host_output(host, engines[i]);
+            for (int j = 0; j < BLOCK_SIZE; j++) {
+                cr_assert_eq(out[j], expected[j], "engine %d block %d sample %d", i, b, j);
+                sum[j] += out[j];
+            }
+        }
+        for (int j = 0; j < BLOCK_SIZE; j++)
+            cr_assert_float_eq(mix[j], sum[j], 1e-6);
+    }
+    for (int i = 0; i < ENGINES; i++)
+        State_destroy(reference[i]);
+    Host_destroy(host);
+}
+
+Test(host, removed_engines_free_their_slot) {
+    TablePool *pool = TablePool_create();
+    // CPU -1 cannot be pinned to; the worker runs anyway.
+    int cores[2] = {0, -1};
+    Host *host = Host_create(pool, cores, 2, 2);
+    cr_assert_not_null(host);
+    cr_assert_eq(host->workers[1].core, -1);
+    int a = Host_add(host), b = Host_add(host);
+    cr_assert_eq(Host_add(host), -1);
+    cr_assert_eq(Host_engines(host), 2);
+    cr_assert_eq(atomic_load(&pool->refs), 4); // caller, host and two engines
+    Host_remove(host, a);
+    cr_assert_null(Host_state(host, a));
+    cr_assert_eq(Host_engines(host), 1);
+    cr_assert_eq(Host_add(host), a);
+    // An idle engine renders silence.
+    float mix[BLOCK_SIZE];
+    Host_render(host, mix, BLOCK_SIZE);
+    for (int j = 0; j < BLOCK_SIZE; j++)
+        cr_assert_eq(mix[j], 0.0f);
+    cr_assert_eq(Host_output(host, b)[0], 0.0f);
+    Host_destroy(host);
+    cr_assert_eq(atomic_load(&pool->refs), 1);
+    TablePool_release(pool);
+}
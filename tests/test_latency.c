@@ -0,0 +1,252 @@
+#include <criterion/criterion.h>
+#include <string.h>
+#include <time.h>
+#include "audio.h"
+#include "config.h"
+#include "latency.h"
+#include <soundio/soundio.h>
+
+// Run whole windows at a fixed load, reporting underflows per window; returns the latency
+// the manager settles on.
+static double run_windows(LatencyManager *lm, double *now, int windows, int voices,
+                          float load, int underflows_per_window) {
+    for (int w = 0; w < windows; w++) {
+        LatencyManager_report_callback(lm, load * 0.01, 0.01);
+        for (int u = 0; u < underflows_per_window; u++)
+            LatencyManager_report_underflow(lm);
+        *now += LATENCY_WINDOW;
+        LatencyManager_evaluate(lm, voices, *now);
+    }
+    return LatencyManager_latency(lm);
+}
+
+Test(latency, steps_cover_range) {
+    LatencyManager lm;
+    LatencyManager_init(&lm, 0.002, 0.1);
+    cr_assert_eq(lm.steps, 6); // 2, 4, 8, 16, 32, 64 ms
+    cr_assert_float_eq(LatencyManager_latency(&lm), 0.002, 1e-12);
+}
+
+Test(latency, grows_on_underflow_and_settles) {
+    LatencyManager lm;
+    LatencyManager_init(&lm, 0.002, 0.1);
+    double now = 0.0;
+    LatencyManager_evaluate(&lm, 4, now);
+    // Underflows while the first window settles are ignored.
+    cr_assert_float_eq(run_windows(&lm, &now, 1, 4, 0.2f, 3), 0.002, 1e-12);
+    // Persistent underflows walk the buffer up, one step per window.
+    cr_assert_float_eq(run_windows(&lm, &now, 1, 4, 0.2f, 1), 0.004, 1e-12);
+    run_windows(&lm, &now, 1, 4, 0.2f, 1); // settling after the reopen
+    cr_assert_float_eq(run_windows(&lm, &now, 1, 4, 0.2f, 1), 0.008, 1e-12);
+    // Clean from here on: it must not drop back to a buffer that failed at this load.
+    cr_assert_float_eq(run_windows(&lm, &now, 50, 4, 0.2f, 0), 0.008, 1e-12);
+    cr_assert_eq(lm.total_underflows, 2);
+}
+
+Test(latency, shrinks_when_load_drops) {
+    LatencyManager lm;
+    LatencyManager_init(&lm, 0.002, 0.1);
+    double now = 0.0;
+    LatencyManager_evaluate(&lm, 8, now);
+    run_windows(&lm, &now, 1, 8, 0.2f, 0);
+    run_windows(&lm, &now, 1, 8, 0.2f, 1);
+    cr_assert_float_eq(LatencyManager_latency(&lm), 0.004, 1e-12);
+    // Fewer voices than the step failed with: the smaller buffer is worth another try.
+    cr_assert_float_eq(run_windows(&lm, &now, 20, 2, 0.1f, 0), 0.002, 1e-12);
+}
+
+Test(latency, grows_on_high_load) {
+    LatencyManager lm;
+    LatencyManager_init(&lm, 0.002, 0.1);
+    double now = 0.0;
+    LatencyManager_evaluate(&lm, 1, now);
+    run_windows(&lm, &now, 1, 1, 0.2f, 0);
+    cr_assert_float_eq(run_windows(&lm, &now, 1, 1, 0.95f, 0), 0.004, 1e-12);
+    // Moderate load holds the buffer where it is.
+    cr_assert_float_eq(run_windows(&lm, &now, 20, 1, 0.6f, 0), 0.004, 1e-12);
+}
+
+static void count_blocks(void *userdata, float *left, float *right, int n) {
+    for (int i = 0; i < n; i++)
+        left[i] = right[i] = 0.0f;
+    __atomic_add_fetch((int *)userdata, 1, __ATOMIC_RELAXED);
+}
+
+Test(latency, dummy_backend_reopens) {
+    AudioOutput audio;
+    int callbacks = 0;
+    AudioConfig config = {.type = AUDIO_BACKEND_SOUNDIO, .soundio_backend = SoundIoBackendDummy};
+    cr_assert_eq(AudioOutput_open(&audio, &config, count_blocks, &callbacks), 0);
+    struct timespec pause = {0, 100 * 1000 * 1000};
+    nanosleep(&pause, NULL);
+    cr_assert_gt(__atomic_load_n(&callbacks, __ATOMIC_RELAXED), 0);
+    double before = AudioOutput_latency(&audio);
+    cr_assert_gt(before, 0.0);
+
+    cr_assert_eq(AudioOutput_set_latency(&audio, 0.05), 0);
+    cr_assert_float_eq(AudioOutput_latency(&audio), 0.05, 1e-3);
+    __atomic_store_n(&callbacks, 0, __ATOMIC_RELAXED);
+    nanosleep(&pause, NULL);
+    cr_assert_gt(__atomic_load_n(&callbacks, __ATOMIC_RELAXED), 0, "stream runs after reopen");
+
+    // An idle stream is well inside its deadline, so tuning never grows the buffer.
+    AudioOutput_set_latency(&audio, LatencyManager_latency(&audio.latency));
+    for (int i = 0; i < 10; i++) {
+        nanosleep(&pause, NULL);
+        AudioOutput_tune(&audio, 0);
+    }
+    cr_assert_leq(AudioOutput_latency(&audio), before + 1e-3);
+    AudioOutput_close(&audio);
+}
+
+typedef struct {
+    int blocks, frames, smallest, largest;
+    int sleep_us; // per block, to overrun the period
+} NullLoad;
+
+static void measure_blocks(void *userdata, float *left, float *right, int n) {
+    (void)left;
+    (void)right;
+    NullLoad *load = userdata;
+    load->blocks++;
+    load->frames += n;
+    if (n < load->smallest)
+        load->smallest = n;
+    if (n > load->largest)
+        load->largest = n;
+    if (load->sleep_us) {
+        struct timespec pause = {0, load->sleep_us * 1000L};
+        nanosleep(&pause, NULL);
+    }
+}
+
+Test(latency, null_clock_keeps_time) {
+    AudioOutput audio;
+    NullLoad load = {0, 0, BLOCK_SIZE + 1, 0, 0};
+    // 480 frames: one full block and one short one per period.
+    AudioConfig config = {.type = AUDIO_BACKEND_NULL, .period = 0.01, .realtime = 1};
+    cr_assert_eq(AudioOutput_open(&audio, &config, measure_blocks, &load), 0);
+    cr_assert_float_eq(AudioOutput_latency(&audio), 0.01, 1e-9);
+    struct timespec pause = {0, 300 * 1000 * 1000};
+    nanosleep(&pause, NULL);
+    AudioOutput_close(&audio);
+    // The render thread has been joined, so load is safe to read.
+    cr_assert_eq(load.largest, BLOCK_SIZE);
+    cr_assert_eq(load.smallest, 480 - BLOCK_SIZE);
+    cr_assert_eq(load.frames, (int)atomic_load(&audio.callbacks) * 480);
+    // About 300 ms of audio, allowing for a slow machine.
+    cr_assert(load.frames > SAMPLE_RATE * 0.15 && load.frames < SAMPLE_RATE * 0.4,
+              "%d frames", load.frames);
+}
+
+Test(latency, null_clock_reports_overruns) {
+    AudioOutput audio;
+    NullLoad load = {0, 0, BLOCK_SIZE + 1, 0, 8000}; // 8 ms to render 5.3 ms
+    AudioConfig config = {.type = AUDIO_BACKEND_NULL, .period = (double)BLOCK_SIZE / SAMPLE_RATE};
+    cr_assert_eq(AudioOutput_open(&audio, &config, measure_blocks, &load), 0);
+    struct timespec pause = {0, 100 * 1000 * 1000};
+    nanosleep(&pause, NULL);
+    unsigned long xruns = atomic_load(&audio.xruns);
+    cr_assert_gt(xruns, 0);
+    cr_assert_gt(atomic_load(&audio.latency.underflows), 0, "the latency manager hears of them");
+    cr_assert_gt(atomic_load(&audio.latency.peak_load), 1.0f);
+    AudioOutput_close(&audio);
+}
+
+Test(latency, null_clock_reopens) {
+    AudioOutput audio;
+    int callbacks = 0;
+    AudioConfig config = {.type = AUDIO_BACKEND_NULL};
+    cr_assert_eq(AudioOutput_open(&audio, &config, count_blocks, &callbacks), 0);
+    cr_assert_float_eq(AudioOutput_latency(&audio), LatencyManager_latency(&audio.latency), 1e-4);
+    cr_assert_eq(AudioOutput_set_latency(&audio, 0.02), 0);
+    cr_assert_float_eq(AudioOutput_latency(&audio), 0.02, 1e-9);
+    __atomic_store_n(&callbacks, 0, __ATOMIC_RELAXED);
+    struct timespec pause = {0, 100 * 1000 * 1000};
+    nanosleep(&pause, NULL);
+    cr_assert_gt(__atomic_load_n(&callbacks, __ATOMIC_RELAXED), 0, "clock runs after reopen");
+    AudioOutput_close(&audio);
+}
+
+Test(latency, backends_by_name) {
+    cr_assert_eq(Audio_backend_parse("null"), AUDIO_BACKEND_NULL);
+    cr_assert_eq(Audio_backend_parse("jack"), AUDIO_BACKEND_JACK);
+    cr_assert_eq(Audio_backend_parse("alsa"), -1);
+    cr_assert_str_eq(Audio_backend(AUDIO_BACKEND_SOUNDIO)->name, "soundio");
+    if (!Audio_jack_backend()) {
+        AudioOutput audio;
+        AudioConfig config = {.type = AUDIO_BACKEND_JACK};
+        cr_assert_eq(AudioOutput_open(&audio, &config, count_blocks, NULL), -1);
+    }
+}
+
+// A device that refuses buffers above largest, or every buffer once broken is set.
+typedef struct {
+    double largest;
+    double running; // latency it is streaming at, 0 when stopped
+    int broken;
+} FakeDevice;
+
+static int fake_start(AudioOutput *audio, double seconds) {
+    FakeDevice *device = audio->impl;
+    if (device->broken || seconds > device->largest)
+        return 7;
+    device->running = seconds;
+    return 0;
+}
+
+static void fake_stop(AudioOutput *audio) {
+    ((FakeDevice *)audio->impl)->running = 0.0;
+}
+
+static double fake_latency(const AudioOutput *audio) {
+    return ((const FakeDevice *)audio->impl)->running;
+}
+
+static const AudioBackend fake_backend = {
+    .name = "fake",
+    .start = fake_start,
+    .stop = fake_stop,
+    .latency = fake_latency,
+};
+
+static void open_fake(AudioOutput *audio, FakeDevice *device) {
+    memset(audio, 0, sizeof(*audio));
+    audio->backend = &fake_backend;
+    audio->impl = device;
+    LatencyManager_init(&audio->latency, 0.002, 0.016);
+    cr_assert_eq(fake_start(audio, 0.002), 0);
+    // Past the first window, so an underflow grows the buffer at once.
+    audio->latency.window_start = 0.0;
+    audio->latency.settling = 0;
+}
+
+Test(latency, refused_latency_rolls_back) {
+    AudioOutput audio;
+    FakeDevice device = {.largest = 0.003};
+    open_fake(&audio, &device);
+    LatencyManager_report_underflow(&audio.latency);
+    cr_assert_eq(AudioOutput_tune(&audio, 1), 0);
+    cr_assert_float_eq(device.running, 0.002, 1e-12, "restarted at the old latency");
+    cr_assert_eq(audio.latency.step, 0);
+    // The refused buffer is no longer offered.
+    audio.latency.settling = 0;
+    LatencyManager_report_underflow(&audio.latency);
+    cr_assert_eq(AudioOutput_tune(&audio, 1), 0);
+    cr_assert_eq(audio.latency.steps, 1);
+    cr_assert_float_eq(device.running, 0.002, 1e-12);
+
+    cr_assert_eq(AudioOutput_set_latency(&audio, 0.008), 7);
+    cr_assert_float_eq(device.running, 0.002, 1e-12);
+}
+
+Test(latency, failed_restart_reports_stopped) {
+    AudioOutput audio;
+    FakeDevice device = {.largest = 1.0};
+    open_fake(&audio, &device);
+    device.broken = 1;
+    LatencyManager_report_underflow(&audio.latency);
+    cr_assert_eq(AudioOutput_tune(&audio, 1), -1);
+    cr_assert_eq(device.running, 0.0);
+    cr_assert_eq(audio.latency.step, 0);
+}
@@ -0,0 +1,196 @@
+#include <criterion/criterion.h>
+#include "dsp.h"
+#include "config.h"
+#include "mixer.h"
+#include "state.h"
+
+Test(mixer, centre_mixes_evenly) {
+    Dsp_init();
+    MixerShape *square = MixerShape_polygon(4);
+    float gains[4];
+    float centre[2] = {0.0f, 0.0f};
+    Mixer_compute_gains(square, centre, gains);
+    for (int f = 0; f < 4; f++)
+        cr_assert_float_eq(gains[f], 0.25f, 1e-6);
+    MixerShape_destroy(square);
+}
+
+Test(mixer, face_dominates_near_it) {
+    Dsp_init();
+    Mixer *mixer = Mixer_create(MixerShape_polygon(4), 16);
+    // Face 0's normal points along +x; pushing past it clamps the cursor onto the face.
+    float position[2] = {5.0f, 0.0f};
+    Mixer_set_cursor(mixer, position);
+    cr_assert_float_eq(mixer->cursor[0], 1.0f, 1e-6);
+    for (int f = 1; f < 4; f++)
+        cr_assert_gt(mixer->target[0], mixer->target[f]);
+    cr_assert_float_eq(mixer->target[2], 0.0f, 1e-6);
+    Mixer_destroy(mixer);
+}
+
+Test(mixer, hypercube_faces) {
+    MixerShape *cube = MixerShape_hypercube(4);
+    cr_assert_eq(cube->dims, 4);
+    cr_assert_eq(cube->faces, 8);
+    MixerShape_destroy(cube);
+}
+
+Test(mixer, premix_is_weighted_sum) {
+    Dsp_init();
+    enum { LENGTH = 64 };
+    float data[3][LENGTH];
+    for (int f = 0; f < 3; f++) {
+        for (int i = 0; i < LENGTH; i++)
+            data[f][i] = (float)(f + 1) * (i % 7 - 3);
+    }
+    const float *tables[3] = {data[0], data[1], data[2]};
+    Mixer *mixer = Mixer_create(MixerShape_polygon(3), LENGTH);
+    float position[2] = {0.3f, -0.2f};
+    Mixer_set_cursor(mixer, position);
+    // Let the smoothing settle, then check against the target gains.
+    const float *premix = NULL;
+    for (int block = 0; block < 1000; block++)
+        premix = Mixer_update(mixer, tables, 256, 0);
+    for (int i = 0; i < LENGTH; i++) {
+        float expected = 0.0f;
+        for (int f = 0; f < 3; f++)
+            expected += mixer->target[f] * data[f][i];
+        cr_assert_float_eq(premix[i], expected, 1e-4, "sample %d", i);
+    }
+    Mixer_destroy(mixer);
+}
+
+Test(mixer, smoothing_glides) {
+    Dsp_init();
+    float data[4][8] = {{0}};
+    const float *tables[4] = {data[0], data[1], data[2], data[3]};
+    Mixer *mixer = Mixer_create(MixerShape_polygon(4), 8);
+    Mixer_update(mixer, tables, 256, 0);
+    float position[2] = {1.0f, 0.0f};
+    Mixer_set_cursor(mixer, position);
+    Mixer_update(mixer, tables, 256, 0);
+    // One block moves part of the way, never past the target.
+    cr_assert_gt(mixer->gains[0], 0.25f);
+    cr_assert_lt(mixer->gains[0], mixer->target[0]);
+    for (int block = 0; block < 1000; block++)
+        Mixer_update(mixer, tables, 256, 0);
+    cr_assert_eq(mixer->gains[0], mixer->target[0]);
+    Mixer_destroy(mixer);
+}
+
+Test(mixer, mismatched_slots_are_silent) {
+    Dsp_init();
+    // Twice the length of every table: the state must not read past them.
+    State *state = State_create();
+    State_set_mixer(state, Mixer_create(MixerShape_polygon(4), 2 * TABLE_SIZE));
+    State_set_note(state, 0, 440.0);
+    float out[BLOCK_SIZE];
+    for (int block = 0; block < 4; block++) {
+        State_render(state, out, BLOCK_SIZE);
+        for (int i = 0; i < BLOCK_SIZE; i++)
+            cr_assert_eq(out[i], 0.0f, "block %d sample %d", block, i);
+    }
+    State_destroy(state);
+}
+
+Test(mixer, faces_past_the_slots_play_their_own_tables) {
+    Dsp_init();
+    State *state = State_create();
+    Mixer *mixer = Mixer_create(MixerShape_polygon(6), TABLE_SIZE);
+    float ones[TABLE_SIZE];
+    for (int i = 0; i < TABLE_SIZE; i++)
+        ones[i] = 1.0f;
+    Mixer_set_face(mixer, 5, ones);
+    State_set_mixer(state, mixer);
+    float position[2] = {0.5f, -0.5f}; // between faces 5 and 0
+    Mixer_set_cursor(mixer, position);
+    State_set_note(state, 0, 440.0);
+    float out[BLOCK_SIZE];
+    for (int block = 0; block < 1000; block++)
+        State_render(state, out, BLOCK_SIZE);
+    // Face 4 has neither a slot nor a table of its own, so it adds nothing.
+    for (int i = 0; i < TABLE_SIZE; i++) {
+        float expected = mixer->target[5];
+        for (int f = 0; f < 4; f++)
+            expected += mixer->target[f] * state->wts[f].data[i];
+        cr_assert_float_eq(mixer->premix[i], expected, 1e-4, "sample %d", i);
+    }
+    State_destroy(state);
+}
+
+Test(mixer, oscillators_stay_in_step) {
+    Dsp_init();
+    State *state = State_create();
+    Mixer *mixer = Mixer_create(MixerShape_polygon(4), 2 * TABLE_SIZE);
+    State_set_mixer(state, mixer);
+    State_set_note(state, 0, 440.0);
+    float out[BLOCK_SIZE];
+    for (int block = 0; block < 7; block++)
+        State_render(state, out, BLOCK_SIZE);
+    // Each phase counts its own table's samples, whatever the mixer's length.
+    const Osc *oscs = state->oscs;
+    double cycle = oscs[0].phase / state->wts[oscs[0].wt_index].length;
+    cr_assert_gt(cycle, 0.0);
+    for (int i = 0; i < NUM_OSCS; i++) {
+        size_t length = state->wts[oscs[i].wt_index].length;
+        cr_assert_lt(oscs[i].phase, (double)length);
+        cr_assert_float_eq(oscs[i].phase / length, cycle, 1e-9, "osc %d", i);
+    }
+    State_set_mixer(state, NULL);
+    Mixer_destroy(mixer);
+    State_render(state, out, BLOCK_SIZE);
+    State_destroy(state);
+}
+
+Test(mixer, published_patch_rebuilds_premix) {
+    Dsp_init();
+    State *state = State_create();
+    Mixer *mixer = Mixer_create(MixerShape_polygon(4), TABLE_SIZE);
+    State_set_mixer(state, mixer);
+    float out[BLOCK_SIZE];
+    State_render(state, out, BLOCK_SIZE);
+    // The cursor stays put, so only the new tables can trigger the rebuild.
+    Patch *patch = Patch_create("squares");
+    for (int slot = 0; slot < NUM_WAVETABLES; slot++)
+        Patch_set_waveform(patch, slot, WAVEFORM_SQUARE);
+    PatchSlot_publish(&state->patches, patch);
+    State_render(state, out, BLOCK_SIZE);
+    for (int i = 0; i < TABLE_SIZE; i++)
+        cr_assert_float_eq(mixer->premix[i], patch->tables[0].data[i], 1e-5, "sample %d", i);
+    State_destroy(state);
+}
+
+Test(mixer, reloaded_table_fades_in) {
+    Dsp_init();
+    enum { BLOCKS = MIXER_FADE_FRAMES / BLOCK_SIZE + 4 };
+    // before keeps the old slot 0; after has the reloaded table from the start.
+    State *live = State_create(), *before = State_create(), *after = State_create();
+    size_t length = live->wts[0].length;
+    float inverted[TABLE_SIZE];
+    for (size_t i = 0; i < length; i++)
+        inverted[i] = -live->wts[0].data[i];
+    State *states[3] = {live, before, after};
+    for (int s = 0; s < 3; s++) {
+        Mixer *mixer = Mixer_create(MixerShape_polygon(4), TABLE_SIZE);
+        if (states[s] == after)
+            Mixer_set_face(mixer, 0, inverted);
+        State_set_mixer(states[s], mixer);
+        State_set_note(states[s], 0, 440.0);
+    }
+    float out[3][BLOCK_SIZE];
+    for (int s = 0; s < 3; s++)
+        State_render(states[s], out[s], BLOCK_SIZE);
+    State_offer_table(live, 0, SpectralFrame_build(inverted, length, SPECTRAL_MAX_MIPS));
+
+    for (int block = 0; block < BLOCKS; block++) {
+        for (int s = 0; s < 3; s++)
+            State_render(states[s], out[s], BLOCK_SIZE);
+        // The first block is still the old premix; the last ones are the new one.
+        for (int i = 0; i < BLOCK_SIZE && block == 0; i++)
+            cr_assert_float_eq(out[0][i], out[1][i], 1e-5, "sample %d", i);
+        for (int i = 0; i < BLOCK_SIZE && block >= BLOCKS - 2; i++)
+            cr_assert_float_eq(out[0][i], out[2][i], 1e-5, "block %d sample %d", block, i);
+    }
+    for (int s = 0; s < 3; s++)
+        State_destroy(states[s]);
+}
@@ -0,0 +1,163 @@
+#include <criterion/criterion.h>
+#include <math.h>
+#include <string.h>
+#include "dsp.h"
+#include "output.h"
+
+#define FRAMES 100
+
+static void ramp(float *samples, int n) {
+    for (int i = 0; i < n; i++)
+        samples[i] = -1.0f + 2.0f * i / (n - 1);
+}
+
+Test(output, interleaved_float32_fans_out) {
+    Dsp_init();
+    OutputFormat of;
+    cr_assert_eq(OutputFormat_init(&of, SoundIoFormatFloat32NE), 0);
+    float buffer[FRAMES * 2];
+    struct SoundIoChannelArea areas[2] = {{(char *)buffer, 8}, {(char *)buffer + 4, 8}};
+    float samples[FRAMES / 2];
+    ramp(samples, FRAMES / 2);
+    // Second half of the buffer, as the callback does for its second block.
+    OutputFormat_write(&of, areas, 2, FRAMES / 2, samples, FRAMES / 2);
+    for (int i = 0; i < FRAMES / 2; i++) {
+        cr_assert_eq(buffer[FRAMES + 2 * i], samples[i]);
+        cr_assert_eq(buffer[FRAMES + 2 * i + 1], samples[i]);
+    }
+}
+
+Test(output, stereo_pairs_and_folds_down) {
+    Dsp_init();
+    OutputFormat of;
+    cr_assert_eq(OutputFormat_init(&of, SoundIoFormatFloat32NE), 0);
+    float left[FRAMES], right[FRAMES];
+    ramp(left, FRAMES);
+    for (int i = 0; i < FRAMES; i++)
+        right[i] = -left[i] * 0.5f;
+    float expected_left[FRAMES], expected_right[FRAMES];
+    memcpy(expected_left, left, sizeof(left));
+    memcpy(expected_right, right, sizeof(right));
+    float buffer[FRAMES * 3];
+    struct SoundIoChannelArea areas[3] = {
+        {(char *)buffer, 12}, {(char *)buffer + 4, 12}, {(char *)buffer + 8, 12}};
+    OutputFormat_write_stereo(&of, areas, 3, 0, left, right, FRAMES);
+    for (int i = 0; i < FRAMES; i++) {
+        cr_assert_eq(buffer[3 * i], expected_left[i]);
+        cr_assert_eq(buffer[3 * i + 1], expected_right[i]);
+        cr_assert_float_eq(buffer[3 * i + 2], 0.5f * (expected_left[i] + expected_right[i]), 1e-7);
+    }
+
+    float mono[FRAMES];
+    struct SoundIoChannelArea area = {(char *)mono, 4};
+    memcpy(left, expected_left, sizeof(left));
+    memcpy(right, expected_right, sizeof(right));
+    OutputFormat_write_stereo(&of, &area, 1, 0, left, right, FRAMES);
+    for (int i = 0; i < FRAMES; i++)
+        cr_assert_float_eq(mono[i], 0.5f * (expected_left[i] + expected_right[i]), 1e-7);
+}
+
+Test(output, planar_s16_dithers_within_one_lsb) {
+    Dsp_init();
+    OutputFormat of;
+    cr_assert_eq(OutputFormat_init(&of, SoundIoFormatS16NE), 0);
+    cr_assert(of.dither);
+    int16_t left[FRAMES], right[FRAMES];
+    struct SoundIoChannelArea areas[2] = {{(char *)left, 2}, {(char *)right, 2}};
+    float samples[FRAMES], clean[FRAMES];
+    ramp(samples, FRAMES);
+    memcpy(clean, samples, sizeof(clean));
+    OutputFormat_write(&of, areas, 2, 0, samples, FRAMES);
+    for (int i = 0; i < FRAMES; i++) {
+        cr_assert_eq(left[i], right[i]);
+        cr_assert_leq(fabsf(left[i] - clean[i] * 32767.0f), 1.5f, "sample %d", i);
+    }
+}
+
+Test(output, tpdf_is_zero_mean_and_bounded) {
+    Dsp_init();
+    OutputFormat of;
+    OutputFormat_init(&of, SoundIoFormatS24NE);
+    int32_t out[BLOCK_SIZE];
+    struct SoundIoChannelArea area = {(char *)out, 4};
+    double sum = 0.0;
+    for (int block = 0; block < 64; block++) {
+        float samples[BLOCK_SIZE] = {0};
+        OutputFormat_write(&of, &area, 1, 0, samples, BLOCK_SIZE);
+        for (int i = 0; i < BLOCK_SIZE; i++) {
+            cr_assert_leq(abs(out[i]), 1, "dither stays within one LSB");
+            sum += out[i];
+        }
+    }
+    cr_assert_lt(fabs(sum / (64 * BLOCK_SIZE)), 0.05);
+}
+
+Test(output, s32_and_f64_full_scale) {
+    Dsp_init();
+    OutputFormat of;
+    float samples[4] = {1.0f, -1.0f, 0.5f, 2.0f};
+
+    OutputFormat_init(&of, SoundIoFormatS32NE);
+    cr_assert_not(of.dither);
+    int32_t s32[4];
+    struct SoundIoChannelArea a32 = {(char *)s32, 4};
+    OutputFormat_write(&of, &a32, 1, 0, samples, 4);
+    cr_assert_eq(s32[0], (int32_t)DSP_S32_SCALE);
+    cr_assert_eq(s32[1], -(int32_t)DSP_S32_SCALE);
+    cr_assert_eq(s32[3], (int32_t)DSP_S32_SCALE, "out of range input clips");
+
+    OutputFormat_init(&of, SoundIoFormatFloat64NE);
+    double f64[8];
+    struct SoundIoChannelArea a64[2] = {{(char *)f64, 16}, {(char *)f64 + 8, 16}};
+    OutputFormat_write(&of, a64, 2, 0, samples, 4);
+    cr_assert_eq(f64[4], 0.5);
+    cr_assert_eq(f64[5], 0.5);
+    cr_assert_eq(f64[6], 2.0, "float formats pass overs through");
+}
+
+Test(output, rejects_unknown_format) {
+    OutputFormat of;
+    cr_assert_eq(OutputFormat_init(&of, SoundIoFormatU8), -1);
+}
+
+// Interleaved stereo zips both sides in one pass; it must write what the strided path does,
+// dither included.
+Test(output, interleaved_stereo_matches_planar) {
+    Dsp_init();
+    enum SoundIoFormat formats[3] = {SoundIoFormatS16NE, SoundIoFormatS32NE,
+                                     SoundIoFormatFloat64NE};
+    for (int f = 0; f < 3; f++) {
+        for (int channels = 2; channels <= 3; channels++) {
+            OutputFormat zipped, strided;
+            OutputFormat_init(&zipped, formats[f]);
+            OutputFormat_init(&strided, formats[f]);
+            int bytes = zipped.bytes_per_sample;
+            float left[FRAMES], right[FRAMES], left2[FRAMES], right2[FRAMES];
+            ramp(left, FRAMES);
+            for (int i = 0; i < FRAMES; i++)
+                right[i] = 0.25f - left[i] * 0.5f;
+            memcpy(left2, left, sizeof(left));
+            memcpy(right2, right, sizeof(right));
+
+            uint64_t interleaved[FRAMES * 3], padded[FRAMES * 4];
+            struct SoundIoChannelArea inter[3], pad[3];
+            for (int ch = 0; ch < channels; ch++) {
+                inter[ch] = (struct SoundIoChannelArea){(char *)interleaved + ch * bytes,
+                                                        channels * bytes};
+                // One unused sample per frame: the same channels, not interleaved.
+                pad[ch] = (struct SoundIoChannelArea){(char *)padded + ch * bytes,
+                                                      (channels + 1) * bytes};
+            }
+            OutputFormat_write_stereo(&zipped, inter, channels, 0, left, right, FRAMES);
+            OutputFormat_write_stereo(&strided, pad, channels, 0, left2, right2, FRAMES);
+            for (int i = 0; i < FRAMES; i++) {
+                for (int ch = 0; ch < channels; ch++) {
+                    const char *a = inter[ch].ptr + (size_t)inter[ch].step * i;
+                    const char *b = pad[ch].ptr + (size_t)pad[ch].step * i;
+                    cr_assert_eq(memcmp(a, b, bytes), 0, "format %d channels %d frame %d ch %d",
+                                 f, channels, i, ch);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,133 @@
+#include <criterion/criterion.h>
+#include "config.h"
+#include "dsp.h"
+#include "patch.h"
+#include "state.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+Test(patch, presets_precompute_filter) {
+    for (int i = 0; i < Patch_preset_count(); i++) {
+        Patch *patch = Patch_preset(i);
+        BiquadFilter expected;
+        Biquad_design_lowpass(&expected, patch->cutoff, patch->q);
+        cr_assert_float_eq(patch->filter.b0, expected.b0, 1e-9, "%s", patch->name);
+        cr_assert_float_eq(patch->filter.a1, expected.a1, 1e-9, "%s", patch->name);
+        for (int slot = 0; slot < NUM_WAVETABLES; slot++)
+            cr_assert(patch->tables[slot].data && patch->tables[slot].length > 0);
+        Patch_destroy(patch);
+    }
+}
+
+Test(patch, clone_is_deep) {
+    Patch *a = Patch_preset(3);
+    Patch *b = Patch_clone(a);
+    cr_assert_str_eq(b->name, a->name);
+    cr_assert_neq(b->tables[0].data, a->tables[0].data);
+    cr_assert_float_eq(b->tables[0].data[100], a->tables[0].data[100], 0.0);
+    Patch_set_level(b, 0, 0.25f);
+    cr_assert_float_eq(a->levels[0], 1.0f, 0.0);
+    Patch_destroy(a);
+    Patch_destroy(b);
+}
+
+Test(patch, retired_patch_outlives_block) {
+    PatchSlot slot;
+    PatchSlot_init(&slot);
+    PatchSlot_publish(&slot, Patch_create("A"));
+    const Patch *seen = PatchSlot_enter(&slot);
+    cr_assert_str_eq(seen->name, "A");
+    // Swapped mid-block: A must survive until the block ends.
+    PatchSlot_publish(&slot, Patch_create("B"));
+    cr_assert_eq(PatchSlot_reclaim(&slot), 0);
+    cr_assert_str_eq(seen->name, "A");
+    PatchSlot_exit(&slot);
+    cr_assert_eq(PatchSlot_reclaim(&slot), 1);
+    cr_assert_str_eq(PatchSlot_current(&slot)->name, "B");
+    PatchSlot_destroy(&slot);
+}
+
+Test(patch, render_follows_patch_without_reset) {
+    Dsp_init();
+    State *state = State_create();
+    State_set_note(state, 0, 220.0);
+    float out[BLOCK_SIZE];
+    State_render(state, out, BLOCK_SIZE);
+    Lowpass_process_block(&state->lpf, out, BLOCK_SIZE);
+    float z1 = state->lpf.biquad.z1;
+
+    Patch *silent = Patch_create("silent");
+    for (int slot = 0; slot < NUM_WAVETABLES; slot++)
+        Patch_set_level(silent, slot, 0.0f);
+    Patch_set_filter(silent, 500.0f, 0.7f);
+    PatchSlot_publish(&state->patches, silent);
+    State_render(state, out, BLOCK_SIZE);
+    for (int i = 0; i < BLOCK_SIZE; i++)
+        cr_assert_float_eq(out[i], 0.0f, 0.0);
+    cr_assert_float_eq(state->lpf.biquad.b0, silent->filter.b0, 0.0);
+    cr_assert_float_eq(state->lpf.biquad.z1, z1, 0.0, "the filter state carries over");
+    cr_assert_float_eq(state->lpf.cutoff, 20000.0f, 0.0, "live settings are untouched");
+
+    // Back to the live settings.
+    PatchSlot_publish(&state->patches, NULL);
+    State_render(state, out, BLOCK_SIZE);
+    BiquadFilter live;
+    Biquad_design_lowpass(&live, state->lpf.cutoff, state->lpf.q);
+    cr_assert_float_eq(state->lpf.biquad.b0, live.b0, 0.0);
+    cr_assert_eq(PatchSlot_reclaim(&state->patches), 1);
+    State_destroy(state);
+}
+
+typedef struct {
+    PatchSlot *slot;
+    atomic_int done;
+    int torn;
+    long blocks;
+} Reader;
+
+// Every table of a patch is filled with its level, so a patch that is freed or half-built
+// while in use shows up as a mismatch.
+static void *read_patches(void *arg) {
+    Reader *reader = arg;
+    while (!atomic_load(&reader->done)) {
+        const Patch *patch = PatchSlot_enter(reader->slot);
+        if (patch) {
+            for (int slot = 0; slot < NUM_WAVETABLES; slot++) {
+                for (size_t i = 0; i < patch->tables[slot].length; i += 64) {
+                    if (patch->tables[slot].data[i] != patch->levels[0])
+                        reader->torn++;
+                }
+            }
+        }
+        PatchSlot_exit(reader->slot);
+        reader->blocks++;
+    }
+    return NULL;
+}
+
+Test(patch, concurrent_publish_and_reclaim) {
+    PatchSlot slot;
+    PatchSlot_init(&slot);
+    Reader reader = {&slot, 0, 0, 0};
+    pthread_t thread;
+    pthread_create(&thread, NULL, read_patches, &reader);
+    int freed = 0;
+    for (int n = 0; n < 2000; n++) {
+        Patch *patch = Patch_create("stress");
+        float value = (float)(n % 10) / 10.0f;
+        Patch_set_level(patch, 0, value);
+        for (int slot_index = 0; slot_index < NUM_WAVETABLES; slot_index++) {
+            for (size_t i = 0; i < patch->tables[slot_index].length; i++)
+                patch->tables[slot_index].data[i] = value;
+        }
+        PatchSlot_publish(&slot, patch);
+        freed += PatchSlot_reclaim(&slot);
+    }
+    atomic_store(&reader.done, 1);
+    pthread_join(thread, NULL);
+    PatchSlot_exit(&slot); // patches retired after the reader's last block
+    freed += PatchSlot_reclaim(&slot);
+    cr_assert_eq(reader.torn, 0);
+    cr_assert_eq(freed, 1999, "every replaced patch is reclaimed once the reader moves on");
+    PatchSlot_destroy(&slot);
+}
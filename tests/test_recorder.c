@@ -0,0 +1,96 @@
+#include <criterion/criterion.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "config.h"
+#include "recorder.h"
+#include "wav.h"
+
+static void temp_path(char *path, size_t size, const char *suffix) {
+    snprintf(path, size, "/tmp/wave_recorder_%d%s", (int)getpid(), suffix);
+}
+
+Test(recorder, round_trips_wav) {
+    char path[64];
+    temp_path(path, sizeof(path), ".wav");
+    Recorder *rec = Recorder_create(1 << 16);
+    cr_assert_eq(Recorder_start(rec, path, RECORDER_WAV), 0);
+    cr_assert(Recorder_is_recording(rec));
+    cr_assert_eq(Recorder_start(rec, path, RECORDER_WAV), -1, "one recording at a time");
+    // Blocks of odd sizes so the ring wraps mid-block.
+    const int total = 3 * SAMPLE_RATE;
+    float left[BLOCK_SIZE], right[BLOCK_SIZE];
+    for (int done = 0; done < total;) {
+        int n = total - done < 199 ? total - done : 199;
+        for (int i = 0; i < n; i++) {
+            left[i] = (float)((done + i) % 1000) / 1000.0f;
+            right[i] = -left[i] / 2.0f;
+        }
+        Recorder_write(rec, left, right, n);
+        done += n;
+        usleep(1000); // about four times real time
+    }
+    Recorder_stop(rec);
+    cr_assert_not(Recorder_is_recording(rec));
+    cr_assert_eq(Recorder_overruns(rec), 0);
+    cr_assert_float_eq(Recorder_seconds(rec), 3.0, 1e-9);
+
+    // Writes while stopped go nowhere.
+    Recorder_write(rec, left, right, BLOCK_SIZE);
+
+    float *samples = NULL;
+    size_t length = 0;
+    int rate = 0;
+    cr_assert_eq(Wav_read_mono(path, &samples, &length, &rate), 0);
+    cr_assert_eq(rate, SAMPLE_RATE);
+    cr_assert_eq(length, (size_t)total);
+    for (int i = 0; i < total; i++)
+        cr_assert_float_eq(samples[i], (float)(i % 1000) / 4000.0f, 1e-6, "sample %d", i);
+    free(samples);
+    // Two channels, interleaved left then right.
+    FILE *f = fopen(path, "rb");
+    unsigned char header[44];
+    cr_assert_eq(fread(header, 1, sizeof(header), f), sizeof(header));
+    cr_assert_eq(header[22] | header[23] << 8, 2, "channels");
+    cr_assert_eq(header[32] | header[33] << 8, 2 * sizeof(float), "block align");
+    float frame[2];
+    for (int i = 0; i < total; i += 997) {
+        cr_assert_eq(fseek(f, 44 + i * (long)sizeof(frame), SEEK_SET), 0);
+        cr_assert_eq(fread(frame, sizeof(float), 2, f), 2);
+        cr_assert_eq(frame[0], (float)(i % 1000) / 1000.0f, "left %d", i);
+        cr_assert_eq(frame[1], -frame[0] / 2.0f, "right %d", i);
+    }
+    fclose(f);
+    struct stat st;
+    cr_assert_eq(stat(path, &st), 0);
+    cr_assert_eq(st.st_size, 44 + total * (off_t)sizeof(frame), "preallocation is trimmed");
+    unlink(path);
+    Recorder_destroy(rec);
+}
+
+Test(recorder, counts_overruns_instead_of_blocking) {
+    char path[64];
+    temp_path(path, sizeof(path), ".raw");
+    Recorder *rec = Recorder_create(1);
+    cr_assert_eq(Recorder_start(rec, path, RECORDER_RAW), 0);
+    // Far faster than real time into the smallest ring: something has to give.
+    float block[BLOCK_SIZE] = {0};
+    const int blocks = 4096;
+    for (int b = 0; b < blocks; b++)
+        Recorder_write(rec, block, block, BLOCK_SIZE);
+    Recorder_stop(rec);
+    unsigned long written = (unsigned long)(Recorder_seconds(rec) * SAMPLE_RATE + 0.5);
+    cr_assert_gt(Recorder_overruns(rec), 0);
+    cr_assert_eq(written + Recorder_overruns(rec), (unsigned long)blocks * BLOCK_SIZE);
+    struct stat st;
+    cr_assert_eq(stat(path, &st), 0);
+    cr_assert_eq((unsigned long)st.st_size, written * 2 * sizeof(float));
+
+    // A new recording starts clean.
+    cr_assert_eq(Recorder_start(rec, path, RECORDER_RAW), 0);
+    cr_assert_eq(Recorder_overruns(rec), 0);
+    Recorder_stop(rec);
+    unlink(path);
+    Recorder_destroy(rec);
+}
@@ -0,0 +1,119 @@
+#include <criterion/criterion.h>
+#include "config.h"
+#include "dsp.h"
+#include "reload.h"
+#include "state.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+Test(reload, frame_mips_keep_a_sine) {
+    enum { LENGTH = 256 };
+    float sine[LENGTH];
+    for (int i = 0; i < LENGTH; i++)
+        sine[i] = (float)sin(2.0 * M_PI * 3 * i / LENGTH);
+    SpectralFrame *frame = SpectralFrame_build(sine, LENGTH, SPECTRAL_MAX_MIPS);
+    cr_assert_gt(frame->num_mips, 4);
+    // Harmonic 3 survives every mip that still has three harmonics, and no other.
+    for (int level = 0; level < frame->num_mips; level++) {
+        float expected_gain = frame->max_harmonic[level] >= 3 ? 1.0f : 0.0f;
+        for (int i = 0; i < LENGTH; i++)
+            cr_assert_float_eq(frame->mips[level][i], expected_gain * sine[i], 1e-4,
+                               "mip %d sample %d", level, i);
+    }
+    SpectralFrame_destroy(frame);
+}
+
+static void render_blocks(State *state, float *out, int blocks) {
+    for (int b = 0; b < blocks; b++)
+        State_render(state, out + b * BLOCK_SIZE, BLOCK_SIZE);
+}
+
+Test(reload, offered_table_fades_in) {
+    Dsp_init();
+    enum { BLOCKS = RELOAD_FADE_FRAMES / BLOCK_SIZE + 4 };
+    State *live = State_create();
+    State *reference = State_create();
+    for (int slot = 1; slot < NUM_WAVETABLES; slot++)
+        live->wt_levels[slot] = reference->wt_levels[slot] = 0.0f;
+    State_set_note(live, 0, 440.0);
+    State_set_note(reference, 0, 440.0);
+
+    // The slot's sine replaced by its negation: once faded in, the output is inverted.
+    size_t length = live->wts[0].length;
+    float *inverted = malloc(length * sizeof(float));
+    for (size_t i = 0; i < length; i++)
+        inverted[i] = -live->wts[0].data[i];
+    State_offer_table(live, 0, SpectralFrame_build(inverted, length, SPECTRAL_MAX_MIPS));
+
+    float *out = malloc(BLOCKS * BLOCK_SIZE * sizeof(float));
+    float *expected = malloc(BLOCKS * BLOCK_SIZE * sizeof(float));
+    render_blocks(live, out, BLOCKS);
+    render_blocks(reference, expected, BLOCKS);
+    // The first block is still mostly the old table; the last ones are the new one.
+    cr_assert_float_eq(out[10], expected[10], 1e-3);
+    for (int i = (BLOCKS - 2) * BLOCK_SIZE; i < BLOCKS * BLOCK_SIZE; i++)
+        cr_assert_float_eq(out[i], -expected[i], 1e-3, "sample %d", i);
+    // It faded in from wts, which the State still owns, so nothing was retired.
+    cr_assert_eq(State_collect_tables(live), 0);
+
+    // A second reload retires the first reloaded table.
+    State_offer_table(live, 0, SpectralFrame_build(live->wts[0].data, length, SPECTRAL_MAX_MIPS));
+    render_blocks(live, out, BLOCKS);
+    render_blocks(reference, expected, BLOCKS);
+    for (int i = (BLOCKS - 2) * BLOCK_SIZE; i < BLOCKS * BLOCK_SIZE; i++)
+        cr_assert_float_eq(out[i], expected[i], 1e-3, "sample %d", i);
+    cr_assert_eq(State_collect_tables(live), 1);
+
+    free(expected);
+    free(out);
+    free(inverted);
+    State_destroy(reference);
+    State_destroy(live);
+}
+
+static void write_table(const char *path, size_t length, float bad) {
+    Wavetable *wt = Wavetable_create(WAVEFORM_SAW, length);
+    wt->data[length / 3] += bad;
+    cr_assert_eq(Wavetable_save(wt, path), 0);
+    Wavetable_destroy(wt);
+}
+
+static int wait_for(Reloader *reloader, unsigned long reloads, unsigned long rejected) {
+    for (int tries = 0; tries < 200; tries++) {
+        if (Reloader_reloads(reloader) >= reloads && Reloader_rejected(reloader) >= rejected)
+            return 1;
+        struct timespec pause = {0, 10 * 1000 * 1000};
+        nanosleep(&pause, NULL);
+    }
+    return 0;
+}
+
+Test(reload, watcher_reloads_and_rejects) {
+    char dir[] = "/tmp/wave-reload-XXXXXX";
+    cr_assert_not_null(mkdtemp(dir));
+    char path[64];
+    snprintf(path, sizeof(path), "%s/Test.bin", dir);
+    State *state = State_create();
+    Reloader *reloader = Reloader_create(state, dir);
+    cr_assert_eq(Reloader_watch(reloader, 2, "Test.bin"), 0);
+    cr_assert_eq(Reloader_start(reloader), 0);
+
+    // Half the slot's length: resampled on the way in.
+    write_table(path, state->wts[2].length / 2, 0.0f);
+    cr_assert(wait_for(reloader, 1, 0));
+    SpectralFrame *pending = atomic_load(&state->hot[2].pending);
+    cr_assert_not_null(pending);
+    cr_assert_eq(pending->length, state->wts[2].length);
+
+    write_table(path, 64, NAN);
+    cr_assert(wait_for(reloader, 1, 1));
+    cr_assert_eq(Reloader_reloads(reloader), 1);
+
+    Reloader_destroy(reloader);
+    State_destroy(state);
+    unlink(path);
+    rmdir(dir);
+}
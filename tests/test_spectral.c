@@ -0,0 +1,88 @@
+#include <criterion/criterion.h>
+#include <math.h>
+#include "config.h"
+#include "spectral.h"
+#include "wavetable.h"
+
+static float expected_sample(const float *mag, const float *phase, int count, size_t i,
+                             size_t n) {
+    double sum = 0.0;
+    for (int h = 1; h <= count; h++)
+        sum += mag[h] * sin(2.0 * M_PI * h * i / n + phase[h]);
+    return (float)sum;
+}
+
+Test(spectral, analyze_sine) {
+    SpectralTable *st = SpectralTable_create(TABLE_SIZE, 10);
+    Wavetable *wt = Wavetable_create(WAVEFORM_SINE, TABLE_SIZE);
+    cr_assert_eq(SpectralTable_analyze(st, wt), 0);
+    SpectralTable_flush(st);
+    cr_assert_float_eq(SpectralTable_get_magnitude(st, 1), 1.0f, 1e-4);
+    cr_assert_float_eq(SpectralTable_get_magnitude(st, 2), 0.0f, 1e-4);
+
+    const SpectralFrame *frame = SpectralTable_acquire(st);
+    for (int level = 0; level < frame->num_mips; level++) {
+        for (size_t i = 0; i < TABLE_SIZE; i++)
+            cr_assert_float_eq(frame->mips[level][i], wt->data[i], 1e-4, "mip %d sample %zu",
+                               level, i);
+    }
+    SpectralTable_release(st);
+    Wavetable_destroy(wt);
+    SpectralTable_destroy(st);
+}
+
+Test(spectral, incremental_and_full_agree) {
+    const size_t n = 2048;
+    SpectralTable *st = SpectralTable_create(n, 10);
+    float mag[64] = {0}, phase[64] = {0};
+    // A few edits take the per-harmonic delta path...
+    for (int h = 1; h <= 5; h++) {
+        mag[h] = 1.0f / h;
+        phase[h] = 0.3f * h;
+        SpectralTable_set_harmonic(st, h, mag[h], phase[h]);
+        SpectralTable_flush(st);
+    }
+    // ...then a burst large enough to force a full inverse FFT.
+    for (int h = 10; h < 64; h++) {
+        mag[h] = 0.01f * (h % 7);
+        phase[h] = -0.1f * h;
+        SpectralTable_set_harmonic(st, h, mag[h], phase[h]);
+    }
+    SpectralTable_flush(st);
+    mag[2] = 0.0f;
+    SpectralTable_set_harmonic(st, 2, 0.0f, phase[2]);
+    SpectralTable_flush(st);
+
+    const SpectralFrame *frame = SpectralTable_acquire(st);
+    cr_assert_eq(frame->num_mips, 10);
+    for (size_t i = 0; i < n; i += 3)
+        cr_assert_float_eq(frame->mips[0][i], expected_sample(mag, phase, 63, i, n), 1e-4,
+                           "sample %zu", i);
+    // Each level only carries harmonics up to its limit.
+    for (int level = 1; level < frame->num_mips; level++) {
+        int limit = frame->max_harmonic[level] < 63 ? frame->max_harmonic[level] : 63;
+        for (size_t i = 0; i < n; i += 31)
+            cr_assert_float_eq(frame->mips[level][i], expected_sample(mag, phase, limit, i, n),
+                               1e-4, "mip %d sample %zu", level, i);
+    }
+    SpectralTable_release(st);
+    // The rebuild above was timed.
+    float ms = SpectralTable_last_rebuild_ms(st);
+    cr_assert(ms > 0.0f && isfinite(ms), "rebuild took %f ms", ms);
+    SpectralTable_destroy(st);
+}
+
+Test(spectral, mip_selection_band_limits) {
+    SpectralTable *st = SpectralTable_create(TABLE_SIZE, 10);
+    const SpectralFrame *frame = SpectralTable_acquire(st);
+    cr_assert_eq(SpectralFrame_mip(frame, 0.5), frame->mips[0]);
+    // At 4 samples per step only harmonics below 1024 / 8 = 128 are alias-free.
+    const float *mip = SpectralFrame_mip(frame, 4.0);
+    int level = 0;
+    while (frame->mips[level] != mip)
+        level++;
+    cr_assert_lt(frame->max_harmonic[level], 128);
+    cr_assert_geq(frame->max_harmonic[level - 1], 128);
+    SpectralTable_release(st);
+    SpectralTable_destroy(st);
+}
@@ -1,4 +1,5 @@
 #include <criterion/criterion.h>
+#include "config.h"
 #include "vec.h"
 #include "osc.h"
 
@@ -24,23 +25,25 @@ Test(vec, int) {
 }
 
 Test(vec, osc) {
-    Vec *vec = Vec_create(sizeof(Osc*), (ElemDestroyFunc)Osc_destroy);
+    Vec *vec = Vec_create(sizeof(Osc), NULL);
     cr_assert_not_null(vec, "Vec_create returned NULL for Osc vector");
     cr_assert_eq(vec->size, 0, "Initial Osc vector size should be 0");
 
-    const int numOsc = 1;
+    const int numOsc = 6; // past VEC_INIT_CAPACITY, so the vector grows
     for (int i = 0; i < numOsc; i++) {
-        Osc *osc = Osc_create(WAVEFORM_SINE + (i % 2), 256 * (i + 1), 220.0 + (i * 10));
+        Osc osc = Osc_create(i % 4, 220.0 + (i * 10));
         Vec_push_back(vec, &osc);
-        cr_assert_eq(vec->size, (size_t)(i + 1), "After push %d, Osc vector size should be %d", i + 1, i + 1);
+        cr_assert_eq(vec->size, (size_t)(i + 1), "After push %d, Osc vector size should be %d",
+                     i + 1, i + 1);
     }
 
-
-    // Verify each stored Osc pointer is not NULL.
+    // Verify each stored Osc survived the growth.
     for (size_t i = 0; i < vec->size; i++) {
-        Osc *osc_ptr = NULL;
-        Vec_get(vec, i, &osc_ptr);
-        cr_assert_not_null(osc_ptr, "Osc element at index %zu should not be NULL", i);
+        Osc osc;
+        Vec_get(vec, i, &osc);
+        cr_assert_eq(osc.wt_index, (int)(i % 4), "Osc element %zu has the wrong table", i);
+        cr_assert_float_eq(osc.phase_inc, TABLE_SIZE * (220.0 + i * 10) / SAMPLE_RATE, 1e-9,
+                           "Osc element %zu has the wrong frequency", i);
     }
 
     Vec_destroy(vec);
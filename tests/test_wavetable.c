@@ -1,5 +1,8 @@
 #include <criterion/criterion.h>
 #include <math.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "vec.h"
 #include "wavetable.h"
 
 Test(wavetable, sine_generation) {
@@ -59,6 +62,32 @@ Test(wavetable, triangle_generation) {
     Wavetable_destroy(wt);
 }
 
+Test(wavetable, load_checks_the_length_before_allocating) {
+    char path[] = "/tmp/wave-table-XXXXXX";
+    int fd = mkstemp(path);
+    cr_assert_geq(fd, 0);
+    close(fd);
+    Wavetable *saw = Wavetable_create(WAVEFORM_SAW, 10);
+    cr_assert_eq(Wavetable_save(saw, path), 0);
+    Wavetable loaded = {NULL, 0, WAVEFORM_CUSTOM};
+    cr_assert_eq(Wavetable_load_max(&loaded, path, 9), -1);
+    cr_assert_null(loaded.data);
+    cr_assert_eq(Wavetable_load_max(&loaded, path, 10), 0);
+    cr_assert_eq(loaded.length, 10);
+    free(loaded.data);
+
+    // A header claiming four billion samples over ten samples of data.
+    FILE *f = fopen(path, "r+b");
+    uint32_t huge = UINT32_MAX;
+    fwrite(&huge, sizeof(huge), 1, f);
+    fclose(f);
+    loaded = (Wavetable){NULL, 0, WAVEFORM_CUSTOM};
+    cr_assert_eq(Wavetable_load(&loaded, path), -1);
+    cr_assert_null(loaded.data);
+    Wavetable_destroy(saw);
+    remove(path);
+}
+
 // Test(wavetable, custom_waveform) {
 //     size_t length = 5;
 //     Wavetable *wt = Wavetable_create(WAVEFORM_SINE, length);
@@ -75,23 +104,24 @@ Test(wavetable, triangle_generation) {
 // }
 
 Test(wtvec, push_get_and_destroy) {
-    WtVec *wv = WtVec_create();
-    cr_assert_not_null(wv, "WtVec_create returned NULL");
-    cr_assert_eq(WtVec_size(wv), 0, "Initial WtVec size should be 0");
+    Vec *wv = Vec_create(sizeof(Wavetable *), (ElemDestroyFunc)Wavetable_destroy);
+    cr_assert_not_null(wv, "Vec_create returned NULL");
+    cr_assert_eq(wv->size, 0, "Initial vector size should be 0");
 
     size_t length1 = 100;
     Wavetable *wt1 = Wavetable_create(WAVEFORM_SINE, length1);
     cr_assert_not_null(wt1, "Wavetable_create returned NULL for sine");
-    WtVec_push(wv, wt1);
-    cr_assert_eq(WtVec_size(wv), 1, "After pushing sine wavetable, size should be 1");
+    Vec_push_back(wv, &wt1);
+    cr_assert_eq(wv->size, 1, "After pushing sine wavetable, size should be 1");
 
     size_t length2 = 50;
     Wavetable *wt2 = Wavetable_create(WAVEFORM_SAW, length2);
     cr_assert_not_null(wt2, "Wavetable_create returned NULL for saw");
-    WtVec_push(wv, wt2);
-    cr_assert_eq(WtVec_size(wv), 2, "After pushing saw wavetable, size should be 2");
+    Vec_push_back(wv, &wt2);
+    cr_assert_eq(wv->size, 2, "After pushing saw wavetable, size should be 2");
 
-    Wavetable *retrieved1 = WtVec_get(wv, 0);
+    Wavetable *retrieved1 = NULL;
+    Vec_get(wv, 0, &retrieved1);
     cr_assert_not_null(retrieved1, "Retrieved wavetable 1 is NULL");
     cr_assert_eq(retrieved1->type, WAVEFORM_SINE, "Retrieved wavetable 1 type mismatch");
     cr_assert_eq(retrieved1->length, length1, "Retrieved wavetable 1 length mismatch");
@@ -102,7 +132,7 @@ Test(wtvec, push_get_and_destroy) {
                            "Sine wavetable sample at index %zu incorrect", i);
     }
 
-    Wavetable *retrieved2 = WtVec_get(wv, 1);
+    Wavetable *retrieved2 = *(Wavetable **)Vec_at(wv, 1);
     cr_assert_not_null(retrieved2, "Retrieved wavetable 2 is NULL");
     cr_assert_eq(retrieved2->type, WAVEFORM_SAW, "Retrieved wavetable 2 type mismatch");
     cr_assert_eq(retrieved2->length, length2, "Retrieved wavetable 2 length mismatch");
@@ -113,5 +143,5 @@ Test(wtvec, push_get_and_destroy) {
                            "Saw wavetable sample at index %zu incorrect", i);
     }
 
-    WtVec_destroy(wv);
+    Vec_destroy(wv);
 }